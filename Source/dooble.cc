@@ -47,12 +47,14 @@
 #include "dooble_cookies_window.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_downloads.h"
 #include "dooble_favicons.h"
 #include "dooble_favorites_popup.h"
 #include "dooble_history.h"
 #include "dooble_history_window.h"
 #include "dooble_hmac.h"
+#include "dooble_instrumentation.h"
 #include "dooble_page.h"
 #include "dooble_pbkdf2.h"
 #include "dooble_popup_menu.h"
@@ -79,6 +81,7 @@ QPointer<dooble_certificate_exceptions> dooble::s_certificate_exceptions =
 QPointer<dooble_cookies> dooble::s_cookies = nullptr;
 QPointer<dooble_cookies_window> dooble::s_cookies_window = nullptr;
 QPointer<dooble_cryptography> dooble::s_cryptography = nullptr;
+QPointer<dooble_database_writer> dooble::s_database_writer = nullptr;
 QPointer<dooble_downloads> dooble::s_downloads = nullptr;
 QPointer<dooble_favorites_popup> dooble::s_favorites_window = nullptr;
 QPointer<dooble_history_window> dooble::s_history_popup = nullptr;
@@ -186,7 +189,8 @@ dooble::dooble(const QList<QUrl> &urls, bool is_private):QMainWindow()
       m_web_engine_profile->cookieStore()->setCookieFilter
 	([this](const QWebEngineCookieStore::FilterRequest &filter_request)
 	 {
-	   if(dooble_settings::setting("block_third_party_cookies").toBool() &&
+	   if(dooble_settings::value
+	      <dooble_settings_registry::BLOCK_THIRD_PARTY_COOKIES> () &&
 	      filter_request.thirdParty)
 	     return false;
 	   else if(m_cookies_window->is_domain_blocked(filter_request.
@@ -316,7 +320,7 @@ QStringList dooble::chart_names(void) const
 		       QDir::separator() +
 		       "dooble_charts.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -443,7 +447,8 @@ bool dooble::can_exit(const dooble::CanExit can_exit)
 bool dooble::cookie_filter
 (const QWebEngineCookieStore::FilterRequest &filter_request)
 {
-  if(dooble_settings::setting("block_third_party_cookies").toBool() &&
+  if(dooble_settings::value
+     <dooble_settings_registry::BLOCK_THIRD_PARTY_COOKIES> () &&
      filter_request.thirdParty)
     {
       emit s_accepted_or_blocked_domains->add_session_url
@@ -549,6 +554,18 @@ void dooble::clean(void)
 
   if(s_about)
     delete s_about;
+
+  if(s_application)
+    s_application->stop_database_maintenance();
+
+  if(s_database_writer)
+    delete s_database_writer;
+
+  if(!qEnvironmentVariableIsEmpty("DOOBLE_INSTRUMENTATION_FILE"))
+    dooble_instrumentation::save
+      (qEnvironmentVariable("DOOBLE_INSTRUMENTATION_FILE"));
+
+  dooble_database_utilities::close_databases();
 }
 
 void dooble::closeEvent(QCloseEvent *event)
@@ -878,6 +895,9 @@ void dooble::initialize_static_members(void)
 	  (QByteArray(), QByteArray(), "AES-256", "SHA3-512");
     }
 
+  if(!s_database_writer)
+    s_database_writer = new dooble_database_writer(nullptr);
+
   if(!s_downloads)
     {
       s_downloads = new dooble_downloads
@@ -3219,6 +3239,23 @@ void dooble::slot_create_window(dooble_web_engine_view *view)
   d->show();
 }
 
+void dooble::slot_database_vacuumed(const QString &file_name, qint64 bytes)
+{
+  if(!m_vacuum_dialog ||
+     m_vacuum_dialog->value() >= m_vacuum_dialog->maximum())
+    return;
+
+  m_vacuum_dialog->setLabelText
+    (m_vacuum_dialog->labelText() +
+     "\n" +
+     tr("%1: %2 reclaimed.").
+     arg(file_name).arg(dooble_ui_utilities::pretty_size(bytes)));
+  m_vacuum_dialog->setValue(m_vacuum_dialog->value() + 1);
+
+  if(m_vacuum_dialog->value() >= m_vacuum_dialog->maximum())
+    m_vacuum_dialog->setCancelButtonText(tr("Close"));
+}
+
 void dooble::slot_decouple_tab(int index)
 {
   auto charts = qobject_cast<dooble_charts *> (m_ui.tab->widget(index));
@@ -3589,8 +3626,10 @@ void dooble::slot_pbkdf2_future_finished(void)
 
 	  if(list.at(1).toInt() == 0)
 	    s_cryptography->set_block_cipher_type("AES-256");
-	  else
+	  else if(list.at(1).toInt() == 1)
 	    s_cryptography->set_block_cipher_type("Threefish-256");
+	  else
+	    s_cryptography->set_block_cipher_type("AES-256-GCM");
 
 	  if(list.at(2).toInt() == 0)
 	    s_cryptography->set_hash_type("Keccak-512");
@@ -3608,6 +3647,10 @@ void dooble::slot_pbkdf2_future_finished(void)
 	  s_cryptography->set_keys(authentication_key, encryption_key);
 	  dooble_cryptography::memzero(authentication_key);
 	  dooble_cryptography::memzero(encryption_key);
+
+	  if(s_application)
+	    s_application->resume_database_rekey();
+
 	  emit dooble_credentials_authenticated(true);
 	}
     }
@@ -3761,6 +3804,10 @@ void dooble::slot_quit_dooble(void)
   s_downloads->abort();
   s_history->abort();
   s_history_popup->deleteLater();
+
+  if(s_database_writer)
+    s_database_writer->flush();
+
   QApplication::exit(0);
 }
 
@@ -4562,86 +4609,53 @@ void dooble::slot_title_changed(const QString &title)
 
 void dooble::slot_vacuum_databases(void)
 {
-  QMessageBox mb(this);
-
-  mb.setIcon(QMessageBox::Question);
-  mb.setStandardButtons(QMessageBox::No | QMessageBox::Yes);
-  mb.setText
-    (tr("Vacuuming databases may require a significant amount of "
-	"time. Continue?"));
-  mb.setWindowIcon(windowIcon());
-  mb.setWindowModality(Qt::ApplicationModal);
-  mb.setWindowTitle(tr("Dooble: Confirmation"));
+  /*
+  ** The databases are vacuumed by a separate thread. The dialog
+  ** reports the reclaimed space of each database.
+  */
 
-  if(mb.exec() != QMessageBox::Yes)
+  if(m_vacuum_dialog)
     {
-      QApplication::processEvents();
+      m_vacuum_dialog->raise();
+      m_vacuum_dialog->activateWindow();
       return;
     }
 
-  m_ui.menu_bar->repaint();
-  m_ui.menu_edit->repaint();
-  QApplication::processEvents();
-
-  QStringList list;
-
-  list << "dooble_accepted_or_blocked_domains.db"
-       << "dooble_certificate_exceptions.db"
-       << "dooble_charts.db"
-       << "dooble_cookies.db"
-       << "dooble_downloads.db"
-       << "dooble_favicons.db"
-       << "dooble_history.db"
-       << "dooble_search_engines.db"
-       << "dooble_settings.db"
-       << "dooble_style_sheets.db";
-
-  QProgressDialog dialog(this);
-
-  dialog.setAutoClose(true);
-  dialog.setCancelButtonText(tr("Interrupt"));
-  dialog.setLabelText(tr("Vacuuming databases..."));
-  dialog.setMaximum(list.size());
-  dialog.setMinimum(0);
-  dialog.setWindowIcon(windowIcon());
-  dialog.setWindowModality(Qt::ApplicationModal);
-  dialog.setWindowTitle(tr("Dooble: Vacuuming Databases"));
-  dialog.show();
+  m_vacuum_dialog = new QProgressDialog(this);
+  m_vacuum_dialog->setAutoClose(false);
+  m_vacuum_dialog->setAutoReset(false);
+  m_vacuum_dialog->setCancelButtonText(tr("Interrupt"));
+  m_vacuum_dialog->setLabelText(tr("Vacuuming databases..."));
+  m_vacuum_dialog->setMaximum
+    (dooble_database_utilities::file_names().size());
+  m_vacuum_dialog->setMinimum(0);
+  m_vacuum_dialog->setValue(0);
+  m_vacuum_dialog->setWindowIcon(windowIcon());
+  m_vacuum_dialog->setWindowModality(Qt::NonModal);
+  m_vacuum_dialog->setWindowTitle(tr("Dooble: Vacuuming Databases"));
+  connect(m_vacuum_dialog,
+	  SIGNAL(canceled(void)),
+	  this,
+	  SLOT(slot_vacuum_databases_canceled(void)));
+  connect(s_application,
+	  SIGNAL(database_vacuumed(const QString &, qint64)),
+	  this,
+	  SLOT(slot_database_vacuumed(const QString &, qint64)),
+	  static_cast<Qt::ConnectionType> (Qt::AutoConnection |
+					   Qt::UniqueConnection));
+  m_vacuum_dialog->show();
+  s_application->vacuum_databases();
+}
 
-  foreach(const auto &i, list)
+void dooble::slot_vacuum_databases_canceled(void)
+{
+  if(m_vacuum_dialog)
     {
-      if(dialog.wasCanceled())
-	break;
-      else
-	dialog.setValue(list.indexOf(i) + 1);
+      if(m_vacuum_dialog->value() < m_vacuum_dialog->maximum())
+	s_application->interrupt_database_vacuum();
 
-      dialog.repaint();
-      QApplication::processEvents();
-      QThread::msleep(100);
-
-      auto database_name(dooble_database_utilities::database_name());
-
-      {
-	auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-	db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-			   QDir::separator() +
-			   i);
-
-	if(db.open())
-	  {
-	    QSqlQuery query(db);
-
-	    query.exec("VACUUM");
-	  }
-
-	db.close();
-      }
-
-      QSqlDatabase::removeDatabase(database_name);
+      m_vacuum_dialog->deleteLater();
     }
-
-  QApplication::processEvents();
 }
 
 void dooble::slot_warn_of_missing_sqlite_driver(void)
@@ -52,6 +52,7 @@ class dooble_charts;
 class dooble_cookies;
 class dooble_cookies_window;
 class dooble_cryptography;
+class dooble_database_writer;
 class dooble_downloads;
 class dooble_favorites_popup;
 class dooble_history;
@@ -93,6 +94,7 @@ class dooble: public QMainWindow
   static QPointer<dooble_cookies> s_cookies;
   static QPointer<dooble_cookies_window> s_cookies_window;
   static QPointer<dooble_cryptography> s_cryptography;
+  static QPointer<dooble_database_writer> s_database_writer;
   static QPointer<dooble_downloads> s_downloads;
   static QPointer<dooble_favorites_popup> s_favorites_window;
   static QPointer<dooble_history> s_history;
@@ -140,6 +142,7 @@ class dooble: public QMainWindow
   QPointer<QAction> m_full_screen_action;
   QPointer<QAction> m_settings_action;
   QPointer<QProgressDialog> m_pbkdf2_dialog;
+  QPointer<QProgressDialog> m_vacuum_dialog;
   QPointer<QWebEngineProfile> m_web_engine_profile;
   QPointer<dooble_cookies> m_cookies;
   QPointer<dooble_cookies_window> m_cookies_window;
@@ -197,6 +200,7 @@ class dooble: public QMainWindow
   void slot_create_dialog(dooble_web_engine_view *view);
   void slot_create_tab(dooble_web_engine_view *view);
   void slot_create_window(dooble_web_engine_view *view);
+  void slot_database_vacuumed(const QString &file_name, qint64 bytes);
   void slot_decouple_tab(int index);
   void slot_dooble_credentials_authenticated(bool state);
   void slot_dooble_credentials_created(void);
@@ -269,6 +273,7 @@ class dooble: public QMainWindow
   void slot_tabs_menu_button_clicked(void);
   void slot_title_changed(const QString &title);
   void slot_vacuum_databases(void);
+  void slot_vacuum_databases_canceled(void);
   void slot_warn_of_missing_sqlite_driver(void);
   void slot_window_close_requested(void);
 
@@ -144,17 +144,21 @@ dooble_accepted_or_blocked_domains::~dooble_accepted_or_blocked_domains()
   m_future.waitForFinished();
 }
 
-bool dooble_accepted_or_blocked_domains::contains(const QString &domain) const
-{
-  return m_domains.value(domain.toLower().trimmed(), 0) == 1;
-}
-
 bool dooble_accepted_or_blocked_domains::exception(const QUrl &url) const
 {
   return m_exceptions.value(url.host(), 0) == 1 ||
     m_exceptions.value(url.toString(), 0) == 1;
 }
 
+bool dooble_accepted_or_blocked_domains::matches(const QString &host) const
+{
+  /*
+  ** Is the host or one of its parent domains enabled?
+  */
+
+  return m_domains_matcher.matches(host);
+}
+
 void dooble_accepted_or_blocked_domains::abort(void)
 {
   m_future.cancel();
@@ -170,6 +174,7 @@ void dooble_accepted_or_blocked_domains::accept_or_block_domain
     return;
 
   m_domains[domain.toLower().trimmed()] = 1;
+  m_domains_matcher.insert(domain);
   m_ui.table->setRowCount(m_ui.table->rowCount() + 1);
   m_ui.table->setSortingEnabled(false);
   disconnect(m_ui.table,
@@ -217,7 +222,7 @@ void dooble_accepted_or_blocked_domains::closeEvent(QCloseEvent *event)
 
 void dooble_accepted_or_blocked_domains::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
@@ -304,7 +309,7 @@ void dooble_accepted_or_blocked_domains::populate(void)
 			   QDir::separator() +
 			   "dooble_accepted_or_blocked_domains.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    create_tables(db);
 
@@ -314,39 +319,45 @@ void dooble_accepted_or_blocked_domains::populate(void)
 
 	    if(query.exec("SELECT domain, state, OID "
 			  "FROM dooble_accepted_or_blocked_domains"))
-	      while(query.next())
-		{
-		  auto data1
-		    (QByteArray::fromBase64(query.value(0).toByteArray()));
-
-		  data1 = dooble::s_cryptography->mac_then_decrypt(data1);
-
-		  if(data1.isEmpty())
-		    {
-		      dooble_database_utilities::remove_entry
-			(db,
-			 "dooble_accepted_or_blocked_domains",
-			 query.value(2).toLongLong());
-		      continue;
-		    }
-
-		  auto data2
-		    (QByteArray::fromBase64(query.value(1).toByteArray()));
-
-		  data2 = dooble::s_cryptography->mac_then_decrypt(data2);
-
-		  if(data2.isEmpty())
-		    {
-		      dooble_database_utilities::remove_entry
-			(db,
-			 "dooble_accepted_or_blocked_domains",
-			 query.value(2).toLongLong());
-		      continue;
-		    }
-
-		  m_domains[data1.constData()] = QVariant
-		    (data2).toBool() ? 1 : 0;
-		}
+	      {
+		QVector<QByteArray> fields;
+		QVector<qint64> oids;
+
+		while(query.next())
+		  {
+		    fields << QByteArray::fromBase64
+		      (query.value(0).toByteArray());
+		    fields << QByteArray::fromBase64
+		      (query.value(1).toByteArray());
+		    oids << query.value(2).toLongLong();
+		  }
+
+		fields = dooble::s_cryptography->mac_then_decrypt_batch(fields);
+
+		for(int i = 0; i < oids.size(); i++)
+		  {
+		    const auto &data1(fields.at(2 * i));
+		    const auto &data2(fields.at(2 * i + 1));
+
+		    if(data1.isEmpty() || data2.isEmpty())
+		      {
+			dooble_database_utilities::remove_entry
+			  (db,
+			   "dooble_accepted_or_blocked_domains",
+			   oids.at(i));
+			continue;
+		      }
+
+		    auto state = QVariant(data2).toBool();
+
+		    m_domains[data1.constData()] = state ? 1 : 0;
+
+		    if(state)
+		      m_domains_matcher.insert(data1.constData());
+		    else
+		      m_domains_matcher.remove(data1.constData());
+		  }
+	      }
 	  }
 
 	db.close();
@@ -417,7 +428,7 @@ void dooble_accepted_or_blocked_domains::populate_exceptions(void)
 			   QDir::separator() +
 			   "dooble_accepted_or_blocked_domains.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    create_tables(db);
 
@@ -427,38 +438,38 @@ void dooble_accepted_or_blocked_domains::populate_exceptions(void)
 
 	    if(query.exec("SELECT state, url, OID "
 			  "FROM dooble_accepted_or_blocked_domains_exceptions"))
-	      while(query.next())
-		{
-		  auto data1
-		    (QByteArray::fromBase64(query.value(0).toByteArray()));
-
-		  data1 = dooble::s_cryptography->mac_then_decrypt(data1);
-
-		  if(data1.isEmpty())
-		    {
-		      dooble_database_utilities::remove_entry
-			(db,
-			 "dooble_accepted_or_blocked_domains_exceptions",
-			 query.value(2).toLongLong());
-		      continue;
-		    }
-
-		  auto data2
-		    (QByteArray::fromBase64(query.value(1).toByteArray()));
-
-		  data2 = dooble::s_cryptography->mac_then_decrypt(data2);
-
-		  if(data2.isEmpty())
-		    {
-		      dooble_database_utilities::remove_entry
-			(db,
-			 "dooble_accepted_or_blocked_domains_exceptions",
-			 query.value(2).toLongLong());
-		      continue;
-		    }
-
-		  m_exceptions[data2] = (data1 == "true") ? 1 : 0;
-		}
+	      {
+		QVector<QByteArray> fields;
+		QVector<qint64> oids;
+
+		while(query.next())
+		  {
+		    fields << QByteArray::fromBase64
+		      (query.value(0).toByteArray());
+		    fields << QByteArray::fromBase64
+		      (query.value(1).toByteArray());
+		    oids << query.value(2).toLongLong();
+		  }
+
+		fields = dooble::s_cryptography->mac_then_decrypt_batch(fields);
+
+		for(int i = 0; i < oids.size(); i++)
+		  {
+		    const auto &data1(fields.at(2 * i));
+		    const auto &data2(fields.at(2 * i + 1));
+
+		    if(data1.isEmpty() || data2.isEmpty())
+		      {
+			dooble_database_utilities::remove_entry
+			  (db,
+			   "dooble_accepted_or_blocked_domains_exceptions",
+			   oids.at(i));
+			continue;
+		      }
+
+		    m_exceptions[data2] = (data1 == "true") ? 1 : 0;
+		  }
+	      }
 	  }
 
 	db.close();
@@ -511,6 +522,7 @@ void dooble_accepted_or_blocked_domains::populate_exceptions(void)
 void dooble_accepted_or_blocked_domains::purge(void)
 {
   m_domains.clear();
+  m_domains_matcher.clear();
   m_exceptions.clear();
   m_future.cancel();
   m_future.waitForFinished();
@@ -524,29 +536,13 @@ void dooble_accepted_or_blocked_domains::purge(void)
   m_ui.session_rejections->setRowCount(0);
   m_ui.table->setRowCount(0);
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_accepted_or_blocked_domains.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_accepted_or_blocked_domains");
-	query.exec("DELETE FROM dooble_accepted_or_blocked_domains_exceptions");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_accepted_or_blocked_domains.db",
+     QStringList()
+     << "DELETE FROM dooble_accepted_or_blocked_domains"
+     << "DELETE FROM dooble_accepted_or_blocked_domains_exceptions");
 }
 
 void dooble_accepted_or_blocked_domains::resizeEvent(QResizeEvent *event)
@@ -575,7 +571,7 @@ void dooble_accepted_or_blocked_domains::save
 		       QDir::separator() +
 		       "dooble_accepted_or_blocked_domains.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -587,8 +583,6 @@ void dooble_accepted_or_blocked_domains::save
 	   dooble_settings::setting("block_cipher_type").toString(),
 	   dooble_settings::setting("hash_type").toString());
 
-	query.exec("PRAGMA synchronous = OFF");
-
 	while(it.hasNext() && !m_future.isCanceled())
 	  {
 	    it.next();
@@ -637,6 +631,12 @@ void dooble_accepted_or_blocked_domains::save_blocked_domain
   else if(!dooble::s_cryptography || !dooble::s_cryptography->authenticated())
     {
       m_domains[domain.toLower().trimmed()] = state ? 1 : 0;
+
+      if(state)
+	m_domains_matcher.insert(domain);
+      else
+	m_domains_matcher.remove(domain);
+
       return;
     }
 
@@ -651,14 +651,12 @@ void dooble_accepted_or_blocked_domains::save_blocked_domain
 		       QDir::separator() +
 		       "dooble_accepted_or_blocked_domains.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
-
 	if(replace)
 	  query.prepare
 	    ("INSERT OR REPLACE INTO dooble_accepted_or_blocked_domains "
@@ -724,7 +722,7 @@ void dooble_accepted_or_blocked_domains::save_exception(const QString &url,
 		       QDir::separator() +
 		       "dooble_accepted_or_blocked_domains.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -896,11 +894,10 @@ void dooble_accepted_or_blocked_domains::slot_delete_all_exceptions(void)
 		       QDir::separator() +
 		       "dooble_accepted_or_blocked_domains.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
 	query.exec("DELETE FROM dooble_accepted_or_blocked_domains_exceptions");
 	query.exec("VACUUM");
       }
@@ -959,12 +956,10 @@ void dooble_accepted_or_blocked_domains::slot_delete_selected(void)
 			   QDir::separator() +
 			   "dooble_accepted_or_blocked_domains.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
-
 	    for(int i = list.size() - 1; i >= 0; i--)
 	      {
 		query.prepare
@@ -977,6 +972,7 @@ void dooble_accepted_or_blocked_domains::slot_delete_selected(void)
 		if(query.exec())
 		  {
 		    m_domains.remove(list.at(i).data().toString());
+		    m_domains_matcher.remove(list.at(i).data().toString());
 		    m_ui.table->removeRow(list.at(i).row());
 		  }
 	      }
@@ -993,6 +989,7 @@ void dooble_accepted_or_blocked_domains::slot_delete_selected(void)
     for(int i = list.size() - 1; i >= 0; i--)
       {
 	m_domains.remove(list.at(i).data().toString());
+	m_domains_matcher.remove(list.at(i).data().toString());
 	m_ui.table->removeRow(list.at(i).row());
       }
 
@@ -1043,12 +1040,10 @@ void dooble_accepted_or_blocked_domains::slot_delete_selected_exceptions(void)
 			   QDir::separator() +
 			   "dooble_accepted_or_blocked_domains.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
-
 	    for(int i = list.size() - 1; i >= 0; i--)
 	      {
 		query.prepare
@@ -1149,7 +1144,10 @@ void dooble_accepted_or_blocked_domains::slot_import(void)
 					   trimmed()));
 
 	      if(!url.isEmpty() && url.isValid())
-		m_domains[url.host()] = 1;
+		{
+		  m_domains[url.host()] = 1;
+		  m_domains_matcher.insert(url.host());
+		}
 	    }
 
 	  file.close();
@@ -1228,6 +1226,12 @@ void dooble_accepted_or_blocked_domains::slot_item_changed
     return;
 
   m_domains[item->text()] = state ? 1 : 0;
+
+  if(state)
+    m_domains_matcher.insert(item->text());
+  else
+    m_domains_matcher.remove(item->text());
+
   save_blocked_domain(item->text(), true, state);
 }
 
@@ -1251,6 +1255,7 @@ void dooble_accepted_or_blocked_domains::slot_new_exception(void)
 void dooble_accepted_or_blocked_domains::slot_populate(void)
 {
   m_domains.clear();
+  m_domains_matcher.clear();
   m_exceptions.clear();
   populate();
   populate_exceptions();
@@ -35,6 +35,7 @@
 #include <QTableWidgetItem>
 #include <QTimer>
 
+#include "dooble_domain_matcher.h"
 #include "dooble_main_window.h"
 #include "ui_dooble_accepted_or_blocked_domains.h"
 
@@ -45,8 +46,8 @@ class dooble_accepted_or_blocked_domains: public dooble_main_window
  public:
   dooble_accepted_or_blocked_domains(void);
   ~dooble_accepted_or_blocked_domains();
-  bool contains(const QString &domain) const;
   bool exception(const QUrl &url) const;
+  bool matches(const QString &host) const;
   void abort(void);
   void accept_or_block_domain(const QString &domain, bool replace = true);
   void new_exception(const QString &url);
@@ -63,6 +64,7 @@ class dooble_accepted_or_blocked_domains: public dooble_main_window
 
  private:
   QFuture<void> m_future;
+  dooble_domain_matcher m_domains_matcher;
   QHash<QString, char> m_domains;
   QHash<QString, char> m_exceptions;
   QHash<QString, char> m_session_origin_hosts;
@@ -29,11 +29,7 @@
 ** Implementation of https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.197.pdf.
 */
 
-#include <QDataStream>
-#include <QElapsedTimer>
-#include <QIODevice>
-#include <QtDebug>
-#include <QtMath>
+#include <QString>
 #include <iostream>
 
 #ifdef DOOBLE_MMAN_PRESENT
@@ -43,6 +39,33 @@ extern "C"
 }
 #endif
 
+/*
+** Hardware engines are compiled where the compiler understands them and
+** selected at run-time if the processor supports them.
+*/
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define DOOBLE_AES256_AESNI
+#define DOOBLE_AES256_AESNI_TARGET
+#include <intrin.h>
+#include <wmmintrin.h>
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define DOOBLE_AES256_AESNI
+#define DOOBLE_AES256_AESNI_TARGET __attribute__((target("aes,sse2")))
+#include <cpuid.h>
+#include <wmmintrin.h>
+#elif defined(__aarch64__) && \
+  (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define DOOBLE_AES256_ARMV8
+#include <arm_neon.h>
+#ifdef Q_OS_LINUX
+extern "C"
+{
+#include <sys/auxv.h>
+}
+#endif
+#endif
+
 #include "dooble_aes256.h"
 #include "dooble_cryptography.h"
 #include "dooble_random.h"
@@ -136,246 +159,393 @@ static uint8_t s_sbox[256] =
   0xb0, 0x54, 0xbb, 0x16
 };
 
-dooble_aes256::dooble_aes256(const QByteArray &key):dooble_block_cipher(key)
+/*
+** Round tables, section 5.2.1 of the standard's companion document
+** "AES Proposal: Rijndael". The tables are derived from the S-boxes once.
+*/
+
+struct dooble_aes256_tables
 {
-  m_Nb = 4;
-  m_Nk = 8;
-  m_Nr = 14;
-  m_block_length = 16; // Or, 128 bits.
-  m_key_length = 32; // Or, 256 bits.
+  uint32_t Td[4][256];
+  uint32_t Te[4][256];
+};
 
-  if(m_key.length() < m_key_length)
-    m_key.append(m_key_length - m_key.length(), 0);
-  else
-    m_key.resize(m_key_length);
+static uint8_t multiply(uint8_t x, uint8_t y)
+{
+  uint8_t product = 0;
 
-#ifdef DOOBLE_MMAN_PRESENT
-  mlock(m_key.constData(), static_cast<size_t> (m_key.length()));
-  mlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
-  mlock(m_state, 4 * 4 * sizeof(m_state[0][0]));
-#endif
-  m_state[0][0] = m_state[0][1] = m_state[0][2] = m_state[0][3] = 0;
-  m_state[1][0] = m_state[1][1] = m_state[1][2] = m_state[1][3] = 0;
-  m_state[2][0] = m_state[2][1] = m_state[2][2] = m_state[2][3] = 0;
-  m_state[3][0] = m_state[3][1] = m_state[3][2] = m_state[3][3] = 0;
-  dooble_ui_utilities::memset
-    (m_round_key, 0, 4 * 60 * sizeof(m_round_key[0][0]));
-  key_expansion();
+  while(y)
+    {
+      if(y & 1)
+	product ^= x;
+
+      x = static_cast<uint8_t> ((x << 1) ^ (((x >> 7) & 1) * 0x1b));
+      y >>= 1;
+    }
+
+  return product;
 }
 
-dooble_aes256::~dooble_aes256()
+static uint32_t load_word(const uint8_t *bytes)
 {
-  dooble_cryptography::memzero(m_key);
-  dooble_ui_utilities::memset
-    (m_round_key, 0, 4 * 60 * sizeof(m_round_key[0][0]));
-  dooble_ui_utilities::memset(m_state, 0, 4 * 4 * sizeof(m_state[0][0]));
-#ifdef DOOBLE_MMAN_PRESENT
-  munlock(m_key.constData(), static_cast<size_t> (m_key.length()));
-  munlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
-  munlock(m_state, 4 * 4 * sizeof(m_state[0][0]));
-#endif
+  return (static_cast<uint32_t> (bytes[0]) << 24) |
+    (static_cast<uint32_t> (bytes[1]) << 16) |
+    (static_cast<uint32_t> (bytes[2]) << 8) |
+    static_cast<uint32_t> (bytes[3]);
 }
 
-QByteArray dooble_aes256::decrypt(const QByteArray &data)
+static uint32_t rotate_right(const uint32_t x, const int n)
 {
-  /*
-  ** CBC
-  */
+  return (x >> n) | (x << (32 - n));
+}
 
-  auto iv(data.mid(0, m_block_length));
+static void store_word(uint8_t *bytes, const uint32_t word)
+{
+  bytes[0] = static_cast<uint8_t> (word >> 24);
+  bytes[1] = static_cast<uint8_t> (word >> 16);
+  bytes[2] = static_cast<uint8_t> (word >> 8);
+  bytes[3] = static_cast<uint8_t> (word);
+}
 
-  if(Q_UNLIKELY(iv.length() != m_block_length))
-    return QByteArray();
+static const dooble_aes256_tables &tables(void)
+{
+  static const auto t = []()
+  {
+    dooble_aes256_tables t;
 
-  QByteArray block(m_block_length, 0);
-  QByteArray c;
-  QByteArray decrypted;
-  auto ciphertext(data.mid(iv.length()));
-  auto iterations = ciphertext.length() / m_block_length;
+    for(size_t i = 0; i < 256; i++)
+      {
+	auto is = s_inv_sbox[i];
+	auto s = s_sbox[i];
+
+	t.Td[0][i] = (static_cast<uint32_t> (multiply(is, 0x0e)) << 24) |
+	  (static_cast<uint32_t> (multiply(is, 0x09)) << 16) |
+	  (static_cast<uint32_t> (multiply(is, 0x0d)) << 8) |
+	  static_cast<uint32_t> (multiply(is, 0x0b));
+	t.Te[0][i] = (static_cast<uint32_t> (multiply(s, 0x02)) << 24) |
+	  (static_cast<uint32_t> (s) << 16) |
+	  (static_cast<uint32_t> (s) << 8) |
+	  static_cast<uint32_t> (multiply(s, 0x03));
+
+	for(size_t j = 1; j < 4; j++)
+	  {
+	    t.Td[j][i] = rotate_right(t.Td[0][i], 8 * static_cast<int> (j));
+	    t.Te[j][i] = rotate_right(t.Te[0][i], 8 * static_cast<int> (j));
+	  }
+      }
 
-  for(int i = 0; i < iterations; i++)
-    {
-      auto position = i * m_block_length;
+    return t;
+  }();
 
-      block = decrypt_block(ciphertext.mid(position, m_block_length));
+  return t;
+}
 
-      if(Q_UNLIKELY(block.isEmpty()))
-	{
-	  decrypted.clear();
-	  break;
-	}
+static void tables_decrypt_block(const uint8_t *round_key,
+				 const size_t Nr,
+				 const uint8_t *in,
+				 uint8_t *out)
+{
+  const auto &T = tables();
+  uint32_t s[4];
+  uint32_t t[4];
 
-      if(i == 0)
-	block = xor_arrays(block, iv);
-      else
-	block = xor_arrays(block, c);
+  s[0] = load_word(in + 0) ^ load_word(round_key + 0);
+  s[1] = load_word(in + 4) ^ load_word(round_key + 4);
+  s[2] = load_word(in + 8) ^ load_word(round_key + 8);
+  s[3] = load_word(in + 12) ^ load_word(round_key + 12);
 
-      c = ciphertext.mid(position, m_block_length);
-      decrypted.append(block);
+  for(size_t i = 1; i < Nr; i++)
+    {
+      auto k = round_key + 16 * i;
+
+      t[0] = T.Td[0][s[0] >> 24] ^
+	T.Td[1][(s[3] >> 16) & 0xff] ^
+	T.Td[2][(s[2] >> 8) & 0xff] ^
+	T.Td[3][s[1] & 0xff] ^
+	load_word(k + 0);
+      t[1] = T.Td[0][s[1] >> 24] ^
+	T.Td[1][(s[0] >> 16) & 0xff] ^
+	T.Td[2][(s[3] >> 8) & 0xff] ^
+	T.Td[3][s[2] & 0xff] ^
+	load_word(k + 4);
+      t[2] = T.Td[0][s[2] >> 24] ^
+	T.Td[1][(s[1] >> 16) & 0xff] ^
+	T.Td[2][(s[0] >> 8) & 0xff] ^
+	T.Td[3][s[3] & 0xff] ^
+	load_word(k + 8);
+      t[3] = T.Td[0][s[3] >> 24] ^
+	T.Td[1][(s[2] >> 16) & 0xff] ^
+	T.Td[2][(s[1] >> 8) & 0xff] ^
+	T.Td[3][s[0] & 0xff] ^
+	load_word(k + 12);
+      s[0] = t[0];
+      s[1] = t[1];
+      s[2] = t[2];
+      s[3] = t[3];
     }
 
-  if(decrypted.isEmpty())
-    return decrypted;
+  auto k = round_key + 16 * Nr;
+
+  t[0] = (static_cast<uint32_t> (s_inv_sbox[s[0] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[3] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[2] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_inv_sbox[s[1] & 0xff]) ^
+    load_word(k + 0);
+  t[1] = (static_cast<uint32_t> (s_inv_sbox[s[1] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[0] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[3] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_inv_sbox[s[2] & 0xff]) ^
+    load_word(k + 4);
+  t[2] = (static_cast<uint32_t> (s_inv_sbox[s[2] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[1] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[0] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_inv_sbox[s[3] & 0xff]) ^
+    load_word(k + 8);
+  t[3] = (static_cast<uint32_t> (s_inv_sbox[s[3] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[2] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_inv_sbox[(s[1] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_inv_sbox[s[0] & 0xff]) ^
+    load_word(k + 12);
+  store_word(out + 0, t[0]);
+  store_word(out + 4, t[1]);
+  store_word(out + 8, t[2]);
+  store_word(out + 12, t[3]);
+  dooble_ui_utilities::memset(s, 0, sizeof(s));
+  dooble_ui_utilities::memset(t, 0, sizeof(t));
+}
 
-  QByteArray originalLength;
+static void tables_encrypt_block(const uint8_t *round_key,
+				 const size_t Nr,
+				 const uint8_t *in,
+				 uint8_t *out)
+{
+  const auto &T = tables();
+  uint32_t s[4];
+  uint32_t t[4];
 
-  if(decrypted.length() > static_cast<int> (sizeof(int)))
-    originalLength = decrypted.mid
-      (decrypted.length() - static_cast<int> (sizeof(int)),
-       static_cast<int> (sizeof(int)));
+  s[0] = load_word(in + 0) ^ load_word(round_key + 0);
+  s[1] = load_word(in + 4) ^ load_word(round_key + 4);
+  s[2] = load_word(in + 8) ^ load_word(round_key + 8);
+  s[3] = load_word(in + 12) ^ load_word(round_key + 12);
 
-  if(!originalLength.isEmpty())
+  for(size_t i = 1; i < Nr; i++)
     {
-      QDataStream in(&originalLength, QIODevice::ReadOnly);
-      int s = 0;
-
-      in >> s;
-
-      if(in.status() != QDataStream::Ok)
-	decrypted.clear();
-      else
-	{
-	  if(s >= 0 && s <= decrypted.length())
-	    decrypted = decrypted.mid(0, s);
-	  else
-	    decrypted.clear();
-	}
+      auto k = round_key + 16 * i;
+
+      t[0] = T.Te[0][s[0] >> 24] ^
+	T.Te[1][(s[1] >> 16) & 0xff] ^
+	T.Te[2][(s[2] >> 8) & 0xff] ^
+	T.Te[3][s[3] & 0xff] ^
+	load_word(k + 0);
+      t[1] = T.Te[0][s[1] >> 24] ^
+	T.Te[1][(s[2] >> 16) & 0xff] ^
+	T.Te[2][(s[3] >> 8) & 0xff] ^
+	T.Te[3][s[0] & 0xff] ^
+	load_word(k + 4);
+      t[2] = T.Te[0][s[2] >> 24] ^
+	T.Te[1][(s[3] >> 16) & 0xff] ^
+	T.Te[2][(s[0] >> 8) & 0xff] ^
+	T.Te[3][s[1] & 0xff] ^
+	load_word(k + 8);
+      t[3] = T.Te[0][s[3] >> 24] ^
+	T.Te[1][(s[0] >> 16) & 0xff] ^
+	T.Te[2][(s[1] >> 8) & 0xff] ^
+	T.Te[3][s[2] & 0xff] ^
+	load_word(k + 12);
+      s[0] = t[0];
+      s[1] = t[1];
+      s[2] = t[2];
+      s[3] = t[3];
     }
-  else
-    decrypted.clear();
 
-  return decrypted;
+  auto k = round_key + 16 * Nr;
+
+  t[0] = (static_cast<uint32_t> (s_sbox[s[0] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_sbox[(s[1] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_sbox[(s[2] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_sbox[s[3] & 0xff]) ^
+    load_word(k + 0);
+  t[1] = (static_cast<uint32_t> (s_sbox[s[1] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_sbox[(s[2] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_sbox[(s[3] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_sbox[s[0] & 0xff]) ^
+    load_word(k + 4);
+  t[2] = (static_cast<uint32_t> (s_sbox[s[2] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_sbox[(s[3] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_sbox[(s[0] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_sbox[s[1] & 0xff]) ^
+    load_word(k + 8);
+  t[3] = (static_cast<uint32_t> (s_sbox[s[3] >> 24]) << 24) ^
+    (static_cast<uint32_t> (s_sbox[(s[0] >> 16) & 0xff]) << 16) ^
+    (static_cast<uint32_t> (s_sbox[(s[1] >> 8) & 0xff]) << 8) ^
+    static_cast<uint32_t> (s_sbox[s[2] & 0xff]) ^
+    load_word(k + 12);
+  store_word(out + 0, t[0]);
+  store_word(out + 4, t[1]);
+  store_word(out + 8, t[2]);
+  store_word(out + 12, t[3]);
+  dooble_ui_utilities::memset(s, 0, sizeof(s));
+  dooble_ui_utilities::memset(t, 0, sizeof(t));
 }
 
-QByteArray dooble_aes256::decrypt_block(const QByteArray &block)
+#ifdef DOOBLE_AES256_AESNI
+static bool aesni_supported(void)
 {
-  auto b(block);
+#if defined(_MSC_VER)
+  int registers[4] = {0, 0, 0, 0};
 
-  if(b.length() < 16)
-    b.append(16 - b.length(), static_cast<char> (16 - b.length()));
-  else
-    b.resize(16);
+  __cpuid(registers, 1);
+  return (registers[2] & (1 << 25)) && (registers[3] & (1 << 26));
+#else
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
 
-  m_state[0][0] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 0)));
-  m_state[0][1] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 1)));
-  m_state[0][2] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 2)));
-  m_state[0][3] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 3)));
-  m_state[1][0] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 0)));
-  m_state[1][1] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 1)));
-  m_state[1][2] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 2)));
-  m_state[1][3] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 3)));
-  m_state[2][0] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 0)));
-  m_state[2][1] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 1)));
-  m_state[2][2] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 2)));
-  m_state[2][3] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 3)));
-  m_state[3][0] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 0)));
-  m_state[3][1] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 1)));
-  m_state[3][2] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 2)));
-  m_state[3][3] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 3)));
-  add_round_key(m_Nr);
-
-  for(size_t i = m_Nr - 1; i > 0; i--)
-    {
-      inv_shift_rows();
-      inv_sub_bytes();
-      add_round_key(i);
-      inv_mix_columns();
-    }
+  if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+    return false;
 
-  inv_shift_rows();
-  inv_sub_bytes();
-  add_round_key(0);
-  b[static_cast<int> (0 + 4 * 0)] = static_cast<char> (m_state[0][0]);
-  b[static_cast<int> (0 + 4 * 1)] = static_cast<char> (m_state[0][1]);
-  b[static_cast<int> (0 + 4 * 2)] = static_cast<char> (m_state[0][2]);
-  b[static_cast<int> (0 + 4 * 3)] = static_cast<char> (m_state[0][3]);
-  b[static_cast<int> (1 + 4 * 0)] = static_cast<char> (m_state[1][0]);
-  b[static_cast<int> (1 + 4 * 1)] = static_cast<char> (m_state[1][1]);
-  b[static_cast<int> (1 + 4 * 2)] = static_cast<char> (m_state[1][2]);
-  b[static_cast<int> (1 + 4 * 3)] = static_cast<char> (m_state[1][3]);
-  b[static_cast<int> (2 + 4 * 0)] = static_cast<char> (m_state[2][0]);
-  b[static_cast<int> (2 + 4 * 1)] = static_cast<char> (m_state[2][1]);
-  b[static_cast<int> (2 + 4 * 2)] = static_cast<char> (m_state[2][2]);
-  b[static_cast<int> (2 + 4 * 3)] = static_cast<char> (m_state[2][3]);
-  b[static_cast<int> (3 + 4 * 0)] = static_cast<char> (m_state[3][0]);
-  b[static_cast<int> (3 + 4 * 1)] = static_cast<char> (m_state[3][1]);
-  b[static_cast<int> (3 + 4 * 2)] = static_cast<char> (m_state[3][2]);
-  b[static_cast<int> (3 + 4 * 3)] = static_cast<char> (m_state[3][3]);
-  return b;
+  return (ecx & bit_AES) && (edx & bit_SSE2);
+#endif
 }
 
-QByteArray dooble_aes256::encrypt(const QByteArray &data)
+DOOBLE_AES256_AESNI_TARGET
+static void aesni_decrypt_block(const uint8_t *round_key,
+				const size_t Nr,
+				const uint8_t *in,
+				uint8_t *out)
 {
-  /*
-  ** CBC
-  */
+  auto k = reinterpret_cast<const __m128i *> (round_key);
+  auto s = _mm_xor_si128
+    (_mm_loadu_si128(reinterpret_cast<const __m128i *> (in)),
+     _mm_loadu_si128(k));
+
+  for(size_t i = 1; i < Nr; i++)
+    s = _mm_aesdec_si128(s, _mm_loadu_si128(k + i));
+
+  s = _mm_aesdeclast_si128(s, _mm_loadu_si128(k + Nr));
+  _mm_storeu_si128(reinterpret_cast<__m128i *> (out), s);
+}
 
-  auto iv(dooble_random::random_bytes(m_block_length));
+DOOBLE_AES256_AESNI_TARGET
+static void aesni_encrypt_block(const uint8_t *round_key,
+				const size_t Nr,
+				const uint8_t *in,
+				uint8_t *out)
+{
+  auto k = reinterpret_cast<const __m128i *> (round_key);
+  auto s = _mm_xor_si128
+    (_mm_loadu_si128(reinterpret_cast<const __m128i *> (in)),
+     _mm_loadu_si128(k));
 
-  if(Q_UNLIKELY(iv.isEmpty()))
-    return QByteArray();
+  for(size_t i = 1; i < Nr; i++)
+    s = _mm_aesenc_si128(s, _mm_loadu_si128(k + i));
 
+  s = _mm_aesenclast_si128(s, _mm_loadu_si128(k + Nr));
+  _mm_storeu_si128(reinterpret_cast<__m128i *> (out), s);
+}
+#endif
+
+#ifdef DOOBLE_AES256_ARMV8
+static bool armv8_supported(void)
+{
+#if defined(Q_OS_LINUX) && defined(HWCAP_AES)
+  return getauxval(AT_HWCAP) & HWCAP_AES;
+#else
   /*
-  ** Resize the container to the block size.
+  ** The compiler was instructed to assume the cryptography extension.
   */
 
-  QByteArray block(iv.length(), 0);
-  QByteArray encrypted;
-  auto plaintext(data);
-
-  if(plaintext.isEmpty())
-    plaintext = plaintext.leftJustified(m_block_length, 0);
-  else
-    plaintext = plaintext.leftJustified
-      (m_block_length *
-       static_cast<int> (qCeil(static_cast<qreal> (plaintext.length()) /
-			       static_cast<qreal> (m_block_length)) + 1), 0);
+  return true;
+#endif
+}
 
-  QByteArray originalLength;
-  QDataStream out(&originalLength, QIODevice::WriteOnly);
+static void armv8_decrypt_block(const uint8_t *round_key,
+				const size_t Nr,
+				const uint8_t *in,
+				uint8_t *out)
+{
+  auto s = vld1q_u8(in);
 
-  out << static_cast<int> (data.length());
+  for(size_t i = 0; i < Nr - 1; i++)
+    s = vaesimcq_u8(vaesdq_u8(s, vld1q_u8(round_key + 16 * i)));
 
-  if(out.status() != QDataStream::Ok)
-    return QByteArray();
+  s = vaesdq_u8(s, vld1q_u8(round_key + 16 * (Nr - 1)));
+  s = veorq_u8(s, vld1q_u8(round_key + 16 * Nr));
+  vst1q_u8(out, s);
+}
 
-  plaintext.replace
-    (plaintext.length() - static_cast<int> (sizeof(int)),
-     static_cast<int> (sizeof(int)),
-     originalLength);
+static void armv8_encrypt_block(const uint8_t *round_key,
+				const size_t Nr,
+				const uint8_t *in,
+				uint8_t *out)
+{
+  auto s = vld1q_u8(in);
 
-  auto iterations = plaintext.length() / m_block_length;
+  for(size_t i = 0; i < Nr - 1; i++)
+    s = vaesmcq_u8(vaeseq_u8(s, vld1q_u8(round_key + 16 * i)));
 
-  for(int i = 0; i < iterations; i++)
-    {
-      QByteArray p;
-      auto position = i * m_block_length;
+  s = vaeseq_u8(s, vld1q_u8(round_key + 16 * (Nr - 1)));
+  s = veorq_u8(s, vld1q_u8(round_key + 16 * Nr));
+  vst1q_u8(out, s);
+}
+#endif
 
-      p = plaintext.mid(position, m_block_length);
+dooble_aes256::dooble_aes256(const QByteArray &key):dooble_block_cipher(key)
+{
+  m_Nb = 4;
+  m_Nk = 8;
+  m_Nr = 14;
+  m_block_length = 16; // Or, 128 bits.
+  m_engine = preferred_engine();
+  m_key_length = 32; // Or, 256 bits.
 
-      if(i == 0)
-	block = xor_arrays(iv, p);
-      else
-	block = xor_arrays(block, p);
+  if(m_key.length() < m_key_length)
+    m_key.append(m_key_length - m_key.length(), 0);
+  else
+    m_key.resize(m_key_length);
 
-      block = encrypt_block(block);
+#ifdef DOOBLE_MMAN_PRESENT
+  mlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  mlock(m_inverse_round_key, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
+  mlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
+#endif
+  dooble_ui_utilities::memset
+    (m_inverse_round_key, 0, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
+  dooble_ui_utilities::memset
+    (m_round_key, 0, 4 * 60 * sizeof(m_round_key[0][0]));
+  key_expansion();
+}
 
-      if(Q_UNLIKELY(block.isEmpty()))
-	{
-	  encrypted.clear();
-	  break;
-	}
+dooble_aes256::~dooble_aes256()
+{
+  dooble_cryptography::memzero(m_key);
+  dooble_ui_utilities::memset
+    (m_inverse_round_key, 0, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
+  dooble_ui_utilities::memset
+    (m_round_key, 0, 4 * 60 * sizeof(m_round_key[0][0]));
+#ifdef DOOBLE_MMAN_PRESENT
+  munlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  munlock(m_inverse_round_key, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
+  munlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
+#endif
+}
 
-      encrypted.append(block);
-    }
+QByteArray dooble_aes256::decrypt_block(const QByteArray &block) const
+{
+  auto b(block);
 
-  if(encrypted.isEmpty())
-    return encrypted;
+  if(b.length() < 16)
+    b.append(16 - b.length(), static_cast<char> (16 - b.length()));
+  else
+    b.resize(16);
 
-  return iv + encrypted;
+  decrypt_block(reinterpret_cast<const uint8_t *> (b.constData()),
+		reinterpret_cast<uint8_t *> (b.data()));
+  return b;
 }
 
-QByteArray dooble_aes256::encrypt_block(const QByteArray &block)
+QByteArray dooble_aes256::encrypt_block(const QByteArray &block) const
 {
   auto b(block);
 
@@ -384,180 +554,126 @@ QByteArray dooble_aes256::encrypt_block(const QByteArray &block)
   else
     b.resize(16);
 
-  m_state[0][0] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 0)));
-  m_state[0][1] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 1)));
-  m_state[0][2] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 2)));
-  m_state[0][3] = static_cast<uint8_t> (b.at(static_cast<int> (0 + 4 * 3)));
-  m_state[1][0] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 0)));
-  m_state[1][1] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 1)));
-  m_state[1][2] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 2)));
-  m_state[1][3] = static_cast<uint8_t> (b.at(static_cast<int> (1 + 4 * 3)));
-  m_state[2][0] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 0)));
-  m_state[2][1] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 1)));
-  m_state[2][2] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 2)));
-  m_state[2][3] = static_cast<uint8_t> (b.at(static_cast<int> (2 + 4 * 3)));
-  m_state[3][0] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 0)));
-  m_state[3][1] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 1)));
-  m_state[3][2] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 2)));
-  m_state[3][3] = static_cast<uint8_t> (b.at(static_cast<int> (3 + 4 * 3)));
-  add_round_key(0);
-
-  for(size_t i = 1; i < m_Nr; i++)
+  encrypt_block(reinterpret_cast<const uint8_t *> (b.constData()),
+		reinterpret_cast<uint8_t *> (b.data()));
+  return b;
+}
+
+QList<dooble_aes256::Engines> dooble_aes256::supported_engines(void)
+{
+  static const auto engines = []()
+  {
+    QList<dooble_aes256::Engines> engines;
+
+#ifdef DOOBLE_AES256_AESNI
+    if(aesni_supported())
+      engines << dooble_aes256::Engines::AESNI;
+#endif
+#ifdef DOOBLE_AES256_ARMV8
+    if(armv8_supported())
+      engines << dooble_aes256::Engines::ARMV8;
+#endif
+    engines << dooble_aes256::Engines::TABLES;
+    return engines;
+  }();
+
+  return engines;
+}
+
+QString dooble_aes256::engine_name(const Engines engine)
+{
+  switch(engine)
     {
-      sub_bytes();
-      shift_rows();
-      mix_columns();
-      add_round_key(i);
+    case dooble_aes256::Engines::AESNI:
+      {
+	return "AES-NI";
+      }
+    case dooble_aes256::Engines::ARMV8:
+      {
+	return "ARMv8";
+      }
+    default:
+      {
+	return "Tables";
+      }
     }
+}
 
-  sub_bytes();
-  shift_rows();
-  add_round_key(m_Nr);
-  b[static_cast<int> (0 + 4 * 0)] = static_cast<char> (m_state[0][0]);
-  b[static_cast<int> (0 + 4 * 1)] = static_cast<char> (m_state[0][1]);
-  b[static_cast<int> (0 + 4 * 2)] = static_cast<char> (m_state[0][2]);
-  b[static_cast<int> (0 + 4 * 3)] = static_cast<char> (m_state[0][3]);
-  b[static_cast<int> (1 + 4 * 0)] = static_cast<char> (m_state[1][0]);
-  b[static_cast<int> (1 + 4 * 1)] = static_cast<char> (m_state[1][1]);
-  b[static_cast<int> (1 + 4 * 2)] = static_cast<char> (m_state[1][2]);
-  b[static_cast<int> (1 + 4 * 3)] = static_cast<char> (m_state[1][3]);
-  b[static_cast<int> (2 + 4 * 0)] = static_cast<char> (m_state[2][0]);
-  b[static_cast<int> (2 + 4 * 1)] = static_cast<char> (m_state[2][1]);
-  b[static_cast<int> (2 + 4 * 2)] = static_cast<char> (m_state[2][2]);
-  b[static_cast<int> (2 + 4 * 3)] = static_cast<char> (m_state[2][3]);
-  b[static_cast<int> (3 + 4 * 0)] = static_cast<char> (m_state[3][0]);
-  b[static_cast<int> (3 + 4 * 1)] = static_cast<char> (m_state[3][1]);
-  b[static_cast<int> (3 + 4 * 2)] = static_cast<char> (m_state[3][2]);
-  b[static_cast<int> (3 + 4 * 3)] = static_cast<char> (m_state[3][3]);
-  return b;
+dooble_aes256::Engines dooble_aes256::preferred_engine(void)
+{
+  return supported_engines().value(0, dooble_aes256::Engines::TABLES);
 }
 
-void dooble_aes256::add_round_key(size_t c)
-{
-  auto product = c * m_Nb;
-
-  m_state[0][0] ^= m_round_key[product + 0][0];
-  m_state[0][1] ^= m_round_key[product + 1][0];
-  m_state[0][2] ^= m_round_key[product + 2][0];
-  m_state[0][3] ^= m_round_key[product + 3][0];
-  m_state[1][0] ^= m_round_key[product + 0][1];
-  m_state[1][1] ^= m_round_key[product + 1][1];
-  m_state[1][2] ^= m_round_key[product + 2][1];
-  m_state[1][3] ^= m_round_key[product + 3][1];
-  m_state[2][0] ^= m_round_key[product + 0][2];
-  m_state[2][1] ^= m_round_key[product + 1][2];
-  m_state[2][2] ^= m_round_key[product + 2][2];
-  m_state[2][3] ^= m_round_key[product + 3][2];
-  m_state[3][0] ^= m_round_key[product + 0][3];
-  m_state[3][1] ^= m_round_key[product + 1][3];
-  m_state[3][2] ^= m_round_key[product + 2][3];
-  m_state[3][3] ^= m_round_key[product + 3][3];
-}
-
-void dooble_aes256::inv_mix_columns(void)
-{
-  uint8_t a[4];
-
-  a[0] = m_state[0][0];
-  a[1] = m_state[1][0];
-  a[2] = m_state[2][0];
-  a[3] = m_state[3][0];
-  m_state[0][0] = xtime_special(0x0e, a[0]) ^ xtime_special(0x0b, a[1]) ^
-    xtime_special(0x0d, a[2]) ^ xtime_special(0x09, a[3]);
-  m_state[1][0] = xtime_special(0x09, a[0]) ^ xtime_special(0x0e, a[1]) ^
-    xtime_special(0x0b, a[2]) ^ xtime_special(0x0d, a[3]);
-  m_state[2][0] = xtime_special(0x0d, a[0]) ^ xtime_special(0x09, a[1]) ^
-    xtime_special(0x0e, a[2]) ^ xtime_special(0x0b, a[3]);
-  m_state[3][0] = xtime_special(0x0b, a[0]) ^ xtime_special(0x0d, a[1]) ^
-    xtime_special(0x09, a[2]) ^ xtime_special(0x0e, a[3]);
-  a[0] = m_state[0][1];
-  a[1] = m_state[1][1];
-  a[2] = m_state[2][1];
-  a[3] = m_state[3][1];
-  m_state[0][1] = xtime_special(0x0e, a[0]) ^ xtime_special(0x0b, a[1]) ^
-    xtime_special(0x0d, a[2]) ^ xtime_special(0x09, a[3]);
-  m_state[1][1] = xtime_special(0x09, a[0]) ^ xtime_special(0x0e, a[1]) ^
-    xtime_special(0x0b, a[2]) ^ xtime_special(0x0d, a[3]);
-  m_state[2][1] = xtime_special(0x0d, a[0]) ^ xtime_special(0x09, a[1]) ^
-    xtime_special(0x0e, a[2]) ^ xtime_special(0x0b, a[3]);
-  m_state[3][1] = xtime_special(0x0b, a[0]) ^ xtime_special(0x0d, a[1]) ^
-    xtime_special(0x09, a[2]) ^ xtime_special(0x0e, a[3]);
-  a[0] = m_state[0][2];
-  a[1] = m_state[1][2];
-  a[2] = m_state[2][2];
-  a[3] = m_state[3][2];
-  m_state[0][2] = xtime_special(0x0e, a[0]) ^ xtime_special(0x0b, a[1]) ^
-    xtime_special(0x0d, a[2]) ^ xtime_special(0x09, a[3]);
-  m_state[1][2] = xtime_special(0x09, a[0]) ^ xtime_special(0x0e, a[1]) ^
-    xtime_special(0x0b, a[2]) ^ xtime_special(0x0d, a[3]);
-  m_state[2][2] = xtime_special(0x0d, a[0]) ^ xtime_special(0x09, a[1]) ^
-    xtime_special(0x0e, a[2]) ^ xtime_special(0x0b, a[3]);
-  m_state[3][2] = xtime_special(0x0b, a[0]) ^ xtime_special(0x0d, a[1]) ^
-    xtime_special(0x09, a[2]) ^ xtime_special(0x0e, a[3]);
-  a[0] = m_state[0][3];
-  a[1] = m_state[1][3];
-  a[2] = m_state[2][3];
-  a[3] = m_state[3][3];
-  m_state[0][3] = xtime_special(0x0e, a[0]) ^ xtime_special(0x0b, a[1]) ^
-    xtime_special(0x0d, a[2]) ^ xtime_special(0x09, a[3]);
-  m_state[1][3] = xtime_special(0x09, a[0]) ^ xtime_special(0x0e, a[1]) ^
-    xtime_special(0x0b, a[2]) ^ xtime_special(0x0d, a[3]);
-  m_state[2][3] = xtime_special(0x0d, a[0]) ^ xtime_special(0x09, a[1]) ^
-    xtime_special(0x0e, a[2]) ^ xtime_special(0x0b, a[3]);
-  m_state[3][3] = xtime_special(0x0b, a[0]) ^ xtime_special(0x0d, a[1]) ^
-    xtime_special(0x09, a[2]) ^ xtime_special(0x0e, a[3]);
-  dooble_ui_utilities::memset(a, 0, 4 * sizeof(a[0]));
-}
-
-void dooble_aes256::inv_shift_rows(void)
+bool dooble_aes256::decrypt_block(const uint8_t *in, uint8_t *out) const
 {
-  uint8_t temp[4];
+  switch(m_engine)
+    {
+#ifdef DOOBLE_AES256_AESNI
+    case dooble_aes256::Engines::AESNI:
+      {
+	aesni_decrypt_block(&m_inverse_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+#endif
+#ifdef DOOBLE_AES256_ARMV8
+    case dooble_aes256::Engines::ARMV8:
+      {
+	armv8_decrypt_block(&m_inverse_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+#endif
+    default:
+      {
+	tables_decrypt_block(&m_inverse_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+    }
 
-  temp[0] = m_state[1][0];
-  temp[1] = m_state[1][1];
-  temp[2] = m_state[1][2];
-  temp[3] = m_state[1][3];
-  m_state[1][(1 + 0) % m_Nb] = temp[0];
-  m_state[1][(1 + 1) % m_Nb] = temp[1];
-  m_state[1][(1 + 2) % m_Nb] = temp[2];
-  m_state[1][(1 + 3) % m_Nb] = temp[3];
-  temp[0] = m_state[2][0];
-  temp[1] = m_state[2][1];
-  temp[2] = m_state[2][2];
-  temp[3] = m_state[2][3];
-  m_state[2][(2 + 0) % m_Nb] = temp[0];
-  m_state[2][(2 + 1) % m_Nb] = temp[1];
-  m_state[2][(2 + 2) % m_Nb] = temp[2];
-  m_state[2][(2 + 3) % m_Nb] = temp[3];
-  temp[0] = m_state[3][0];
-  temp[1] = m_state[3][1];
-  temp[2] = m_state[3][2];
-  temp[3] = m_state[3][3];
-  m_state[3][(3 + 0) % m_Nb] = temp[0];
-  m_state[3][(3 + 1) % m_Nb] = temp[1];
-  m_state[3][(3 + 2) % m_Nb] = temp[2];
-  m_state[3][(3 + 3) % m_Nb] = temp[3];
-  dooble_ui_utilities::memset(temp, 0, 4 * sizeof(temp[0]));
-}
-
-void dooble_aes256::inv_sub_bytes(void)
-{
-  m_state[0][0] = s_inv_sbox[static_cast<size_t> (m_state[0][0])];
-  m_state[0][1] = s_inv_sbox[static_cast<size_t> (m_state[0][1])];
-  m_state[0][2] = s_inv_sbox[static_cast<size_t> (m_state[0][2])];
-  m_state[0][3] = s_inv_sbox[static_cast<size_t> (m_state[0][3])];
-  m_state[1][0] = s_inv_sbox[static_cast<size_t> (m_state[1][0])];
-  m_state[1][1] = s_inv_sbox[static_cast<size_t> (m_state[1][1])];
-  m_state[1][2] = s_inv_sbox[static_cast<size_t> (m_state[1][2])];
-  m_state[1][3] = s_inv_sbox[static_cast<size_t> (m_state[1][3])];
-  m_state[2][0] = s_inv_sbox[static_cast<size_t> (m_state[2][0])];
-  m_state[2][1] = s_inv_sbox[static_cast<size_t> (m_state[2][1])];
-  m_state[2][2] = s_inv_sbox[static_cast<size_t> (m_state[2][2])];
-  m_state[2][3] = s_inv_sbox[static_cast<size_t> (m_state[2][3])];
-  m_state[3][0] = s_inv_sbox[static_cast<size_t> (m_state[3][0])];
-  m_state[3][1] = s_inv_sbox[static_cast<size_t> (m_state[3][1])];
-  m_state[3][2] = s_inv_sbox[static_cast<size_t> (m_state[3][2])];
-  m_state[3][3] = s_inv_sbox[static_cast<size_t> (m_state[3][3])];
+  return true;
+}
+
+bool dooble_aes256::encrypt_block(const uint8_t *in, uint8_t *out) const
+{
+  switch(m_engine)
+    {
+#ifdef DOOBLE_AES256_AESNI
+    case dooble_aes256::Engines::AESNI:
+      {
+	aesni_encrypt_block(&m_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+#endif
+#ifdef DOOBLE_AES256_ARMV8
+    case dooble_aes256::Engines::ARMV8:
+      {
+	armv8_encrypt_block(&m_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+#endif
+    default:
+      {
+	tables_encrypt_block(&m_round_key[0][0], m_Nr, in, out);
+	break;
+      }
+    }
+
+  return true;
+}
+
+bool dooble_aes256::set_engine(const dooble_aes256::Engines engine)
+{
+  if(supported_engines().contains(engine))
+    {
+      m_engine = engine;
+      return true;
+    }
+  else
+    return false;
+}
+
+dooble_aes256::Engines dooble_aes256::engine(void) const
+{
+  return m_engine;
 }
 
 void dooble_aes256::key_expansion(void)
@@ -621,71 +737,36 @@ void dooble_aes256::key_expansion(void)
       dooble_ui_utilities::memset(temp, 0, 4 * sizeof(temp[0]));
       i += 1;
     }
-}
 
-void dooble_aes256::mix_columns(void)
-{
-  uint8_t a[4];
-  uint8_t b[4];
-
-  a[0] = m_state[0][0];
-  a[1] = m_state[1][0];
-  a[2] = m_state[2][0];
-  a[3] = m_state[3][0];
-  b[0] = xtime(m_state[0][0]);
-  b[1] = xtime(m_state[1][0]);
-  b[2] = xtime(m_state[2][0]);
-  b[3] = xtime(m_state[3][0]);
-  m_state[0][0] = b[0] ^ a[1] ^ b[1] ^ a[2] ^ a[3];
-  m_state[1][0] = a[0] ^ b[1] ^ a[2] ^ b[2] ^ a[3];
-  m_state[2][0] = a[0] ^ a[1] ^ b[2] ^ a[3] ^ b[3];
-  m_state[3][0] = a[0] ^ b[0] ^ a[1] ^ a[2] ^ b[3];
-  a[0] = m_state[0][1];
-  a[1] = m_state[1][1];
-  a[2] = m_state[2][1];
-  a[3] = m_state[3][1];
-  b[0] = xtime(m_state[0][1]);
-  b[1] = xtime(m_state[1][1]);
-  b[2] = xtime(m_state[2][1]);
-  b[3] = xtime(m_state[3][1]);
-  m_state[0][1] = b[0] ^ a[1] ^ b[1] ^ a[2] ^ a[3];
-  m_state[1][1] = a[0] ^ b[1] ^ a[2] ^ b[2] ^ a[3];
-  m_state[2][1] = a[0] ^ a[1] ^ b[2] ^ a[3] ^ b[3];
-  m_state[3][1] = a[0] ^ b[0] ^ a[1] ^ a[2] ^ b[3];
-  a[0] = m_state[0][2];
-  a[1] = m_state[1][2];
-  a[2] = m_state[2][2];
-  a[3] = m_state[3][2];
-  b[0] = xtime(m_state[0][2]);
-  b[1] = xtime(m_state[1][2]);
-  b[2] = xtime(m_state[2][2]);
-  b[3] = xtime(m_state[3][2]);
-  m_state[0][2] = b[0] ^ a[1] ^ b[1] ^ a[2] ^ a[3];
-  m_state[1][2] = a[0] ^ b[1] ^ a[2] ^ b[2] ^ a[3];
-  m_state[2][2] = a[0] ^ a[1] ^ b[2] ^ a[3] ^ b[3];
-  m_state[3][2] = a[0] ^ b[0] ^ a[1] ^ a[2] ^ b[3];
-  a[0] = m_state[0][3];
-  a[1] = m_state[1][3];
-  a[2] = m_state[2][3];
-  a[3] = m_state[3][3];
-  b[0] = xtime(m_state[0][3]);
-  b[1] = xtime(m_state[1][3]);
-  b[2] = xtime(m_state[2][3]);
-  b[3] = xtime(m_state[3][3]);
-  m_state[0][3] = b[0] ^ a[1] ^ b[1] ^ a[2] ^ a[3];
-  m_state[1][3] = a[0] ^ b[1] ^ a[2] ^ b[2] ^ a[3];
-  m_state[2][3] = a[0] ^ a[1] ^ b[2] ^ a[3] ^ b[3];
-  m_state[3][3] = a[0] ^ b[0] ^ a[1] ^ a[2] ^ b[3];
-  dooble_ui_utilities::memset(a, 0, 4 * sizeof(a[0]));
-  dooble_ui_utilities::memset(b, 0, 4 * sizeof(b[0]));
+  /*
+  ** The equivalent inverse cipher, section 5.3.5. The round keys are
+  ** stored in the order of their application. InvMixColumns() is
+  ** computed through the decryption tables.
+  */
+
+  const auto &T = tables();
+
+  for(size_t r = 0; r <= m_Nr; r++)
+    for(size_t j = 0; j < m_Nb; j++)
+      {
+	auto w = load_word(m_round_key[m_Nb * (m_Nr - r) + j]);
+
+	if(r > 0 && r < m_Nr)
+	  w = T.Td[0][s_sbox[w >> 24]] ^
+	    T.Td[1][s_sbox[(w >> 16) & 0xff]] ^
+	    T.Td[2][s_sbox[(w >> 8) & 0xff]] ^
+	    T.Td[3][s_sbox[w & 0xff]];
+
+	store_word(m_inverse_round_key[m_Nb * r + j], w);
+      }
 }
 
 void dooble_aes256::set_key(const QByteArray &key)
 {
 #ifdef DOOBLE_MMAN_PRESENT
   munlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  munlock(m_inverse_round_key, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
   munlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
-  munlock(m_state, 4 * 4 * sizeof(m_state[0][0]));
 #endif
   m_key = key;
 
@@ -696,69 +777,16 @@ void dooble_aes256::set_key(const QByteArray &key)
 
 #ifdef DOOBLE_MMAN_PRESENT
   mlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  mlock(m_inverse_round_key, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
   mlock(m_round_key, 4 * 60 * sizeof(m_round_key[0][0]));
-  mlock(m_state, 4 * 4 * sizeof(m_state[0][0]));
 #endif
-  m_state[0][0] = m_state[0][1] = m_state[0][2] = m_state[0][3] = 0;
-  m_state[1][0] = m_state[1][1] = m_state[1][2] = m_state[1][3] = 0;
-  m_state[2][0] = m_state[2][1] = m_state[2][2] = m_state[2][3] = 0;
-  m_state[3][0] = m_state[3][1] = m_state[3][2] = m_state[3][3] = 0;
+  dooble_ui_utilities::memset
+    (m_inverse_round_key, 0, 4 * 60 * sizeof(m_inverse_round_key[0][0]));
   dooble_ui_utilities::memset
     (m_round_key, 0, 4 * 60 * sizeof(m_round_key[0][0]));
   key_expansion();
 }
 
-void dooble_aes256::shift_rows(void)
-{
-  uint8_t temp[4];
-
-  temp[0] = m_state[1][(1 + 0) % m_Nb];
-  temp[1] = m_state[1][(1 + 1) % m_Nb];
-  temp[2] = m_state[1][(1 + 2) % m_Nb];
-  temp[3] = m_state[1][(1 + 3) % m_Nb];
-  m_state[1][0] = temp[0];
-  m_state[1][1] = temp[1];
-  m_state[1][2] = temp[2];
-  m_state[1][3] = temp[3];
-  temp[0] = m_state[2][(2 + 0) % m_Nb];
-  temp[1] = m_state[2][(2 + 1) % m_Nb];
-  temp[2] = m_state[2][(2 + 2) % m_Nb];
-  temp[3] = m_state[2][(2 + 3) % m_Nb];
-  m_state[2][0] = temp[0];
-  m_state[2][1] = temp[1];
-  m_state[2][2] = temp[2];
-  m_state[2][3] = temp[3];
-  temp[0] = m_state[3][(3 + 0) % m_Nb];
-  temp[1] = m_state[3][(3 + 1) % m_Nb];
-  temp[2] = m_state[3][(3 + 2) % m_Nb];
-  temp[3] = m_state[3][(3 + 3) % m_Nb];
-  m_state[3][0] = temp[0];
-  m_state[3][1] = temp[1];
-  m_state[3][2] = temp[2];
-  m_state[3][3] = temp[3];
-  dooble_ui_utilities::memset(temp, 0, 4 * sizeof(temp[0]));
-}
-
-void dooble_aes256::sub_bytes(void)
-{
-  m_state[0][0] = s_sbox[static_cast<size_t> (m_state[0][0])];
-  m_state[0][1] = s_sbox[static_cast<size_t> (m_state[0][1])];
-  m_state[0][2] = s_sbox[static_cast<size_t> (m_state[0][2])];
-  m_state[0][3] = s_sbox[static_cast<size_t> (m_state[0][3])];
-  m_state[1][0] = s_sbox[static_cast<size_t> (m_state[1][0])];
-  m_state[1][1] = s_sbox[static_cast<size_t> (m_state[1][1])];
-  m_state[1][2] = s_sbox[static_cast<size_t> (m_state[1][2])];
-  m_state[1][3] = s_sbox[static_cast<size_t> (m_state[1][3])];
-  m_state[2][0] = s_sbox[static_cast<size_t> (m_state[2][0])];
-  m_state[2][1] = s_sbox[static_cast<size_t> (m_state[2][1])];
-  m_state[2][2] = s_sbox[static_cast<size_t> (m_state[2][2])];
-  m_state[2][3] = s_sbox[static_cast<size_t> (m_state[2][3])];
-  m_state[3][0] = s_sbox[static_cast<size_t> (m_state[3][0])];
-  m_state[3][1] = s_sbox[static_cast<size_t> (m_state[3][1])];
-  m_state[3][2] = s_sbox[static_cast<size_t> (m_state[3][2])];
-  m_state[3][3] = s_sbox[static_cast<size_t> (m_state[3][3])];
-}
-
 void dooble_aes256::test1(void)
 {
   QByteArray text;
@@ -771,10 +799,29 @@ void dooble_aes256::test1(void)
     "m_state[i][2] = s_sbox[static_cast<size_t> (m_state[i][2])];"
     "m_state[i][3] = s_sbox[static_cast<size_t> (m_state[i][3])];"
     "}";
-  std::cout << ((text == aes256.decrypt(aes256.encrypt(text))) ?
-		"dooble_aes256::test1() passed!" :
-		"dooble_aes256::test1() failed!")
-	    << std::endl;
+
+  /*
+  ** Every engine must produce ciphertext which the portable engine
+  ** understands, and vice versa.
+  */
+
+  dooble_aes256 portable(aes256.m_key);
+
+  portable.m_engine = dooble_aes256::Engines::TABLES;
+
+  foreach(const auto engine, supported_engines())
+    {
+      aes256.m_engine = engine;
+
+      auto passed = text == aes256.decrypt(aes256.encrypt(text)) &&
+	text == aes256.decrypt(portable.encrypt(text)) &&
+	text == portable.decrypt(aes256.encrypt(text));
+
+      std::cout << "dooble_aes256::test1() ("
+		<< engine_name(engine).toStdString()
+		<< (passed ? ") passed!" : ") failed!")
+		<< std::endl;
+    }
 }
 
 void dooble_aes256::test1_decrypt_block(void)
@@ -784,12 +831,18 @@ void dooble_aes256::test1_decrypt_block(void)
 			 "101112131415161718191a1b1c1d1e1f"));
   dooble_aes256 aes256(key);
 
-  std::cout << "Decrypting 8ea2b7ca516745bfeafc49904b496089... ";
-  std::cout << aes256.decrypt_block
-    (QByteArray::fromHex("8ea2b7ca516745bfeafc49904b496089")).toHex().
-    toStdString()
-	    << "."
-	    << std::endl;
+  foreach(const auto engine, supported_engines())
+    {
+      aes256.m_engine = engine;
+      std::cout << "Decrypting 8ea2b7ca516745bfeafc49904b496089 ("
+		<< engine_name(engine).toStdString()
+		<< ")... ";
+      std::cout << aes256.decrypt_block
+	(QByteArray::fromHex("8ea2b7ca516745bfeafc49904b496089")).toHex().
+	toStdString()
+		<< "."
+		<< std::endl;
+    }
 }
 
 void dooble_aes256::test1_encrypt_block(void)
@@ -799,12 +852,18 @@ void dooble_aes256::test1_encrypt_block(void)
 			 "101112131415161718191a1b1c1d1e1f"));
   dooble_aes256 aes256(key);
 
-  std::cout << "Encrypting 00112233445566778899aabbccddeeff... ";
-  std::cout << aes256.encrypt_block
-    (QByteArray::fromHex("00112233445566778899aabbccddeeff")).toHex().
-    toStdString()
-	    << "."
-	    << std::endl;
+  foreach(const auto engine, supported_engines())
+    {
+      aes256.m_engine = engine;
+      std::cout << "Encrypting 00112233445566778899aabbccddeeff ("
+		<< engine_name(engine).toStdString()
+		<< ")... ";
+      std::cout << aes256.encrypt_block
+	(QByteArray::fromHex("00112233445566778899aabbccddeeff")).toHex().
+	toStdString()
+		<< "."
+		<< std::endl;
+    }
 }
 
 void dooble_aes256::test1_key_expansion(void)
@@ -832,13 +891,3 @@ void dooble_aes256::test1_key_expansion(void)
 	std::cout << std::endl;
       }
 }
-
-void dooble_aes256::test_performance(void)
-{
-  QElapsedTimer timer;
-
-  timer.start();
-  dooble_aes256 aes256(dooble_random::random_bytes(32));
-  aes256.decrypt(aes256.encrypt(QByteArray(500000, '1')));
-  qDebug() << "AES: " << timer.elapsed() << ".";
-}
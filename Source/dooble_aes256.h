@@ -29,6 +29,7 @@
 #define dooble_aes256_h
 
 #include <QByteArray>
+#include <QList>
 
 extern "C"
 {
@@ -40,51 +41,40 @@ extern "C"
 class dooble_aes256: public dooble_block_cipher
 {
  public:
+  enum Engines
+    {
+     AESNI,
+     ARMV8,
+     TABLES
+    };
+
   dooble_aes256(const QByteArray &key);
   ~dooble_aes256();
-  QByteArray decrypt(const QByteArray &data);
-  QByteArray encrypt(const QByteArray &data);
+  bool set_engine(const dooble_aes256::Engines engine);
+  dooble_aes256::Engines engine(void) const;
+  static QList<Engines> supported_engines(void);
+  static QString engine_name(const Engines engine);
+  static dooble_aes256::Engines preferred_engine(void);
   static void test1(void);
   static void test1_decrypt_block(void);
   static void test1_encrypt_block(void);
   static void test1_key_expansion(void);
-  static void test_performance(void);
   void set_key(const QByteArray &key);
 
+ protected:
+  bool encrypt_block(const uint8_t *in, uint8_t *out) const;
+
  private:
+  dooble_aes256::Engines m_engine;
   size_t m_Nb;
   size_t m_Nk;
   size_t m_Nr;
+  uint8_t m_inverse_round_key[60][4] {}; // Equivalent inverse cipher.
   uint8_t m_round_key[60][4] {};
-  uint8_t m_state[4][4] {}; // 4 rows, Nb columns.
-  QByteArray decrypt_block(const QByteArray &block);
-  QByteArray encrypt_block(const QByteArray &block);
-
-  uint8_t xtime(uint8_t x)
-  {
-    return static_cast<uint8_t> ((x << 1) ^ (((x >> 7) & 1) * 0x1b));
-  }
-
-  uint8_t xtime_special(uint8_t x, uint8_t y)
-  {
-    auto xtime_y = xtime(y);
-
-    return static_cast<uint8_t>
-      (((x & 1) * y) ^
-       (((x >> 1) & 1) * xtime_y) ^
-       (((x >> 2) & 1) * xtime(xtime_y)) ^
-       (((x >> 3) & 1) * xtime(xtime(xtime_y))) ^
-       (((x >> 4) & 1) * xtime(xtime(xtime(xtime_y)))));
-  }
-
-  void add_round_key(size_t c);
-  void inv_mix_columns(void);
-  void inv_shift_rows(void);
-  void inv_sub_bytes(void);
+  QByteArray decrypt_block(const QByteArray &block) const;
+  QByteArray encrypt_block(const QByteArray &block) const;
+  bool decrypt_block(const uint8_t *in, uint8_t *out) const;
   void key_expansion(void);
-  void mix_columns(void);
-  void shift_rows(void);
-  void sub_bytes(void);
 };
 
 #endif
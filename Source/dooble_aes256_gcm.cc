@@ -0,0 +1,544 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+** Implementation of https://doi.org/10.6028/NIST.SP.800-38D.
+** Only 96-bit nonces are supported.
+*/
+
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <iostream>
+#include <limits>
+
+#ifdef DOOBLE_MMAN_PRESENT
+extern "C"
+{
+#include <sys/mman.h>
+}
+#endif
+
+#include "dooble_aes256_gcm.h"
+#include "dooble_cryptography.h"
+#include "dooble_random.h"
+
+int dooble_aes256_gcm::s_nonce_length = 12;
+int dooble_aes256_gcm::s_parallel_minimum_length = 65536;
+int dooble_aes256_gcm::s_tag_length = 16;
+
+static uint64_t load_uint64(const uint8_t *bytes)
+{
+  uint64_t value = 0;
+
+  for(size_t i = 0; i < 8; i++)
+    value = (value << 8) | static_cast<uint64_t> (bytes[i]);
+
+  return value;
+}
+
+static void store_uint64(uint8_t *bytes, const uint64_t value)
+{
+  for(size_t i = 0; i < 8; i++)
+    bytes[i] = static_cast<uint8_t> (value >> (56 - 8 * i));
+}
+
+dooble_aes256_gcm::dooble_aes256_gcm(const QByteArray &key):
+  dooble_aes256(key)
+{
+#ifdef DOOBLE_MMAN_PRESENT
+  mlock(m_hh, sizeof(m_hh));
+  mlock(m_hl, sizeof(m_hl));
+#endif
+  prepare_table();
+}
+
+dooble_aes256_gcm::~dooble_aes256_gcm()
+{
+  dooble_cryptography::memzero(m_hh, sizeof(m_hh));
+  dooble_cryptography::memzero(m_hl, sizeof(m_hl));
+#ifdef DOOBLE_MMAN_PRESENT
+  munlock(m_hh, sizeof(m_hh));
+  munlock(m_hl, sizeof(m_hl));
+#endif
+}
+
+bool dooble_aes256_gcm::open_into(const char *nonce,
+				  const char *aad,
+				  const int aad_length,
+				  const char *ciphertext,
+				  const int length,
+				  const char *tag,
+				  char *plaintext) const
+{
+  /*
+  ** The tag is verified before the ciphertext is decrypted. The
+  ** plaintext container must provide length bytes.
+  */
+
+  if(Q_UNLIKELY(!nonce ||
+		!tag ||
+		(!aad && aad_length > 0) ||
+		(!ciphertext && length > 0) ||
+		(!plaintext && length > 0) ||
+		aad_length < 0 ||
+		length < 0))
+    return false;
+
+  uint8_t digest[16];
+  uint8_t j0[16];
+  uint8_t mask[16];
+
+  memcpy(j0, nonce, 12);
+  j0[12] = j0[13] = j0[14] = 0;
+  j0[15] = 1;
+  ghash(reinterpret_cast<const uint8_t *> (aad),
+	static_cast<size_t> (aad_length),
+	reinterpret_cast<const uint8_t *> (ciphertext),
+	static_cast<size_t> (length),
+	digest);
+  encrypt_block(j0, mask);
+
+  for(size_t i = 0; i < 16; i++)
+    digest[i] ^= mask[i];
+
+  auto ok = dooble_cryptography::memcmp
+    (reinterpret_cast<const char *> (digest), s_tag_length, tag, s_tag_length);
+
+  dooble_cryptography::memzero(digest, sizeof(digest));
+  dooble_cryptography::memzero(mask, sizeof(mask));
+
+  if(!ok)
+    return false;
+
+  ctr(j0,
+      reinterpret_cast<const uint8_t *> (ciphertext),
+      static_cast<size_t> (length),
+      reinterpret_cast<uint8_t *> (plaintext));
+  return true;
+}
+
+bool dooble_aes256_gcm::seal_into(const char *nonce,
+				  const char *aad,
+				  const int aad_length,
+				  const char *plaintext,
+				  const int length,
+				  char *ciphertext,
+				  char *tag) const
+{
+  /*
+  ** The ciphertext container must provide length bytes and the tag
+  ** container s_tag_length bytes. A nonce may never be reused with
+  ** the same key.
+  */
+
+  if(Q_UNLIKELY(!nonce ||
+		!tag ||
+		(!aad && aad_length > 0) ||
+		(!ciphertext && length > 0) ||
+		(!plaintext && length > 0) ||
+		aad_length < 0 ||
+		length < 0))
+    return false;
+
+  uint8_t j0[16];
+  uint8_t mask[16];
+  auto t = reinterpret_cast<uint8_t *> (tag);
+
+  memcpy(j0, nonce, 12);
+  j0[12] = j0[13] = j0[14] = 0;
+  j0[15] = 1;
+  ctr(j0,
+      reinterpret_cast<const uint8_t *> (plaintext),
+      static_cast<size_t> (length),
+      reinterpret_cast<uint8_t *> (ciphertext));
+  ghash(reinterpret_cast<const uint8_t *> (aad),
+	static_cast<size_t> (aad_length),
+	reinterpret_cast<const uint8_t *> (ciphertext),
+	static_cast<size_t> (length),
+	t);
+  encrypt_block(j0, mask);
+
+  for(size_t i = 0; i < 16; i++)
+    t[i] ^= mask[i];
+
+  dooble_cryptography::memzero(mask, sizeof(mask));
+  return true;
+}
+
+void dooble_aes256_gcm::ctr(const uint8_t *j0,
+			    const uint8_t *in,
+			    const size_t length,
+			    uint8_t *out) const
+{
+  /*
+  ** Every block's counter is known in advance. Large payloads are
+  ** divided into runs of whole blocks. The first run is processed by
+  ** the calling thread.
+  */
+
+  if(length < static_cast<size_t> (qMax(16, s_parallel_minimum_length)))
+    {
+      ctr_blocks(j0, 0, in, length, out);
+      return;
+    }
+
+  auto blocks = (length + 15) / 16;
+  auto threads = static_cast<size_t>
+    (qMax(1, QThreadPool::globalInstance()->maxThreadCount()));
+  auto chunk_blocks = qMax
+    (static_cast<size_t> (s_parallel_minimum_length) / 16,
+     (blocks + threads - 1) / threads);
+  auto chunk_length = 16 * chunk_blocks;
+  QList<QFuture<void> > futures;
+
+  for(size_t offset = chunk_length; offset < length; offset += chunk_length)
+    futures << QtConcurrent::run
+      ([this, chunk_length, in, j0, length, offset, out] (void)
+       {
+	 ctr_blocks(j0,
+		    static_cast<uint32_t> (offset / 16),
+		    in + offset,
+		    qMin(chunk_length, length - offset),
+		    out + offset);
+       });
+
+  ctr_blocks(j0, 0, in, qMin(chunk_length, length), out);
+
+  for(auto &future : futures)
+    future.waitForFinished();
+}
+
+void dooble_aes256_gcm::ctr_blocks(const uint8_t *j0,
+				   const uint32_t first,
+				   const uint8_t *in,
+				   const size_t length,
+				   uint8_t *out) const
+{
+  uint8_t counter[16];
+  uint8_t stream[16];
+  auto c = ((static_cast<uint32_t> (j0[12]) << 24) |
+	    (static_cast<uint32_t> (j0[13]) << 16) |
+	    (static_cast<uint32_t> (j0[14]) << 8) |
+	    static_cast<uint32_t> (j0[15])) + first;
+
+  memcpy(counter, j0, 12);
+
+  for(size_t offset = 0; offset < length; offset += 16)
+    {
+      c += 1;
+      counter[12] = static_cast<uint8_t> (c >> 24);
+      counter[13] = static_cast<uint8_t> (c >> 16);
+      counter[14] = static_cast<uint8_t> (c >> 8);
+      counter[15] = static_cast<uint8_t> (c);
+      encrypt_block(counter, stream);
+
+      auto n = qMin(static_cast<size_t> (16), length - offset);
+
+      for(size_t i = 0; i < n; i++)
+	out[offset + i] = in[offset + i] ^ stream[i];
+    }
+
+  dooble_cryptography::memzero(stream, sizeof(stream));
+}
+
+void dooble_aes256_gcm::ghash(const uint8_t *aad,
+			      const size_t aad_length,
+			      const uint8_t *ciphertext,
+			      const size_t length,
+			      uint8_t *digest) const
+{
+  memset(digest, 0, 16);
+
+  for(size_t offset = 0; offset < aad_length; offset += 16)
+    {
+      auto n = qMin(static_cast<size_t> (16), aad_length - offset);
+
+      for(size_t i = 0; i < n; i++)
+	digest[i] ^= aad[offset + i];
+
+      ghash_multiply(digest);
+    }
+
+  for(size_t offset = 0; offset < length; offset += 16)
+    {
+      auto n = qMin(static_cast<size_t> (16), length - offset);
+
+      for(size_t i = 0; i < n; i++)
+	digest[i] ^= ciphertext[offset + i];
+
+      ghash_multiply(digest);
+    }
+
+  uint8_t lengths[16];
+
+  store_uint64(lengths, 8 * static_cast<uint64_t> (aad_length));
+  store_uint64(lengths + 8, 8 * static_cast<uint64_t> (length));
+
+  for(size_t i = 0; i < 16; i++)
+    digest[i] ^= lengths[i];
+
+  ghash_multiply(digest);
+}
+
+void dooble_aes256_gcm::ghash_multiply(uint8_t *x) const
+{
+  /*
+  ** x = x * H in GF(2^128), four bits at a time.
+  */
+
+  static const uint64_t last4[16] =
+    {
+     0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+     0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+    };
+  auto lo = static_cast<size_t> (x[15] & 0xf);
+  auto zh = m_hh[lo];
+  auto zl = m_hl[lo];
+
+  for(int i = 15; i >= 0; i--)
+    {
+      auto hi = static_cast<size_t> ((x[i] >> 4) & 0xf);
+      size_t remainder = 0;
+
+      lo = static_cast<size_t> (x[i] & 0xf);
+
+      if(i != 15)
+	{
+	  remainder = static_cast<size_t> (zl & 0xf);
+	  zl = (zh << 60) | (zl >> 4);
+	  zh = (zh >> 4) ^ (last4[remainder] << 48);
+	  zh ^= m_hh[lo];
+	  zl ^= m_hl[lo];
+	}
+
+      remainder = static_cast<size_t> (zl & 0xf);
+      zl = (zh << 60) | (zl >> 4);
+      zh = (zh >> 4) ^ (last4[remainder] << 48);
+      zh ^= m_hh[hi];
+      zl ^= m_hl[hi];
+    }
+
+  store_uint64(x, zh);
+  store_uint64(x + 8, zl);
+}
+
+void dooble_aes256_gcm::prepare_table(void)
+{
+  /*
+  ** Multiples of H = E(K, 0^128) by every four-bit value.
+  */
+
+  uint8_t h[16] = {};
+
+  encrypt_block(h, h);
+
+  auto vh = load_uint64(h);
+  auto vl = load_uint64(h + 8);
+
+  m_hh[0] = m_hl[0] = 0;
+  m_hh[8] = vh;
+  m_hl[8] = vl;
+
+  for(size_t i = 4; i > 0; i >>= 1)
+    {
+      auto t = (vl & 1) * 0xe100000000000000ULL;
+
+      vl = (vh << 63) | (vl >> 1);
+      vh = (vh >> 1) ^ t;
+      m_hh[i] = vh;
+      m_hl[i] = vl;
+    }
+
+  for(size_t i = 2; i <= 8; i *= 2)
+    for(size_t j = 1; j < i; j++)
+      {
+	m_hh[i + j] = m_hh[i] ^ m_hh[j];
+	m_hl[i + j] = m_hl[i] ^ m_hl[j];
+      }
+
+  dooble_cryptography::memzero(h, sizeof(h));
+}
+
+void dooble_aes256_gcm::set_key(const QByteArray &key)
+{
+  dooble_aes256::set_key(key);
+  prepare_table();
+}
+
+void dooble_aes256_gcm::test1(void)
+{
+  /*
+  ** Test Cases 13 through 16 of the GCM specification.
+  */
+
+  const char *p = "d9313225f88406e5a55909c5aff5269a"
+		  "86a7a9531534f7da2e4c303d8a318a72"
+		  "1c3c0c95956809532fcf0e2449a6b525"
+		  "b16aedf5aa0de657ba637b391aafd255";
+  const char *c = "522dc1f099567d07f47f37a32a84427d"
+		  "643a8cdcbfe5c0c97598a2bd2555d1aa"
+		  "8cb08e48590dbb3da7b08b1056828838"
+		  "c5f61e6393ba7a0abcc9f662898015ad";
+  const char *k = "feffe9928665731c6d6a8f9467308308"
+		  "feffe9928665731c6d6a8f9467308308";
+  const struct
+  {
+    QByteArray key;
+    QByteArray nonce;
+    QByteArray aad;
+    QByteArray plaintext;
+    QByteArray ciphertext;
+    QByteArray tag;
+  } vectors[] =
+      {
+       {QByteArray(32, 0),
+	QByteArray(12, 0),
+	QByteArray(),
+	QByteArray(),
+	QByteArray(),
+	QByteArray::fromHex("530f8afbc74536b9a963b4f1c4cb738b")},
+       {QByteArray(32, 0),
+	QByteArray(12, 0),
+	QByteArray(),
+	QByteArray(16, 0),
+	QByteArray::fromHex("cea7403d4d606b6e074ec5d3baf39d18"),
+	QByteArray::fromHex("d0d1c8a799996bf0265b98b5d48ab919")},
+       {QByteArray::fromHex(k),
+	QByteArray::fromHex("cafebabefacedbaddecaf888"),
+	QByteArray(),
+	QByteArray::fromHex(p),
+	QByteArray::fromHex(c),
+	QByteArray::fromHex("b094dac5d93471bdec1a502270e3cc6c")},
+       {QByteArray::fromHex(k),
+	QByteArray::fromHex("cafebabefacedbaddecaf888"),
+	QByteArray::fromHex("feedfacedeadbeeffeedfacedeadbeefabaddad2"),
+	QByteArray::fromHex(p).mid(0, 60),
+	QByteArray::fromHex(c).mid(0, 60),
+	QByteArray::fromHex("76fc6ece0f4e1768cddf8853bb2d551b")}
+      };
+
+  foreach(const auto engine, supported_engines())
+    {
+      auto passed = true;
+
+      for(const auto &vector : vectors)
+	{
+	  QByteArray ciphertext(vector.plaintext.length(), 0);
+	  QByteArray plaintext(vector.plaintext.length(), 0);
+	  QByteArray tag(s_tag_length, 0);
+	  dooble_aes256_gcm gcm(vector.key);
+
+	  gcm.set_engine(engine);
+	  passed &= gcm.seal_into(vector.nonce.constData(),
+				  vector.aad.constData(),
+				  vector.aad.length(),
+				  vector.plaintext.constData(),
+				  vector.plaintext.length(),
+				  ciphertext.data(),
+				  tag.data());
+	  passed &= ciphertext == vector.ciphertext && tag == vector.tag;
+	  passed &= gcm.open_into(vector.nonce.constData(),
+				  vector.aad.constData(),
+				  vector.aad.length(),
+				  ciphertext.constData(),
+				  ciphertext.length(),
+				  tag.constData(),
+				  plaintext.data());
+	  passed &= plaintext == vector.plaintext;
+	  tag[0] = static_cast<char> (tag.at(0) ^ 1);
+	  passed &= !gcm.open_into(vector.nonce.constData(),
+				   vector.aad.constData(),
+				   vector.aad.length(),
+				   ciphertext.constData(),
+				   ciphertext.length(),
+				   tag.constData(),
+				   plaintext.data());
+	}
+
+      std::cout << "dooble_aes256_gcm::test1() ("
+		<< engine_name(engine).toStdString()
+		<< (passed ? ") passed!" : ") failed!")
+		<< std::endl;
+    }
+}
+
+void dooble_aes256_gcm::test2(void)
+{
+  /*
+  ** Payloads which are divided amongst threads must agree with
+  ** payloads which are not.
+  */
+
+  auto key(dooble_random::random_bytes(32));
+  auto nonce(dooble_random::random_bytes(s_nonce_length));
+  auto passed = true;
+  auto s = s_parallel_minimum_length;
+  dooble_aes256_gcm gcm(key);
+
+  foreach(auto size, QList<int> () << 65535 << 65536 << 1048573)
+    {
+      QByteArray c1(size, 0);
+      QByteArray c2(size, 0);
+      QByteArray p(size, 0);
+      QByteArray t1(s_tag_length, 0);
+      QByteArray t2(s_tag_length, 0);
+      auto data(dooble_random::random_bytes(size));
+
+      s_parallel_minimum_length = s;
+      passed &= gcm.seal_into(nonce.constData(),
+			      nullptr,
+			      0,
+			      data.constData(),
+			      size,
+			      c1.data(),
+			      t1.data());
+      s_parallel_minimum_length = std::numeric_limits<int>::max();
+      passed &= gcm.seal_into(nonce.constData(),
+			      nullptr,
+			      0,
+			      data.constData(),
+			      size,
+			      c2.data(),
+			      t2.data());
+      passed &= c1 == c2 && t1 == t2;
+      s_parallel_minimum_length = s;
+      passed &= gcm.open_into(nonce.constData(),
+			      nullptr,
+			      0,
+			      c1.constData(),
+			      size,
+			      t1.constData(),
+			      p.data());
+      passed &= p == data;
+    }
+
+  s_parallel_minimum_length = s;
+  std::cout << "dooble_aes256_gcm::test2() "
+	    << (passed ? "passed!" : "failed!")
+	    << std::endl;
+}
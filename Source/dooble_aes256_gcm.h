@@ -0,0 +1,80 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef dooble_aes256_gcm_h
+#define dooble_aes256_gcm_h
+
+#include "dooble_aes256.h"
+
+class dooble_aes256_gcm: public dooble_aes256
+{
+ public:
+  static int s_nonce_length;
+  static int s_parallel_minimum_length;
+  static int s_tag_length;
+  dooble_aes256_gcm(const QByteArray &key);
+  ~dooble_aes256_gcm();
+  bool open_into(const char *nonce,
+		 const char *aad,
+		 const int aad_length,
+		 const char *ciphertext,
+		 const int length,
+		 const char *tag,
+		 char *plaintext) const;
+  bool seal_into(const char *nonce,
+		 const char *aad,
+		 const int aad_length,
+		 const char *plaintext,
+		 const int length,
+		 char *ciphertext,
+		 char *tag) const;
+  static void test1(void);
+  static void test2(void);
+  void set_key(const QByteArray &key);
+
+ private:
+  uint64_t m_hh[16];
+  uint64_t m_hl[16];
+  void ctr(const uint8_t *j0,
+	   const uint8_t *in,
+	   const size_t length,
+	   uint8_t *out) const;
+  void ctr_blocks(const uint8_t *j0,
+		  const uint32_t first,
+		  const uint8_t *in,
+		  const size_t length,
+		  uint8_t *out) const;
+  void ghash(const uint8_t *aad,
+	     const size_t aad_length,
+	     const uint8_t *ciphertext,
+	     const size_t length,
+	     uint8_t *digest) const;
+  void ghash_multiply(uint8_t *x) const;
+  void prepare_table(void);
+};
+
+#endif
@@ -28,17 +28,30 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QTranslator>
+#include <QtConcurrent>
 
 #include "dooble.h"
 #include "dooble_application.h"
+#include "dooble_cryptography.h"
+#include "dooble_database_rekey.h"
+#include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 
 QHash<QString, QColor> dooble_application::s_theme_colors;
+int dooble_application::s_migration_rows = 256;
+int dooble_application::s_rekey_rows = 4096;
+int dooble_application::s_vacuum_pages = 256;
 
 dooble_application::dooble_application(int &argc, char **argv):
   QApplication(argc, argv)
 {
   m_application_locked = false;
+  m_checkpoint_timer.start(30000);
+  m_migration_interrupt = 0;
+  m_rekey_interrupt = 0;
   m_translator = nullptr;
+  m_vacuum_interrupt = 0;
+  m_vacuum_timer.start(60000);
 
   auto font(this->font());
 
@@ -49,6 +62,23 @@ dooble_application::dooble_application(int &argc, char **argv):
   setAttribute(Qt::AA_DontUseNativeMenuBar);
   setFont(font);
   setWindowIcon(QIcon(":/Logo/dooble.png"));
+  connect(&m_checkpoint_timer,
+	  SIGNAL(timeout(void)),
+	  this,
+	  SLOT(slot_checkpoint_databases(void)));
+  connect(&m_vacuum_timer,
+	  SIGNAL(timeout(void)),
+	  this,
+	  SLOT(slot_vacuum_databases_when_idle(void)));
+  connect(this,
+	  SIGNAL(database_rekeyed(const QString &, int, int)),
+	  this,
+	  SLOT(slot_database_rekeyed(const QString &, int, int)));
+  connect(this,
+	  SIGNAL(databases_rekeyed(bool)),
+	  this,
+	  SLOT(slot_databases_rekeyed(bool)));
+  QTimer::singleShot(15000, this, SLOT(slot_migrate_databases(void)));
 }
 
 QString dooble_application::style_name(void) const
@@ -131,6 +161,232 @@ void dooble_application::install_translator(void)
     }
 }
 
+void dooble_application::interrupt_database_rekey(void)
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_rekey_interrupt.store(1);
+#else
+  m_rekey_interrupt.storeRelaxed(1);
+#endif
+}
+
+void dooble_application::interrupt_database_vacuum(void)
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_vacuum_interrupt.store(1);
+#else
+  m_vacuum_interrupt.storeRelaxed(1);
+#endif
+}
+
+void dooble_application::migrate_databases_task(const QString &home_path)
+{
+  /*
+  ** Values which are stored as base64 text are converted to binary
+  ** values in small transactions while Dooble is in use.
+  */
+
+  foreach(const auto &i, dooble_database_utilities::file_names())
+    while(!m_migration_interrupt.loadAcquire())
+      if(dooble_database_utilities::
+	 migrate_blobs(home_path + QDir::separator() + i, s_migration_rows))
+	break;
+}
+
+void dooble_application::rekey_databases
+(const QSharedPointer<dooble_cryptography> &previous)
+{
+  /*
+  ** The keys of dooble::s_cryptography were replaced. The previous
+  ** keys are recorded, protected by the current keys, so that an
+  ** interrupted pass is resumed after the next authentication.
+  */
+
+  if(!dooble::s_cryptography || !previous)
+    return;
+
+  QByteArray bytes;
+
+  if(previous->as_plaintext())
+    bytes = "plaintext";
+  else
+    {
+      auto keys(previous->keys());
+
+      bytes = keys.first + keys.second;
+      dooble_cryptography::memzero(keys.first);
+      dooble_cryptography::memzero(keys.second);
+    }
+
+  auto data(dooble::s_cryptography->encrypt_then_mac(bytes));
+
+  dooble_cryptography::memzero(bytes);
+
+  if(data.isEmpty())
+    return;
+
+  interrupt_database_rekey();
+  m_rekey_future.waitForFinished();
+
+  /*
+  ** Values which an interrupted pass did not visit remain readable
+  ** during this session.
+  */
+
+  if(m_rekey_previous)
+    previous->set_previous(m_rekey_previous);
+
+  dooble_settings::set_setting
+    ("credentials_rekey_block_cipher_type", previous->block_cipher_type());
+  dooble_settings::set_setting
+    ("credentials_rekey_hash_type", previous->hash_type());
+  dooble_settings::set_setting("credentials_rekey_keys", data.toHex());
+  dooble_settings::remove_setting("credentials_rekey_tables");
+  dooble_settings::flush();
+  dooble::s_cryptography->set_previous(previous);
+  m_rekey_previous = previous;
+  rekey_databases(dooble_database_rekey::tables());
+}
+
+void dooble_application::rekey_databases(const QStringList &tables)
+{
+  auto home_path(dooble_settings::setting("home_path").toString());
+
+  if(home_path.isEmpty() || !dooble::s_cryptography || !m_rekey_previous)
+    return;
+
+  /*
+  ** The migration would replace re-encrypted values with values
+  ** which it read before. It is resumed afterwards.
+  */
+
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_migration_interrupt.store(1);
+#else
+  m_migration_interrupt.storeRelaxed(1);
+#endif
+  m_migration_future.waitForFinished();
+
+  auto keys(dooble::s_cryptography->keys());
+
+  m_rekey_current = QSharedPointer<dooble_cryptography>
+    (new dooble_cryptography(keys.first,
+			     keys.second,
+			     dooble::s_cryptography->block_cipher_type(),
+			     dooble::s_cryptography->hash_type()));
+  dooble_cryptography::memzero(keys.first);
+  dooble_cryptography::memzero(keys.second);
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_rekey_interrupt.store(0);
+#else
+  m_rekey_interrupt.storeRelaxed(0);
+#endif
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+  m_rekey_future = QtConcurrent::run
+    (this,
+     &dooble_application::rekey_databases_task,
+     home_path,
+     m_rekey_previous,
+     m_rekey_current,
+     tables);
+#else
+  m_rekey_future = QtConcurrent::run
+    (&dooble_application::rekey_databases_task,
+     this,
+     home_path,
+     m_rekey_previous,
+     m_rekey_current,
+     tables);
+#endif
+}
+
+void dooble_application::rekey_databases_task
+(const QString &home_path,
+ const QSharedPointer<dooble_cryptography> &previous,
+ const QSharedPointer<dooble_cryptography> &current,
+ const QStringList &tables)
+{
+  /*
+  ** Each table is re-encrypted in its own transaction and reported
+  ** once it is committed.
+  */
+
+  auto state = true;
+
+  for(int i = 0; i < tables.size(); i++)
+    {
+      if(m_rekey_interrupt.loadAcquire())
+	return;
+
+      if(dooble_database_rekey::rekey(home_path,
+				      tables.at(i),
+				      *previous,
+				      *current,
+				      m_rekey_interrupt,
+				      s_rekey_rows))
+	emit database_rekeyed(tables.at(i), i + 1, tables.size());
+      else if(m_rekey_interrupt.loadAcquire())
+	return;
+      else
+	state = false;
+    }
+
+  emit databases_rekeyed(state);
+}
+
+void dooble_application::resume_database_rekey(void)
+{
+  /*
+  ** Resumes a pass which was interrupted. Tables which were
+  ** committed are not visited again.
+  */
+
+  if(!dooble::s_cryptography || !m_rekey_future.isFinished())
+    return;
+
+  auto bytes
+    (QByteArray::fromHex(dooble_settings::setting("credentials_rekey_keys").
+			 toByteArray()));
+
+  if(bytes.isEmpty())
+    return;
+
+  auto ok = false;
+
+  bytes = dooble::s_cryptography->mac_then_decrypt(bytes, &ok);
+
+  if(bytes.isEmpty() || !ok)
+    return;
+
+  if(bytes == "plaintext")
+    m_rekey_previous = QSharedPointer<dooble_cryptography>
+      (new dooble_cryptography(QByteArray(),
+			       QByteArray(),
+			       "AES-256",
+			       "SHA3-512"));
+  else
+    m_rekey_previous = QSharedPointer<dooble_cryptography>
+      (new dooble_cryptography
+       (bytes.mid(0, dooble_cryptography::s_authentication_key_length),
+	bytes.mid(dooble_cryptography::s_authentication_key_length,
+		  dooble_cryptography::s_encryption_key_length),
+	dooble_settings::setting("credentials_rekey_block_cipher_type").
+	toString(),
+	dooble_settings::setting("credentials_rekey_hash_type").toString()));
+
+  dooble_cryptography::memzero(bytes);
+  dooble::s_cryptography->set_previous(m_rekey_previous);
+
+  auto tables(dooble_database_rekey::tables());
+
+  foreach(const auto &i,
+	  dooble_settings::setting("credentials_rekey_tables").toString().
+	  split(';'))
+    tables.removeAll(i);
+
+  rekey_databases(tables);
+}
+
 void dooble_application::prepare_theme_colors(void)
 {
   if(!s_theme_colors.isEmpty())
@@ -176,3 +432,208 @@ void dooble_application::slot_application_locked(bool state, dooble *d)
   m_application_locked = true;
   emit application_locked(state, d);
 }
+
+void dooble_application::slot_checkpoint_databases(void)
+{
+  /*
+  ** The write-ahead logs are copied into their databases by a
+  ** separate thread so that the GUI thread does not wait.
+  */
+
+  if(!m_checkpoint_future.isFinished())
+    return;
+
+  auto home_path(dooble_settings::setting("home_path").toString());
+
+  if(home_path.isEmpty())
+    return;
+
+  m_checkpoint_future = QtConcurrent::run
+    (dooble_database_utilities::checkpoint, home_path);
+}
+
+void dooble_application::slot_database_rekeyed(const QString &table,
+						int completed,
+						int total)
+{
+  Q_UNUSED(completed);
+  Q_UNUSED(total);
+
+  auto tables
+    (dooble_settings::setting("credentials_rekey_tables").toString().
+     split(';'));
+
+  tables.removeAll("");
+  tables << table;
+  dooble_settings::set_setting("credentials_rekey_tables", tables.join(';'));
+}
+
+void dooble_application::slot_databases_rekeyed(bool state)
+{
+  /*
+  ** The previous keys are discarded once every table was
+  ** re-encrypted. Otherwise, the remaining tables are visited after
+  ** the next authentication.
+  */
+
+  if(state)
+    {
+      dooble_settings::remove_setting("credentials_rekey_block_cipher_type");
+      dooble_settings::remove_setting("credentials_rekey_hash_type");
+      dooble_settings::remove_setting("credentials_rekey_keys");
+      dooble_settings::remove_setting("credentials_rekey_tables");
+
+      if(dooble::s_cryptography)
+	dooble::s_cryptography->set_previous
+	  (QSharedPointer<dooble_cryptography> ());
+    }
+
+  m_rekey_current.clear();
+  m_rekey_previous.clear();
+  slot_migrate_databases();
+}
+
+void dooble_application::slot_migrate_databases(void)
+{
+  auto home_path(dooble_settings::setting("home_path").toString());
+
+  if(home_path.isEmpty())
+    return;
+  else if(!m_migration_future.isFinished() || !m_rekey_future.isFinished())
+    return;
+
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_migration_interrupt.store(0);
+#else
+  m_migration_interrupt.storeRelaxed(0);
+#endif
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+  m_migration_future = QtConcurrent::run
+    (this, &dooble_application::migrate_databases_task, home_path);
+#else
+  m_migration_future = QtConcurrent::run
+    (&dooble_application::migrate_databases_task, this, home_path);
+#endif
+}
+
+void dooble_application::slot_vacuum_databases_when_idle(void)
+{
+  /*
+  ** While Dooble is not the active application, a few free pages
+  ** of each database are returned to the file system.
+  */
+
+  if(applicationState() == Qt::ApplicationActive)
+    return;
+  else if(!m_vacuum_future.isFinished())
+    return;
+
+  auto home_path(dooble_settings::setting("home_path").toString());
+
+  if(home_path.isEmpty())
+    return;
+
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_vacuum_interrupt.store(0);
+#else
+  m_vacuum_interrupt.storeRelaxed(0);
+#endif
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+  m_vacuum_future = QtConcurrent::run
+    (this, &dooble_application::vacuum_databases_task, home_path, 1);
+#else
+  m_vacuum_future = QtConcurrent::run
+    (&dooble_application::vacuum_databases_task, this, home_path, 1);
+#endif
+}
+
+void dooble_application::stop_database_maintenance(void)
+{
+  m_checkpoint_timer.stop();
+  m_vacuum_timer.stop();
+  interrupt_database_rekey();
+  interrupt_database_vacuum();
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_migration_interrupt.store(1);
+#else
+  m_migration_interrupt.storeRelaxed(1);
+#endif
+  m_checkpoint_future.waitForFinished();
+  m_migration_future.waitForFinished();
+  m_rekey_future.waitForFinished();
+  m_vacuum_future.waitForFinished();
+}
+
+void dooble_application::vacuum_databases(void)
+{
+  /*
+  ** Vacuums every database completely. A pass which is in progress
+  ** is interrupted first. Older databases which do not support
+  ** the incremental vacuum are converted.
+  */
+
+  auto home_path(dooble_settings::setting("home_path").toString());
+
+  if(home_path.isEmpty())
+    return;
+
+  interrupt_database_vacuum();
+  m_vacuum_future.waitForFinished();
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  m_vacuum_interrupt.store(0);
+#else
+  m_vacuum_interrupt.storeRelaxed(0);
+#endif
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+  m_vacuum_future = QtConcurrent::run
+    (this, &dooble_application::vacuum_databases_task, home_path, -1);
+#else
+  m_vacuum_future = QtConcurrent::run
+    (&dooble_application::vacuum_databases_task, this, home_path, -1);
+#endif
+}
+
+void dooble_application::vacuum_databases_task
+(const QString &home_path, int steps)
+{
+  /*
+  ** Each step returns at most s_vacuum_pages pages of a database
+  ** to the file system. A negative number of steps vacuums each
+  ** database completely. The reclaimed bytes are reported per
+  ** database.
+  */
+
+  foreach(const auto &i, dooble_database_utilities::file_names())
+    {
+      auto file_name(home_path + QDir::separator() + i);
+      qint64 bytes = 0;
+
+      if(steps < 0 &&
+	 !dooble_database_utilities::incremental_auto_vacuum(file_name))
+	{
+	  if(m_vacuum_interrupt.loadAcquire())
+	    return;
+
+	  if(dooble::s_database_writer)
+	    dooble::s_database_writer->close(file_name);
+
+	  bytes = dooble_database_utilities::vacuum(file_name);
+	}
+      else
+	for(int j = 0; j < steps || steps < 0; j++)
+	  {
+	    if(m_vacuum_interrupt.loadAcquire())
+	      return;
+
+	    auto reclaimed = dooble_database_utilities::incremental_vacuum
+	      (file_name, s_vacuum_pages);
+
+	    if(reclaimed <= 0)
+	      break;
+
+	    bytes += reclaimed;
+	  }
+
+      emit database_vacuumed(i, bytes);
+    }
+}
@@ -29,9 +29,14 @@
 #define dooble_application_h
 
 #include <QApplication>
+#include <QAtomicInteger>
+#include <QFuture>
+#include <QSharedPointer>
+#include <QTimer>
 
 class QTranslator;
 class dooble;
+class dooble_cryptography;
 
 class dooble_application: public QApplication
 {
@@ -43,20 +48,56 @@ class dooble_application: public QApplication
   QString style_name(void) const;
   bool application_locked(void) const;
   void install_translator(void);
+  void interrupt_database_vacuum(void);
+  void rekey_databases(const QSharedPointer<dooble_cryptography> &previous);
+  void resume_database_rekey(void);
   void set_application_locked(bool state);
+  void stop_database_maintenance(void);
+  void vacuum_databases(void);
   static void prepare_theme_colors(void);
 
  private:
+  QAtomicInteger<short> m_migration_interrupt;
+  QAtomicInteger<short> m_rekey_interrupt;
+  QAtomicInteger<short> m_vacuum_interrupt;
+  QFuture<void> m_checkpoint_future;
+  QFuture<void> m_migration_future;
+  QFuture<void> m_rekey_future;
+  QFuture<void> m_vacuum_future;
+  QSharedPointer<dooble_cryptography> m_rekey_current;
+  QSharedPointer<dooble_cryptography> m_rekey_previous;
+  QTimer m_checkpoint_timer;
+  QTimer m_vacuum_timer;
   QTranslator *m_translator;
   bool m_application_locked;
+  static int s_migration_rows;
+  static int s_rekey_rows;
+  static int s_vacuum_pages;
+  void interrupt_database_rekey(void);
+  void migrate_databases_task(const QString &home_path);
+  void rekey_databases(const QStringList &tables);
+  void rekey_databases_task
+    (const QString &home_path,
+     const QSharedPointer<dooble_cryptography> &previous,
+     const QSharedPointer<dooble_cryptography> &current,
+     const QStringList &tables);
+  void vacuum_databases_task(const QString &home_path, int steps);
 
  private slots:
   void slot_application_locked(bool state, dooble *d);
+  void slot_checkpoint_databases(void);
+  void slot_database_rekeyed(const QString &table, int completed, int total);
+  void slot_databases_rekeyed(bool state);
+  void slot_migrate_databases(void);
+  void slot_vacuum_databases_when_idle(void);
 
  signals:
   void address_widget_populated(void);
   void application_locked(bool state, dooble *d);
   void cookies_cleared(void);
+  void database_rekeyed(const QString &table, int completed, int total);
+  void database_vacuumed(const QString &file_name, qint64 bytes);
+  void databases_rekeyed(bool state);
   void dooble_credentials_authenticated(bool state);
   void favorites_cleared(void);
   void favorites_sorted(void);
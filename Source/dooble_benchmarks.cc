@@ -0,0 +1,524 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSysInfo>
+#include <QThread>
+
+#include "dooble_aes256.h"
+#include "dooble_cryptography.h"
+#include "dooble_database_utilities.h"
+#include "dooble_hmac.h"
+#include "dooble_pbkdf2.h"
+#include "dooble_random.h"
+#include "dooble_threefish256.h"
+#include "dooble_version.h"
+
+#include <iostream>
+
+/*
+** A standalone harness. Every measurement repeats its operation until
+** the duration (milliseconds) has elapsed. The results are written as
+** a single JSON document so that builds may be compared mechanically.
+*/
+
+static qint64 s_duration = 250;
+
+static QJsonObject result(const QString &name,
+			  const QString &unit,
+			  const double value,
+			  const QJsonObject &parameters)
+{
+  QJsonObject object;
+
+  object["name"] = name;
+  object["parameters"] = parameters;
+  object["unit"] = unit;
+  object["value"] = value;
+  return object;
+}
+
+template<typename Function>
+static double operations_per_second(Function function)
+{
+  QElapsedTimer timer;
+  qint64 count = 0;
+
+  timer.start();
+
+  do
+    {
+      function();
+      count += 1;
+    }
+  while(timer.elapsed() < s_duration);
+
+  return 1.0e9 * static_cast<double> (count) /
+    static_cast<double> (qMax(static_cast<qint64> (1), timer.nsecsElapsed()));
+}
+
+static QList<int> payload_sizes(void)
+{
+  return QList<int> () << 16 << 256 << 4096 << 65536 << 1048576;
+}
+
+static void benchmark_block_cipher(QJsonArray &results,
+				   dooble_block_cipher &block_cipher,
+				   const QString &name,
+				   const QString &engine)
+{
+  foreach(auto size, payload_sizes())
+    {
+      QByteArray ciphertext
+	(block_cipher.ciphertext_length(size), Qt::Uninitialized);
+      QByteArray plaintext(size, Qt::Uninitialized);
+      QJsonObject parameters;
+      auto data(dooble_random::random_bytes(size));
+      auto plaintext_length = 0;
+
+      parameters["block_cipher"] = name;
+      parameters["engine"] = engine;
+      parameters["payload_bytes"] = size;
+
+      auto encryptions = operations_per_second
+	([&](void)
+	 {
+	   block_cipher.encrypt_into
+	     (data.constData(), data.length(), ciphertext.data());
+	 });
+      auto decryptions = operations_per_second
+	([&](void)
+	 {
+	   block_cipher.decrypt_into(ciphertext.constData(),
+				     ciphertext.length(),
+				     plaintext.data(),
+				     &plaintext_length);
+	 });
+
+      results << result("block_cipher_encrypt",
+			"MiB/s",
+			encryptions * size / 1048576.0,
+			parameters);
+      results << result("block_cipher_decrypt",
+			"MiB/s",
+			decryptions * size / 1048576.0,
+			parameters);
+    }
+}
+
+static void benchmark_block_ciphers(QJsonArray &results)
+{
+  dooble_aes256 aes256(dooble_random::random_bytes(32));
+
+  foreach(auto engine, dooble_aes256::supported_engines())
+    {
+      aes256.set_engine(engine);
+      benchmark_block_cipher
+	(results, aes256, "AES-256", dooble_aes256::engine_name(engine));
+    }
+
+  dooble_threefish256 threefish256(dooble_random::random_bytes(32));
+
+  threefish256.set_tweak("76543210fedcba98", nullptr);
+  benchmark_block_cipher(results, threefish256, "Threefish-256", "");
+}
+
+static void benchmark_hmacs(QJsonArray &results)
+{
+  QList<QPair<dooble_hmac::Algorithms, QString> > algorithms;
+  auto key(dooble_random::random_bytes(64));
+
+  algorithms << QPair<dooble_hmac::Algorithms, QString>
+    (dooble_hmac::Algorithms::KECCAK_512, "Keccak-512")
+	     << QPair<dooble_hmac::Algorithms, QString>
+    (dooble_hmac::Algorithms::SHA2_512, "SHA2-512")
+	     << QPair<dooble_hmac::Algorithms, QString>
+    (dooble_hmac::Algorithms::SHA3_512, "SHA3-512");
+
+  foreach(const auto &algorithm, algorithms)
+    foreach(auto size, QList<int> () << 64 << 1024 << 65536)
+      {
+	QJsonObject parameters;
+	auto message(dooble_random::random_bytes(size));
+	dooble_hmac hmac(key, algorithm.first);
+
+	parameters["algorithm"] = algorithm.second;
+	parameters["message_bytes"] = size;
+	results << result("hmac",
+			  "operations/s",
+			  operations_per_second([&](void)
+						{
+						  hmac.hmac(message);
+						}),
+			  parameters);
+      }
+}
+
+static void benchmark_memcmp(QJsonArray &results)
+{
+  foreach(auto size, QList<int> () << 64 << 1048576)
+    {
+      QJsonObject parameters;
+      auto a(dooble_random::random_bytes(size));
+      auto b(a);
+
+      b.detach();
+      parameters["bytes"] = size;
+      results << result("memcmp",
+			"operations/s",
+			operations_per_second([&](void)
+					      {
+						dooble_cryptography::memcmp
+						  (a.constData(),
+						   a.length(),
+						   b.constData(),
+						   b.length());
+					      }),
+			parameters);
+      results << result("memzero",
+			"operations/s",
+			operations_per_second([&](void)
+					      {
+						dooble_cryptography::memzero
+						  (b.data(),
+						   static_cast<size_t> (size));
+					      }),
+			parameters);
+    }
+}
+
+static void benchmark_pbkdf2(QJsonArray &results)
+{
+  QList<QPair<QByteArray (*) (const QByteArray &, const QByteArray &),
+	      QString> > functions;
+
+  functions << QPair<QByteArray (*) (const QByteArray &, const QByteArray &),
+		     QString> (&dooble_hmac::keccak_512_hmac, "Keccak-512")
+	    << QPair<QByteArray (*) (const QByteArray &, const QByteArray &),
+		     QString> (&dooble_hmac::sha3_512_hmac, "SHA3-512");
+
+  foreach(const auto &function, functions)
+    {
+      QElapsedTimer timer;
+      QJsonObject parameters;
+      const int iterations = 25000;
+      dooble_pbkdf2 pbkdf2(dooble_random::random_bytes(16),
+			   dooble_random::random_bytes(64),
+			   0,
+			   0,
+			   iterations,
+			   1024);
+
+      timer.start();
+      pbkdf2.pbkdf2(function.first);
+      parameters["hash"] = function.second;
+      parameters["iterations"] = iterations;
+      parameters["output_bits"] = 1024;
+      results << result
+	("pbkdf2",
+	 "iterations/s",
+	 1.0e9 * iterations /
+	 static_cast<double> (qMax(static_cast<qint64> (1),
+				   timer.nsecsElapsed())),
+	 parameters);
+    }
+}
+
+static void benchmark_round_trips(QJsonArray &results)
+{
+  foreach(const auto &block_cipher_type,
+	  QStringList() << "AES-256" << "AES-256-GCM" << "Threefish-256")
+    {
+      dooble_cryptography cryptography
+	(dooble_random::random_bytes(64),
+	 dooble_random::random_bytes(32),
+	 block_cipher_type,
+	 "SHA3-512");
+
+      foreach(auto size, QList<int> () << 64 << 1024 << 65536)
+	{
+	  QJsonObject parameters;
+	  auto data(dooble_random::random_bytes(size));
+
+	  parameters["block_cipher"] = block_cipher_type;
+	  parameters["payload_bytes"] = size;
+	  results << result
+	    ("encrypt_then_mac_then_decrypt",
+	     "operations/s",
+	     operations_per_second
+	     ([&](void)
+	      {
+		cryptography.mac_then_decrypt
+		  (cryptography.encrypt_then_mac(data));
+	      }),
+	     parameters);
+	}
+
+      QJsonObject parameters;
+      QVector<QByteArray> vector;
+
+      for(int i = 0; i < 4096; i++)
+	vector << dooble_random::random_bytes(128);
+
+      parameters["block_cipher"] = block_cipher_type;
+      parameters["items"] = vector.size();
+      parameters["payload_bytes"] = 128;
+      parameters["threads"] = QThread::idealThreadCount();
+      results << result
+	("batch_encrypt_then_mac_then_decrypt",
+	 "items/s",
+	 vector.size() * operations_per_second
+	 ([&](void)
+	  {
+	    cryptography.mac_then_decrypt_batch
+	      (cryptography.encrypt_then_mac_batch(vector));
+	  }),
+	 parameters);
+    }
+}
+
+static void benchmark_sqlite(QJsonArray &results)
+{
+  QString database_name("dooble_benchmarks");
+  const int rows = 2000;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(":memory:");
+
+    if(db.open())
+      {
+	QSqlQuery query(db);
+	dooble_cryptography cryptography
+	  (dooble_random::random_bytes(64),
+	   dooble_random::random_bytes(32),
+	   "AES-256",
+	   "SHA3-512");
+
+	query.exec("CREATE TABLE IF NOT EXISTS dooble_benchmarks ("
+		   "data BLOB NOT NULL, "
+		   "data_digest BLOB PRIMARY KEY NOT NULL)");
+
+	QElapsedTimer timer;
+
+	timer.start();
+	db.transaction();
+
+	for(int i = 0; i < rows; i++)
+	  {
+	    auto data(QByteArray::number(i).repeated(16));
+
+	    query.prepare("INSERT OR REPLACE INTO dooble_benchmarks "
+			  "(data, data_digest) VALUES (?, ?)");
+	    query.addBindValue(cryptography.encrypt_then_mac(data));
+	    query.addBindValue(cryptography.hmac(data));
+	    query.exec();
+	  }
+
+	db.commit();
+
+	auto elapsed = qMax(static_cast<qint64> (1), timer.nsecsElapsed());
+	QJsonObject parameters;
+
+	parameters["rows"] = rows;
+	results << result("sqlite_encrypted_insert",
+			  "rows/s",
+			  1.0e9 * rows / static_cast<double> (elapsed),
+			  parameters);
+	query.setForwardOnly(true);
+	timer.restart();
+
+	int selected = 0;
+
+	if(query.exec("SELECT data FROM dooble_benchmarks"))
+	  while(query.next())
+	    if(!cryptography.mac_then_decrypt(query.value(0).toByteArray()).
+	       isEmpty())
+	      selected += 1;
+
+	elapsed = qMax(static_cast<qint64> (1), timer.nsecsElapsed());
+	parameters["rows"] = selected;
+	results << result("sqlite_encrypted_select",
+			  "rows/s",
+			  1.0e9 * selected / static_cast<double> (elapsed),
+			  parameters);
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+}
+
+static void benchmark_sqlite_statement_cache(QJsonArray &results)
+{
+  auto file_name
+    (QDir::tempPath() +
+     QDir::separator() +
+     QString("dooble_benchmarks_%1.db").
+     arg(QCoreApplication::applicationPid()));
+
+  {
+    auto db(dooble_database_utilities::database(file_name));
+    const QString statement
+      ("SELECT data FROM dooble_benchmarks WHERE data_digest IN (?, ?)");
+
+    if(db.isOpen())
+      {
+	QSqlQuery query(db);
+
+	query.exec("CREATE TABLE IF NOT EXISTS dooble_benchmarks ("
+		   "data TEXT NOT NULL, "
+		   "data_digest TEXT PRIMARY KEY NOT NULL)");
+	query.exec("INSERT OR REPLACE INTO dooble_benchmarks "
+		   "(data, data_digest) VALUES ('data', 'digest')");
+
+	auto hits = dooble_database_utilities::statement_cache_hits();
+	auto misses = dooble_database_utilities::statement_cache_misses();
+	auto value = operations_per_second
+	  ([&](void)
+	   {
+	     auto query = dooble_database_utilities::prepared_query
+	       (db, statement);
+
+	     if(query)
+	       {
+		 query->bindValue(0, "digest");
+		 query->bindValue(1, "digest/");
+
+		 if(query->exec())
+		   query->next();
+
+		 query->finish();
+	       }
+	   });
+	QJsonObject parameters;
+
+	parameters["hits"] = static_cast<double>
+	  (dooble_database_utilities::statement_cache_hits() - hits);
+	parameters["misses"] = static_cast<double>
+	  (dooble_database_utilities::statement_cache_misses() - misses);
+	results << result
+	  ("sqlite_cached_lookup", "lookups/s", value, parameters);
+	results << result
+	  ("sqlite_uncached_lookup",
+	   "lookups/s",
+	   operations_per_second
+	   ([&](void)
+	    {
+	      QSqlQuery query(db);
+
+	      query.setForwardOnly(true);
+	      query.prepare(statement);
+	      query.addBindValue("digest");
+	      query.addBindValue("digest/");
+
+	      if(query.exec())
+		query.next();
+	    }),
+	   QJsonObject());
+      }
+  }
+
+  dooble_database_utilities::forget_database(file_name);
+  QFile::remove(file_name);
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication application(argc, argv);
+  QString output("");
+
+  for(int i = 1; i < argc; i++)
+    if(argv && argv[i])
+      {
+	if(strcmp(argv[i], "--duration") == 0)
+	  {
+	    i += 1;
+
+	    if(argc > i && argv[i])
+	      s_duration = qMax(1, QString(argv[i]).toInt());
+	  }
+	else if(strcmp(argv[i], "--output") == 0)
+	  {
+	    i += 1;
+
+	    if(argc > i && argv[i])
+	      output = QString::fromLocal8Bit(argv[i]);
+	  }
+      }
+
+  dooble_random::initialize();
+
+  QJsonArray results;
+
+  benchmark_block_ciphers(results);
+  benchmark_hmacs(results);
+  benchmark_memcmp(results);
+  benchmark_pbkdf2(results);
+  benchmark_round_trips(results);
+  benchmark_sqlite(results);
+  benchmark_sqlite_statement_cache(results);
+
+  QJsonObject object;
+
+  object["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+  object["duration_milliseconds"] = s_duration;
+  object["ideal_thread_count"] = QThread::idealThreadCount();
+  object["qt_version"] = qVersion();
+  object["results"] = results;
+  object["version"] = DOOBLE_VERSION_STRING;
+
+  auto bytes(QJsonDocument(object).toJson());
+
+  if(output.isEmpty())
+    std::cout << bytes.constData();
+  else
+    {
+      QFile file(output);
+
+      if(!file.open(QIODevice::Truncate | QIODevice::WriteOnly))
+	{
+	  std::cerr << "Cannot open " << output.toStdString() << "."
+		    << std::endl;
+	  return EXIT_FAILURE;
+	}
+
+      file.write(bytes);
+    }
+
+  return EXIT_SUCCESS;
+}
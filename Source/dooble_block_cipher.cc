@@ -25,7 +25,11 @@
 ** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <QtGlobal>
+
 #include "dooble_block_cipher.h"
+#include "dooble_cryptography.h"
+#include "dooble_random.h"
 
 dooble_block_cipher::dooble_block_cipher(const QByteArray &key)
 {
@@ -48,3 +52,187 @@ void dooble_block_cipher::set_tweak(const QByteArray &tweak, bool *ok)
   Q_UNUSED(ok);
   Q_UNUSED(tweak);
 }
+
+QByteArray dooble_block_cipher::decrypt(const QByteArray &data) const
+{
+  QByteArray plaintext(plaintext_capacity(data.length()), Qt::Uninitialized);
+  int length = 0;
+
+  if(Q_UNLIKELY(plaintext.isEmpty()))
+    return QByteArray();
+
+  if(Q_UNLIKELY(!decrypt_into(data.constData(),
+			      data.length(),
+			      plaintext.data(),
+			      &length)))
+    {
+      dooble_cryptography::memzero(plaintext);
+      return QByteArray();
+    }
+
+  plaintext.resize(length);
+  return plaintext;
+}
+
+QByteArray dooble_block_cipher::encrypt(const QByteArray &data) const
+{
+  QByteArray ciphertext(ciphertext_length(data.length()), Qt::Uninitialized);
+
+  if(Q_UNLIKELY(ciphertext.isEmpty()))
+    return QByteArray();
+
+  if(Q_UNLIKELY(!encrypt_into(data.constData(),
+			      data.length(),
+			      ciphertext.data())))
+    return QByteArray();
+
+  return ciphertext;
+}
+
+bool dooble_block_cipher::decrypt_into(const char *data,
+				       const int length,
+				       char *plaintext,
+				       int *plaintext_length) const
+{
+  /*
+  ** CBC. The plaintext container must provide plaintext_capacity(length)
+  ** bytes and may not overlap data. The plaintext's true length is
+  ** recorded in the final four bytes of the last block.
+  */
+
+  if(plaintext_length)
+    *plaintext_length = 0;
+
+  if(Q_UNLIKELY(!data ||
+		!plaintext ||
+		length < 2 * m_block_length ||
+		m_block_length <= static_cast<int> (sizeof(int))))
+    return false;
+
+  auto block_length = static_cast<size_t> (m_block_length);
+  auto blocks = static_cast<size_t> (length - m_block_length) / block_length;
+  auto c = reinterpret_cast<const uint8_t *> (data);
+  auto p = reinterpret_cast<uint8_t *> (plaintext);
+  auto previous = c; // The initialization vector.
+
+  for(size_t i = 0; i < blocks; i++)
+    {
+      auto in = c + block_length * (i + 1);
+      auto out = p + block_length * i;
+
+      if(Q_UNLIKELY(!decrypt_block(in, out)))
+	return false;
+
+      for(size_t j = 0; j < block_length; j++)
+	out[j] ^= previous[j];
+
+      previous = in;
+    }
+
+  auto decrypted_length = blocks * block_length;
+  auto trailer = p + decrypted_length - sizeof(int);
+  auto original_length = static_cast<int>
+    ((static_cast<uint32_t> (trailer[0]) << 24) |
+     (static_cast<uint32_t> (trailer[1]) << 16) |
+     (static_cast<uint32_t> (trailer[2]) << 8) |
+     static_cast<uint32_t> (trailer[3]));
+
+  if(original_length < 0 ||
+     original_length > static_cast<int> (decrypted_length))
+    return false;
+
+  if(plaintext_length)
+    *plaintext_length = original_length;
+
+  return true;
+}
+
+bool dooble_block_cipher::encrypt_into(const char *data,
+				       const int length,
+				       char *ciphertext) const
+{
+  /*
+  ** CBC. The ciphertext container must provide ciphertext_length(length)
+  ** bytes and may not overlap data. The plaintext is padded with zeros
+  ** to a whole number of blocks plus one, the final four bytes of which
+  ** record the plaintext's length in big-endian order.
+  */
+
+  if(Q_UNLIKELY(!ciphertext ||
+		(!data && length > 0) ||
+		length < 0 ||
+		m_block_length <= static_cast<int> (sizeof(int))))
+    return false;
+
+  auto iv(dooble_random::random_bytes(m_block_length));
+
+  if(Q_UNLIKELY(iv.length() != m_block_length))
+    return false;
+
+  auto block_length = static_cast<size_t> (m_block_length);
+  auto blocks = static_cast<size_t>
+    (ciphertext_length(length) - m_block_length) / block_length;
+  auto c = reinterpret_cast<uint8_t *> (ciphertext);
+  auto p = reinterpret_cast<const uint8_t *> (data);
+  auto size = static_cast<size_t> (length);
+  uint8_t trailer[sizeof(int)];
+
+  trailer[0] = static_cast<uint8_t> (static_cast<uint32_t> (length) >> 24);
+  trailer[1] = static_cast<uint8_t> (static_cast<uint32_t> (length) >> 16);
+  trailer[2] = static_cast<uint8_t> (static_cast<uint32_t> (length) >> 8);
+  trailer[3] = static_cast<uint8_t> (static_cast<uint32_t> (length));
+  memcpy(c, iv.constData(), block_length);
+
+  for(size_t i = 0; i < blocks; i++)
+    {
+      auto offset = block_length * i;
+      auto out = c + offset + block_length;
+      auto previous = c + offset;
+
+      if(offset + block_length <= size)
+	for(size_t j = 0; j < block_length; j++)
+	  out[j] = previous[j] ^ p[offset + j];
+      else
+	{
+	  for(size_t j = 0; j < block_length; j++)
+	    out[j] = offset + j < size ?
+	      previous[j] ^ p[offset + j] : previous[j];
+
+	  if(i == blocks - 1)
+	    for(size_t j = 0; j < sizeof(int); j++)
+	      out[block_length - sizeof(int) + j] ^= trailer[j];
+	}
+
+      if(Q_UNLIKELY(!encrypt_block(out, out)))
+	return false;
+    }
+
+  return true;
+}
+
+int dooble_block_cipher::ciphertext_length(const int plaintext_length) const
+{
+  if(Q_UNLIKELY(m_block_length <= 0 || plaintext_length < 0))
+    return 0;
+
+  /*
+  ** The initialization vector, the padded plaintext, and an
+  ** additional block if the plaintext is not empty.
+  */
+
+  if(plaintext_length == 0)
+    return 2 * m_block_length;
+
+  return m_block_length *
+    ((plaintext_length + m_block_length - 1) / m_block_length + 2);
+}
+
+int dooble_block_cipher::plaintext_capacity(const int ciphertext_length) const
+{
+  if(Q_UNLIKELY(m_block_length <= 0 ||
+		ciphertext_length < 2 * m_block_length))
+    return 0;
+
+  return m_block_length *
+    ((ciphertext_length - m_block_length) / m_block_length);
+}
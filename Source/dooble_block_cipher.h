@@ -30,12 +30,26 @@
 
 #include <QByteArray>
 
+extern "C"
+{
+#include <stdint.h>
+}
+
 class dooble_block_cipher
 {
  public:
   virtual ~dooble_block_cipher();
-  virtual QByteArray decrypt(const QByteArray &data) = 0;
-  virtual QByteArray encrypt(const QByteArray &data) = 0;
+  QByteArray decrypt(const QByteArray &data) const;
+  QByteArray encrypt(const QByteArray &data) const;
+  bool decrypt_into(const char *data,
+		    const int length,
+		    char *plaintext,
+		    int *plaintext_length) const;
+  bool encrypt_into(const char *data,
+		    const int length,
+		    char *ciphertext) const;
+  int ciphertext_length(const int plaintext_length) const;
+  int plaintext_capacity(const int ciphertext_length) const;
   virtual void set_key(const QByteArray &key) = 0;
   virtual void set_tweak(const QByteArray &tweak, bool *ok);
 
@@ -45,17 +59,8 @@ class dooble_block_cipher
   int m_key_length;
   dooble_block_cipher(const QByteArray &key);
   dooble_block_cipher(void);
-
-  static QByteArray xor_arrays(const QByteArray &a, const QByteArray &b)
-  {
-    QByteArray bytes;
-    auto length = qMin(a.length(), b.length());
-
-    for(int i = 0; i < length; i++)
-      bytes.append(static_cast<char> (a[i] ^ b[i]));
-
-    return bytes;
-  }
+  virtual bool decrypt_block(const uint8_t *in, uint8_t *out) const = 0;
+  virtual bool encrypt_block(const uint8_t *in, uint8_t *out) const = 0;
 };
 
 #endif
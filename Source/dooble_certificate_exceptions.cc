@@ -243,12 +243,10 @@ void dooble_certificate_exceptions::slot_delete_selected(void)
 		       QDir::separator() +
 		       "dooble_certificate_exceptions.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
-
 	for(int i = list.size() - 1; i >= 0; i--)
 	  {
 	    query.prepare
@@ -304,7 +302,7 @@ void dooble_certificate_exceptions::slot_populate(void)
 			   QDir::separator() +
 			   "dooble_certificate_exceptions.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
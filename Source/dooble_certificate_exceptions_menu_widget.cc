@@ -47,61 +47,58 @@ dooble_certificate_exceptions_menu_widget(QWidget *parent):QWidget(parent)
 
 bool dooble_certificate_exceptions_menu_widget::has_exception(const QUrl &url)
 {
-  auto database_name(dooble_database_utilities::database_name());
   auto state = false;
+  auto db
+    (dooble_database_utilities::
+     database(dooble_settings::setting("home_path").toString() +
+	      QDir::separator() +
+	      "dooble_certificate_exceptions.db",
+	      &create_tables));
+
+  if(db.isOpen())
+    {
+      auto query = dooble_database_utilities::prepared_query
+	(db,
+	 "SELECT exception_accepted, OID FROM "
+	 "dooble_certificate_exceptions WHERE url_digest "
+	 "IN (?, ?)");
+
+      if(!query)
+	return state;
+
+      query->bindValue
+	(0, dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
+      query->bindValue
+	(1, dooble::s_cryptography->hmac(url.toEncoded() + "/").toBase64());
+
+      if(dooble_database_utilities::exec(db, query))
+	if(query->next())
+	  {
+	    auto bytes
+	      (QByteArray::fromBase64(query->value(0).toByteArray()));
+
+	    bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
+
+	    if(!bytes.isEmpty())
+	      state = bytes == "true";
+	    else
+	      {
+		dooble_database_utilities::remove_entry
+		  (db,
+		   "dooble_certificate_exceptions",
+		   query->value(1).toLongLong());
+	      }
+	  }
+
+      query->finish();
+    }
 
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_certificate_exceptions.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.setForwardOnly(true);
-	query.prepare("SELECT exception_accepted, OID FROM "
-		      "dooble_certificate_exceptions WHERE url_digest "
-		      "IN (?, ?)");
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded() + "/").toBase64());
-
-	if(query.exec())
-	  if(query.next())
-	    {
-	      auto bytes
-		(QByteArray::fromBase64(query.value(0).toByteArray()));
-
-	      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-	      if(!bytes.isEmpty())
-		state = bytes == "true";
-	      else
-		{
-		  dooble_database_utilities::remove_entry
-		    (db,
-		     "dooble_certificate_exceptions",
-		     query.value(1).toLongLong());
-		}
-	    }
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
   return state;
 }
 
 void dooble_certificate_exceptions_menu_widget::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
@@ -116,87 +113,64 @@ void dooble_certificate_exceptions_menu_widget::create_tables(QSqlDatabase &db)
 void dooble_certificate_exceptions_menu_widget::exception_accepted
 (const QString &error, const QUrl &url)
 {
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_certificate_exceptions.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.prepare
-	  ("INSERT INTO dooble_certificate_exceptions "
-	   "(error, exception_accepted, temporary, url, url_digest) "
-	   "VALUES (?, ?, ?, ?, ?)");
-
-	QByteArray bytes;
+  auto db
+    (dooble_database_utilities::
+     database(dooble_settings::setting("home_path").toString() +
+	      QDir::separator() +
+	      "dooble_certificate_exceptions.db",
+	      &create_tables));
+
+  if(db.isOpen())
+    {
+      auto query = dooble_database_utilities::prepared_query
+	(db,
+	 "INSERT INTO dooble_certificate_exceptions "
+	 "(error, exception_accepted, temporary, url, url_digest) "
+	 "VALUES (?, ?, ?, ?, ?)");
 
-	bytes = dooble::s_cryptography->encrypt_then_mac(error.toUtf8());
+      if(!query)
+	return;
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
+      QByteArray bytes;
 
-	bytes = dooble::s_cryptography->encrypt_then_mac("true");
+      bytes = dooble::s_cryptography->encrypt_then_mac(error.toUtf8());
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+      if(!bytes.isEmpty())
+	query->bindValue(0, bytes.toBase64());
+      else
+	return;
 
-	query.addBindValue(dooble::s_cryptography->authenticated() ? 0 : 1);
-	bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
+      bytes = dooble::s_cryptography->encrypt_then_mac("true");
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+      if(!bytes.isEmpty())
+	query->bindValue(1, bytes.toBase64());
+      else
+	return;
 
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
+      query->bindValue(2, dooble::s_cryptography->authenticated() ? 0 : 1);
+      bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
 
-	if(query.exec())
-	  if(dooble::s_certificate_exceptions)
-	    dooble::s_certificate_exceptions->exception_accepted(error, url);
-      }
+      if(!bytes.isEmpty())
+	query->bindValue(3, bytes.toBase64());
+      else
+	return;
 
-  done_label:
-    db.close();
-  }
+      query->bindValue
+	(4, dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
 
-  QSqlDatabase::removeDatabase(database_name);
+      if(dooble_database_utilities::exec(db, query))
+	if(dooble::s_certificate_exceptions)
+	  dooble::s_certificate_exceptions->exception_accepted(error, url);
+    }
 }
 
 void dooble_certificate_exceptions_menu_widget::purge(void)
 {
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_certificate_exceptions.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_certificate_exceptions");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_certificate_exceptions.db",
+     QStringList() << "DELETE FROM dooble_certificate_exceptions");
 }
 
 void dooble_certificate_exceptions_menu_widget::purge_temporary(void)
@@ -210,11 +184,10 @@ void dooble_certificate_exceptions_menu_widget::purge_temporary(void)
 		       QDir::separator() +
 		       "dooble_certificate_exceptions.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
 	query.exec
 	  ("DELETE FROM dooble_certificate_exceptions WHERE temporary = 1");
       }
@@ -254,7 +227,7 @@ void dooble_certificate_exceptions_menu_widget::slot_remove_exception(void)
 		       QDir::separator() +
 		       "dooble_certificate_exceptions.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
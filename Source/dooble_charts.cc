@@ -893,7 +893,7 @@ QString dooble_charts::type_from_database(const QString &name)
 		       QDir::separator() +
 		       "dooble_charts.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -981,7 +981,7 @@ void dooble_charts::open(const QString &name)
 		       QDir::separator() +
 		       "dooble_charts.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 	QString theme("");
@@ -1437,26 +1437,11 @@ void dooble_charts::purge(void)
 {
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_charts.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("DELETE FROM dooble_charts");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_charts.db",
+     QStringList() << "DELETE FROM dooble_charts");
   QApplication::restoreOverrideCursor();
 }
 
@@ -1487,7 +1472,7 @@ void dooble_charts::save(QString &error)
 		       QDir::separator() +
 		       "dooble_charts.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -361,7 +361,7 @@ void dooble_charts_xyseries::save(QString &error)
 		       QDir::separator() +
 		       "dooble_charts.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 	auto name(properties().value(dooble_charts::Properties::CHART_NAME).
@@ -36,6 +36,7 @@
 #include "dooble_charts.h"
 #include "dooble_clear_items.h"
 #include "dooble_cookies.h"
+#include "dooble_database_utilities.h"
 #include "dooble_downloads.h"
 #include "dooble_favicons.h"
 #include "dooble_history.h"
@@ -120,6 +121,12 @@ void dooble_clear_items::slot_clear_items(void)
 
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
+  /*
+  ** Consolidated databases are purged by a single transaction.
+  */
+
+  dooble_database_utilities::begin_purge();
+
   if(m_ui.accepted_blocked_domains->isChecked())
     dooble::s_accepted_or_blocked_domains->purge();
 
@@ -133,10 +140,7 @@ void dooble_clear_items::slot_clear_items(void)
     dooble_charts::purge();
 
   if(m_ui.cookies->isChecked())
-    {
-      dooble_cookies::purge();
-      emit cookies_cleared();
-    }
+    dooble_cookies::purge();
 
   if(m_ui.download_history->isChecked())
     dooble::s_downloads->purge();
@@ -145,22 +149,27 @@ void dooble_clear_items::slot_clear_items(void)
     dooble_favicons::purge();
 
   if(m_ui.favorites->isChecked())
-    {
-      dooble::s_history->purge_favorites();
-      emit favorites_cleared();
-    }
+    dooble::s_history->purge_favorites();
 
   if(m_ui.history->isChecked())
-    {
-      dooble::s_history->purge_history();
-      emit history_cleared();
-    }
+    dooble::s_history->purge_history();
 
   if(m_ui.search_engines->isChecked())
-    {
-      dooble::s_search_engines_window->purge();
-      emit search_engines_cleared();
-    }
+    dooble::s_search_engines_window->purge();
+
+  dooble_database_utilities::end_purge();
+
+  if(m_ui.cookies->isChecked())
+    emit cookies_cleared();
+
+  if(m_ui.favorites->isChecked())
+    emit favorites_cleared();
+
+  if(m_ui.history->isChecked())
+    emit history_cleared();
+
+  if(m_ui.search_engines->isChecked())
+    emit search_engines_cleared();
 
   if(m_ui.visited_links->isChecked())
     QWebEngineProfile::defaultProfile()->clearAllVisitedLinks();
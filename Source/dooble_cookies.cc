@@ -34,6 +34,7 @@
 #include "dooble_cookies.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 
 dooble_cookies::dooble_cookies(bool is_private, QObject *parent):QObject(parent)
 {
@@ -52,12 +53,12 @@ QByteArray dooble_cookies::identifier(const QNetworkCookie &cookie)
 
 void dooble_cookies::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
   query.exec("CREATE TABLE IF NOT EXISTS dooble_cookies_domains ("
-	     "domain TEXT NOT NULL, "
+	     "domain BLOB NOT NULL, "
 	     "domain_digest TEXT NOT NULL PRIMARY KEY, "
 	     "favorite_digest TEXT NOT NULL)");
   query.exec("CREATE TABLE IF NOT EXISTS dooble_cookies ("
@@ -72,30 +73,20 @@ void dooble_cookies::create_tables(QSqlDatabase &db)
 
 void dooble_cookies::purge(void)
 {
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_cookies.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA foreign_keys = ON");
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_cookies");
-	query.exec("DELETE FROM dooble_cookies_domains");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->discard
+      (dooble_settings::setting("home_path").toString() +
+       QDir::separator() +
+       "dooble_cookies.db");
+
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_cookies.db",
+     QStringList()
+     << "PRAGMA foreign_keys = ON"
+     << "DELETE FROM dooble_cookies"
+     << "DELETE FROM dooble_cookies_domains");
 }
 
 void dooble_cookies::slot_connect_cookie_added_signal(void)
@@ -114,7 +105,9 @@ void dooble_cookies::slot_cookie_added(const QNetworkCookie &cookie)
     (QList<QNetworkCookie> ()
      << cookie, QList<int> () << BlockedOrFavorite::NONE);
 
-  if(!dooble::s_cryptography || !dooble::s_cryptography->authenticated())
+  if(!dooble::s_cryptography ||
+     !dooble::s_cryptography->authenticated() ||
+     !dooble::s_database_writer)
     return;
   else if(m_is_private)
     return;
@@ -147,98 +140,71 @@ void dooble_cookies::slot_cookie_added(const QNetworkCookie &cookie)
 
  save_label:
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_cookies.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.prepare
-	  ("INSERT INTO dooble_cookies_domains "
-	   "(domain, domain_digest, favorite_digest) VALUES (?, ?, ?)");
-
-	QByteArray bytes;
-
-	bytes = dooble::s_cryptography->encrypt_then_mac
-	  (cookie.domain().toUtf8());
-
-	if(!bytes.isEmpty())
-	  {
-	    query.addBindValue(bytes.toBase64());
-	    query.addBindValue
-	      (dooble::s_cryptography->hmac(cookie.domain()).toBase64());
-	    query.addBindValue
-	      (dooble::s_cryptography->hmac(QByteArray("xyz")).toBase64());
-	    query.exec();
-	  }
-
-	query.prepare
-	  ("INSERT OR REPLACE INTO dooble_cookies "
-	   "(domain_digest, identifier_digest, raw_form) VALUES (?, ?, ?)");
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(cookie.domain()).toBase64());
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(identifier(cookie)).toBase64());
-	bytes = dooble::s_cryptography->encrypt_then_mac(cookie.toRawForm());
-
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
-
-	query.exec();
-      }
-
-  done_label:
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  QByteArray bytes;
+  auto domain_digest(dooble::s_cryptography->hmac(cookie.domain()).toBase64());
+  auto file_name
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_cookies.db");
+  auto identifier_digest
+    (dooble::s_cryptography->hmac(identifier(cookie)).toBase64());
+
+  bytes = dooble::s_cryptography->encrypt_then_mac(cookie.domain().toUtf8());
+
+  if(!bytes.isEmpty())
+    dooble::s_database_writer->enqueue
+      (file_name,
+       &create_tables,
+       "dooble_cookies_domains/" + domain_digest,
+       "INSERT INTO dooble_cookies_domains "
+       "(domain, domain_digest, favorite_digest) VALUES (?, ?, ?)",
+       QVariantList()
+       << bytes
+       << domain_digest
+       << dooble::s_cryptography->memoized_hmac(QByteArray("xyz")).
+       toBase64());
+
+  bytes = dooble::s_cryptography->encrypt_then_mac(cookie.toRawForm());
+
+  if(!bytes.isEmpty())
+    dooble::s_database_writer->enqueue
+      (file_name,
+       &create_tables,
+       "dooble_cookies/" + identifier_digest,
+       "INSERT OR REPLACE INTO dooble_cookies "
+       "(domain_digest, identifier_digest, raw_form) VALUES (?, ?, ?)",
+       QVariantList()
+       << domain_digest
+       << identifier_digest
+       << bytes);
 }
 
 void dooble_cookies::slot_cookie_removed(const QNetworkCookie &cookie)
 {
   emit cookie_removed(cookie);
 
-  if(!dooble::s_cryptography || !dooble::s_cryptography->authenticated())
+  if(!dooble::s_cryptography ||
+     !dooble::s_cryptography->authenticated() ||
+     !dooble::s_database_writer)
     return;
   else if(m_is_private)
     return;
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_cookies.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.prepare("DELETE FROM dooble_cookies WHERE identifier_digest = ?");
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(identifier(cookie)).toBase64());
-	query.exec();
-      }
-
-    db.close();
-  }
+  /*
+  ** The removal replaces a pending insertion of the same cookie.
+  */
 
-  QSqlDatabase::removeDatabase(database_name);
+  auto identifier_digest
+    (dooble::s_cryptography->hmac(identifier(cookie)).toBase64());
+
+  dooble::s_database_writer->enqueue
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_cookies.db",
+     &create_tables,
+     "dooble_cookies/" + identifier_digest,
+     "DELETE FROM dooble_cookies WHERE identifier_digest = ?",
+     QVariantList() << identifier_digest);
 }
 
 void dooble_cookies::slot_delete_cookie(const QNetworkCookie &cookie)
@@ -248,6 +214,9 @@ void dooble_cookies::slot_delete_cookie(const QNetworkCookie &cookie)
   else if(m_is_private)
     return;
 
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto database_name(dooble_database_utilities::database_name());
 
   {
@@ -257,11 +226,10 @@ void dooble_cookies::slot_delete_cookie(const QNetworkCookie &cookie)
 		       QDir::separator() +
 		       "dooble_cookies.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
 	query.prepare("DELETE FROM dooble_cookies WHERE identifier_digest = ?");
 	query.addBindValue
 	  (dooble::s_cryptography->hmac(identifier(cookie)).toBase64());
@@ -270,7 +238,7 @@ void dooble_cookies::slot_delete_cookie(const QNetworkCookie &cookie)
 		      "domain_digest NOT IN (SELECT domain_digest FROM "
 		      "dooble_cookies) AND favorite_digest = ?");
 	query.addBindValue
-	  (dooble::s_cryptography->hmac(QByteArray("xyz")).toBase64());
+	  (dooble::s_cryptography->memoized_hmac(QByteArray("xyz")).toBase64());
 	query.exec();
       }
 
@@ -287,6 +255,9 @@ void dooble_cookies::slot_delete_domain(const QString &domain)
   else if(m_is_private)
     return;
 
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto database_name(dooble_database_utilities::database_name());
 
   {
@@ -296,12 +267,11 @@ void dooble_cookies::slot_delete_domain(const QString &domain)
 		       QDir::separator() +
 		       "dooble_cookies.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
 	query.exec("PRAGMA foreign_keys = ON");
-	query.exec("PRAGMA synchronous = OFF");
 	query.prepare("DELETE FROM dooble_cookies_domains WHERE "
 		      "domain_digest = ?");
 	query.addBindValue
@@ -323,6 +293,9 @@ void dooble_cookies::slot_delete_items(const QList<QNetworkCookie> &cookies,
   else if(m_is_private)
     return;
 
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto database_name(dooble_database_utilities::database_name());
 
   {
@@ -332,12 +305,10 @@ void dooble_cookies::slot_delete_items(const QList<QNetworkCookie> &cookies,
 		       QDir::separator() +
 		       "dooble_cookies.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
-
 	foreach(const auto &cookie, cookies)
 	  {
 	    query.prepare
@@ -352,7 +323,7 @@ void dooble_cookies::slot_delete_items(const QList<QNetworkCookie> &cookies,
 		      "domain_digest NOT IN (SELECT domain_digest FROM "
 		      "dooble_cookies) AND favorite_digest = ?");
 	query.addBindValue
-	  (dooble::s_cryptography->hmac(QByteArray("xyz")).toBase64());
+	  (dooble::s_cryptography->memoized_hmac(QByteArray("xyz")).toBase64());
 	query.exec();
 	query.exec("PRAGMA foreign_keys = ON");
 
@@ -403,53 +374,68 @@ void dooble_cookies::slot_populate(void)
 		       QDir::separator() +
 		       "dooble_cookies.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
 	QList<QNetworkCookie> cookies;
 	QList<int> is_blocked_or_favorite;
 	QSqlQuery query(db);
+	auto blocked
+	  (dooble::s_cryptography->memoized_hmac(QByteArray("blocked")).
+	   toBase64());
+	auto favorite
+	  (dooble::s_cryptography->memoized_hmac(QByteArray("favorite")).
+	   toBase64());
 
 	query.setForwardOnly(true);
 
 	if(query.exec("SELECT domain, favorite_digest FROM "
 		      "dooble_cookies_domains"))
-	  while(query.next())
-	    {
-	      auto bytes
-		(QByteArray::fromBase64(query.value(0).toByteArray()));
-
-	      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-	      if(bytes.isEmpty())
-		{
-		  QSqlQuery delete_query(db);
-
-		  delete_query.exec("PRAGMA foreign_keys = ON");
-		  delete_query.prepare
-		    ("DELETE FROM dooble_cookies_domains WHERE domain = ?");
-		  delete_query.addBindValue(query.value(0));
-		  delete_query.exec();
-		  continue;
-		}
-
-	      QNetworkCookie cookie;
-	      auto is_blocked = dooble_cryptography::memcmp
-		(dooble::s_cryptography->hmac(QByteArray("blocked")).toBase64(),
-		 query.value(1).toByteArray());
-	      auto is_favorite = dooble_cryptography::memcmp
-		(dooble::s_cryptography->hmac(QByteArray("favorite")).
-		 toBase64(),
-		 query.value(1).toByteArray());
-
-	      cookie.setDomain(bytes);
-	      cookies << cookie;
-	      is_blocked_or_favorite <<
-		(is_blocked ? BlockedOrFavorite::BLOCKED :
-		 is_favorite ? BlockedOrFavorite::FAVORITE :
-		 BlockedOrFavorite::NONE);
-	    }
+	  {
+	    QVector<QByteArray> data;
+	    QVector<QByteArray> digests;
+	    QVector<QVariant> values;
+
+	    while(query.next())
+	      {
+		data << dooble_database_utilities::blob(query.value(0));
+		digests << query.value(1).toByteArray();
+		values << query.value(0);
+	      }
+
+	    data = dooble::s_cryptography->mac_then_decrypt_batch(data);
+
+	    for(int i = 0; i < data.size(); i++)
+	      {
+		const auto &bytes(data.at(i));
+
+		if(bytes.isEmpty())
+		  {
+		    QSqlQuery delete_query(db);
+
+		    delete_query.exec("PRAGMA foreign_keys = ON");
+		    delete_query.prepare
+		      ("DELETE FROM dooble_cookies_domains WHERE domain = ?");
+		    delete_query.addBindValue(values.at(i));
+		    delete_query.exec();
+		    continue;
+		  }
+
+		QNetworkCookie cookie;
+		auto is_blocked = dooble_cryptography::memcmp
+		  (blocked, digests.at(i));
+		auto is_favorite = dooble_cryptography::memcmp
+		  (favorite, digests.at(i));
+
+		cookie.setDomain(bytes);
+		cookies << cookie;
+		is_blocked_or_favorite <<
+		  (is_blocked ? BlockedOrFavorite::BLOCKED :
+		   is_favorite ? BlockedOrFavorite::FAVORITE :
+		   BlockedOrFavorite::NONE);
+	      }
+	  }
 
 	if(!cookies.isEmpty() && !is_blocked_or_favorite.isEmpty())
 	  emit cookies_added(cookies, is_blocked_or_favorite);
@@ -462,121 +448,126 @@ void dooble_cookies::slot_populate(void)
 		      "WHERE a.domain_digest = b.domain_digest) "
 		      "AS favorite_digest, "
 		      "raw_form FROM dooble_cookies b"))
-	  while(query.next())
-	    {
-	      auto bytes
-		(QByteArray::fromBase64(query.value(1).toByteArray()));
-
-	      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-	      if(bytes.isEmpty())
-		{
-		  QSqlQuery delete_query(db);
-
-		  delete_query.prepare
-		    ("DELETE FROM dooble_cookies WHERE raw_form = ?");
-		  delete_query.addBindValue(query.value(1));
-		  delete_query.exec();
-		  delete_query.prepare
-		    ("DELETE FROM dooble_cookies_domains WHERE "
-		     "domain_digest NOT IN (SELECT domain_digest FROM "
-		     "dooble_cookies) AND favorite_digest = ?");
-		  delete_query.addBindValue
-		    (dooble::s_cryptography->hmac(QByteArray("xyz")).
-		     toBase64());
-		  delete_query.exec();
-		  continue;
-		}
-
-	      auto cookie = QNetworkCookie::parseCookies(bytes);
-
-	      if(cookie.isEmpty())
-		{
-		  QSqlQuery delete_query(db);
-
-		  delete_query.prepare
-		    ("DELETE FROM dooble_cookies WHERE raw_form = ?");
-		  delete_query.addBindValue(query.value(1));
-		  delete_query.exec();
-		  delete_query.prepare
-		    ("DELETE FROM dooble_cookies_domains WHERE "
-		     "domain_digest NOT IN (SELECT domain_digest FROM "
-		     "dooble_cookies) AND favorite_digest = ?");
-		  delete_query.addBindValue
-		    (dooble::s_cryptography->hmac(QByteArray("xyz")).
-		     toBase64());
-		  delete_query.exec();
-		  continue;
-		}
-
-	      auto allow_expired = false;
-	      auto now(QDateTime::currentDateTime());
-
-	      if(cookie.at(0).isSessionCookie())
-		{
-		  if(dooble_settings::
-		     cookie_policy_string(dooble_settings::
-					  setting("cookie_policy_index").
-					  toInt()) == "save_all")
-		    /*
-		    ** Ignore the session cookie's expiration date.
-		    */
-
-		    allow_expired = true;
-		}
-	      else
-		allow_expired = false;
-
-	      if(!allow_expired)
-		if(cookie.at(0).expirationDate().toLocalTime() <= now)
+	  {
+	    QVector<QByteArray> data;
+	    QVector<QByteArray> digests;
+	    QVector<QVariant> values;
+	    auto xyz
+	      (dooble::s_cryptography->memoized_hmac(QByteArray("xyz")).
+	       toBase64());
+
+	    while(query.next())
+	      {
+		data << dooble_database_utilities::blob(query.value(1));
+		digests << query.value(0).toByteArray();
+		values << query.value(1);
+	      }
+
+	    data = dooble::s_cryptography->mac_then_decrypt_batch(data);
+
+	    for(int i = 0; i < data.size(); i++)
+	      {
+		const auto &bytes(data.at(i));
+
+		if(bytes.isEmpty())
 		  {
 		    QSqlQuery delete_query(db);
 
 		    delete_query.prepare
 		      ("DELETE FROM dooble_cookies WHERE raw_form = ?");
-		    delete_query.addBindValue(query.value(1));
+		    delete_query.addBindValue(values.at(i));
 		    delete_query.exec();
 		    delete_query.prepare
 		      ("DELETE FROM dooble_cookies_domains WHERE "
 		       "domain_digest NOT IN (SELECT domain_digest FROM "
 		       "dooble_cookies) AND favorite_digest = ?");
-		    delete_query.addBindValue
-		      (dooble::s_cryptography->hmac(QByteArray("xyz")).
-		       toBase64());
+		    delete_query.addBindValue(xyz);
 		    delete_query.exec();
 		    continue;
 		  }
 
-	      auto c(cookie.at(0));
-	      auto is_blocked = dooble_cryptography::memcmp
-		(dooble::s_cryptography->hmac(QByteArray("blocked")).
-		 toBase64(),
-		 query.value(0).toByteArray());
-	      auto is_favorite = dooble_cryptography::memcmp
-		(dooble::s_cryptography->hmac(QByteArray("favorite")).
-		 toBase64(),
-		 query.value(0).toByteArray());
+		auto cookie = QNetworkCookie::parseCookies(bytes);
+
+		if(cookie.isEmpty())
+		  {
+		    QSqlQuery delete_query(db);
+
+		    delete_query.prepare
+		      ("DELETE FROM dooble_cookies WHERE raw_form = ?");
+		    delete_query.addBindValue(values.at(i));
+		    delete_query.exec();
+		    delete_query.prepare
+		      ("DELETE FROM dooble_cookies_domains WHERE "
+		       "domain_digest NOT IN (SELECT domain_digest FROM "
+		       "dooble_cookies) AND favorite_digest = ?");
+		    delete_query.addBindValue(xyz);
+		    delete_query.exec();
+		    continue;
+		  }
+
+		auto allow_expired = false;
+		auto now(QDateTime::currentDateTime());
+
+		if(cookie.at(0).isSessionCookie())
+		  {
+		    if(dooble_settings::
+		       cookie_policy_string(dooble_settings::
+					    setting("cookie_policy_index").
+					    toInt()) == "save_all")
+		      /*
+		      ** Ignore the session cookie's expiration date.
+		      */
+
+		      allow_expired = true;
+		  }
+		else
+		  allow_expired = false;
+
+		if(!allow_expired)
+		  if(cookie.at(0).expirationDate().toLocalTime() <= now)
+		    {
+		      QSqlQuery delete_query(db);
+
+		      delete_query.prepare
+			("DELETE FROM dooble_cookies WHERE raw_form = ?");
+		      delete_query.addBindValue(values.at(i));
+		      delete_query.exec();
+		      delete_query.prepare
+			("DELETE FROM dooble_cookies_domains WHERE "
+			 "domain_digest NOT IN (SELECT domain_digest FROM "
+			 "dooble_cookies) AND favorite_digest = ?");
+		      delete_query.addBindValue(xyz);
+		      delete_query.exec();
+		      continue;
+		    }
+
+		auto c(cookie.at(0));
+		auto is_blocked = dooble_cryptography::memcmp
+		  (blocked, digests.at(i));
+		auto is_favorite = dooble_cryptography::memcmp
+		  (favorite, digests.at(i));
 
 #ifdef DOOBLE_COOKIES_REPLACE_HYPHEN_WITH_UNDERSCORE
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-	      c.setName(c.name().replace('-', '_'));
+		c.setName(c.name().replace('-', '_'));
 #endif
 #endif
-	      cookies << c;
+		cookies << c;
 
-	      auto url(QUrl::fromUserInput(c.domain()));
+		auto url(QUrl::fromUserInput(c.domain()));
 
-	      if(c.isSecure())
-		url.setScheme("https");
+		if(c.isSecure())
+		  url.setScheme("https");
 
-	      c.setDomain(""); // Limit the cookie to the exact server.
-	      count += 1;
-	      is_blocked_or_favorite <<
-		(is_blocked ? BlockedOrFavorite::BLOCKED :
-		 is_favorite ? BlockedOrFavorite::FAVORITE :
-		 BlockedOrFavorite::NONE);
-	      profile->cookieStore()->setCookie(c, url);
-	    }
+		c.setDomain(""); // Limit the cookie to the exact server.
+		count += 1;
+		is_blocked_or_favorite <<
+		  (is_blocked ? BlockedOrFavorite::BLOCKED :
+		   is_favorite ? BlockedOrFavorite::FAVORITE :
+		   BlockedOrFavorite::NONE);
+		profile->cookieStore()->setCookie(c, url);
+	      }
+	  }
 
 	if(!cookies.isEmpty() && !is_blocked_or_favorite.isEmpty())
 	  emit cookies_added(cookies, is_blocked_or_favorite);
@@ -37,6 +37,7 @@
 #include "dooble_cookies.h"
 #include "dooble_cookies_window.h"
 #include "dooble_cryptography.h"
+#include "dooble_database_utilities.h"
 #include "dooble_ui_utilities.h"
 
 dooble_cookies_window::dooble_cookies_window(bool is_private, QWidget *parent):
@@ -839,13 +840,12 @@ void dooble_cookies_window::slot_item_changed(QTreeWidgetItem *item, int column)
 		       QDir::separator() +
 		       "dooble_cookies.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	dooble_cookies::create_tables(db);
 
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
 	query.prepare
 	  ("INSERT OR REPLACE INTO dooble_cookies_domains "
 	   "(domain, domain_digest, favorite_digest) VALUES (?, ?, ?)");
@@ -856,7 +856,7 @@ void dooble_cookies_window::slot_item_changed(QTreeWidgetItem *item, int column)
 	  (item->text(0).toUtf8());
 
 	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
+	  query.addBindValue(bytes);
 	else
 	  goto done_label;
 
@@ -865,13 +865,16 @@ void dooble_cookies_window::slot_item_changed(QTreeWidgetItem *item, int column)
 
 	if(item->checkState(0) == Qt::Checked)
 	  query.addBindValue
-	    (dooble::s_cryptography->hmac(QByteArray("blocked")).toBase64());
+	    (dooble::s_cryptography->memoized_hmac(QByteArray("blocked")).
+	     toBase64());
 	else if(item->checkState(0) == Qt::PartiallyChecked)
 	  query.addBindValue
-	    (dooble::s_cryptography->hmac(QByteArray("favorite")).toBase64());
+	    (dooble::s_cryptography->memoized_hmac(QByteArray("favorite")).
+	     toBase64());
 	else
 	  query.addBindValue
-	    (dooble::s_cryptography->hmac(QByteArray("xyz")).toBase64());
+	    (dooble::s_cryptography->memoized_hmac(QByteArray("xyz")).
+	     toBase64());
 
 	query.exec();
       }
@@ -26,6 +26,12 @@
 */
 
 #include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtDebug>
+#include <QtMath>
 
 #ifndef Q_OS_WIN
 extern "C"
@@ -34,14 +40,48 @@ extern "C"
 }
 #endif
 
+#if defined(__GLIBC__)
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25)
+#define DOOBLE_EXPLICIT_BZERO_PRESENT
+#endif
+#elif defined(__FreeBSD__) || defined(__OpenBSD__)
+#define DOOBLE_EXPLICIT_BZERO_PRESENT
+#endif
+
+#ifdef DOOBLE_EXPLICIT_BZERO_PRESENT
+extern "C"
+{
+#include <string.h>
+#include <strings.h>
+}
+#endif
+
+#ifdef __SSE2__
+extern "C"
+{
+#include <emmintrin.h>
+}
+#endif
+
 #include "dooble_aes256.h"
+#include "dooble_aes256_gcm.h"
 #include "dooble_cryptography.h"
 #include "dooble_hmac.h"
+#include "dooble_instrumentation.h"
 #include "dooble_random.h"
 #include "dooble_threefish256.h"
 
 int dooble_cryptography::s_authentication_key_length = 64;
+int dooble_cryptography::s_batch_minimum_chunk_size = 16;
 int dooble_cryptography::s_encryption_key_length = 32;
+static const char s_aead_version = 1;
+
+static int aead_overhead(void)
+{
+  return 1 +
+    dooble_aes256_gcm::s_nonce_length +
+    dooble_aes256_gcm::s_tag_length;
+}
 
 dooble_cryptography::dooble_cryptography
 (const QByteArray &authentication_key,
@@ -76,6 +116,9 @@ dooble_cryptography::dooble_cryptography
 	    static_cast<size_t> (m_encryption_key.length()));
     }
 #endif
+
+  prepare_block_cipher();
+  prepare_hmac();
 }
 
 dooble_cryptography::dooble_cryptography(const QString &block_cipher_type,
@@ -99,6 +142,9 @@ dooble_cryptography::dooble_cryptography(const QString &block_cipher_type,
   mlock(m_encryption_key.constData(),
 	static_cast<size_t> (m_encryption_key.length()));
 #endif
+
+  prepare_block_cipher();
+  prepare_hmac();
 }
 
 dooble_cryptography::~dooble_cryptography()
@@ -118,25 +164,84 @@ QByteArray dooble_cryptography::encrypt_then_mac(const QByteArray &data) const
   if(m_as_plaintext)
     return data;
 
-  QByteArray bytes;
+  QElapsedTimer timer;
 
-  if(m_block_cipher_type == "aes-256")
-    {
-      dooble_aes256 aes(m_encryption_key);
+  timer.start();
 
-      bytes = aes.encrypt(data);
-    }
-  else
-    {
-      dooble_threefish256 threefish(m_encryption_key);
+  auto bytes(seal(data));
 
-      threefish.set_tweak("76543210fedcba98", nullptr);
-      bytes = threefish.encrypt(data);
+  dooble_instrumentation::record
+    (dooble_instrumentation::Cryptography::ENCRYPTION, data.length(), timer);
+  return bytes;
+}
+
+QByteArray dooble_cryptography::seal(const QByteArray &data) const
+{
+  auto aead(this->aead());
+
+  if(aead)
+    {
+      /*
+      ** The version, the nonce, the ciphertext, and the tag. The
+      ** version is authenticated.
+      */
+
+      auto nonce
+	(dooble_random::random_bytes(dooble_aes256_gcm::s_nonce_length));
+      auto size = 1 + nonce.length();
+
+      if(Q_UNLIKELY(nonce.length() != dooble_aes256_gcm::s_nonce_length))
+	return QByteArray();
+
+      QByteArray bytes
+	(size + data.length() + dooble_aes256_gcm::s_tag_length,
+	 Qt::Uninitialized);
+
+      bytes[0] = s_aead_version;
+      memcpy(bytes.data() + 1,
+	     nonce.constData(),
+	     static_cast<size_t> (nonce.length()));
+
+      auto b = bytes.data();
+
+      if(Q_UNLIKELY(!aead->seal_into(b + 1,
+				     b,
+				     1,
+				     data.constData(),
+				     data.length(),
+				     b + size,
+				     b + size + data.length())))
+	return QByteArray();
+
+      return bytes;
     }
 
-  if(!bytes.isEmpty())
-    bytes.prepend(hmac(bytes));
+  auto block_cipher(this->block_cipher());
+
+  if(Q_UNLIKELY(!block_cipher))
+    return QByteArray();
+
+  /*
+  ** The MAC precedes the ciphertext. Prepare a single container.
+  */
+
+  auto size = dooble_hmac::preferred_output_size_in_bytes();
+  QByteArray bytes
+    (size + block_cipher->ciphertext_length(data.length()), Qt::Uninitialized);
 
+  if(Q_UNLIKELY(!block_cipher->encrypt_into(data.constData(),
+					    data.length(),
+					    bytes.data() + size)))
+    return QByteArray();
+
+  auto mac
+    (hmac(QByteArray::fromRawData(bytes.constData() + size,
+				  bytes.length() - size)));
+
+  if(Q_UNLIKELY(mac.length() != size))
+    return QByteArray();
+
+  memcpy(bytes.data(), mac.constData(), static_cast<size_t> (size));
   return bytes;
 }
 
@@ -144,16 +249,13 @@ QByteArray dooble_cryptography::hmac(const QByteArray &message) const
 {
   if(m_as_plaintext)
     return message;
+
+  auto hmac(keyed_hmac());
+
+  if(Q_LIKELY(hmac))
+    return hmac->hmac(message);
   else
-    {
-      switch(m_hash_type)
-	{
-	case dooble_cryptography::HashTypes::KECCAK_512:
-	  return dooble_hmac::keccak_512_hmac(m_authentication_key, message);
-	default:
-	  return dooble_hmac::sha3_512_hmac(m_authentication_key, message);
-	}
-    }
+    return QByteArray();
 }
 
 QByteArray dooble_cryptography::hmac(const QString &message) const
@@ -161,57 +263,262 @@ QByteArray dooble_cryptography::hmac(const QString &message) const
   if(m_as_plaintext)
     return message.toUtf8();
   else
+    return hmac(message.toUtf8());
+}
+
+QByteArray dooble_cryptography::mac_then_decrypt(const QByteArray &data) const
+{
+  return mac_then_decrypt(data, nullptr);
+}
+
+QByteArray dooble_cryptography::mac_then_decrypt
+(const QByteArray &data, bool *ok) const
+{
+  /*
+  ** Data which is not authenticated is returned as it is. The
+  ** optional ok describes whether the data was authenticated.
+  */
+
+  if(m_as_plaintext)
     {
-      switch(m_hash_type)
+      if(ok)
+	*ok = true;
+
+      return data;
+    }
+
+  QElapsedTimer timer;
+  auto authenticated = false;
+
+  timer.start();
+
+  auto bytes(unseal(data, &authenticated));
+
+  if(!authenticated)
+    {
+      /*
+      ** Values which have not been re-encrypted yet were prepared by
+      ** the previous keys.
+      */
+
+      auto previous(this->previous());
+
+      if(previous)
 	{
-	case dooble_cryptography::HashTypes::KECCAK_512:
-	  return dooble_hmac::keccak_512_hmac
-	    (m_authentication_key, message.toUtf8());
-	default:
-	  return dooble_hmac::sha3_512_hmac
-	    (m_authentication_key, message.toUtf8());
+	  auto b(previous->mac_then_decrypt(data, &authenticated));
+
+	  if(authenticated)
+	    bytes = b;
 	}
     }
+
+  if(ok)
+    *ok = authenticated;
+
+  dooble_instrumentation::record
+    (dooble_instrumentation::Cryptography::DECRYPTION, data.length(), timer);
+  return bytes;
 }
 
-QByteArray dooble_cryptography::mac_then_decrypt(const QByteArray &data) const
+QByteArray dooble_cryptography::unseal(const QByteArray &data, bool *ok) const
 {
-  if(m_as_plaintext)
+  *ok = false;
+
+  auto aead(this->aead());
+
+  if(aead &&
+     data.length() >= aead_overhead() &&
+     data.at(0) == s_aead_version)
+    {
+      auto d = data.constData();
+      auto length = data.length() - aead_overhead();
+      auto size = 1 + dooble_aes256_gcm::s_nonce_length;
+      QByteArray plaintext(length, Qt::Uninitialized);
+
+      if(aead->open_into(d + 1,
+			 d,
+			 1,
+			 d + size,
+			 length,
+			 d + size + length,
+			 plaintext.data()))
+	{
+	  *ok = true;
+	  return plaintext;
+	}
+
+      /*
+      ** Perhaps a legacy container which begins with the version.
+      */
+    }
+
+  auto size = dooble_hmac::preferred_output_size_in_bytes();
+
+  if(Q_UNLIKELY(data.length() <= size))
     return data;
 
+  /*
+  ** Avoid copying the ciphertext.
+  */
+
   QByteArray computed_mac;
-  auto mac(data.mid(0, dooble_hmac::preferred_output_size_in_bytes()));
+  auto ciphertext
+    (QByteArray::fromRawData(data.constData() + size, data.length() - size));
+  auto mac(QByteArray::fromRawData(data.constData(), size));
 
-  computed_mac = hmac(data.mid(dooble_hmac::preferred_output_size_in_bytes()));
+  computed_mac = hmac(ciphertext);
 
-  if(!computed_mac.isEmpty() && !mac.isEmpty() &&
+  if(!computed_mac.isEmpty() &&
+     !mac.isEmpty() &&
      dooble_cryptography::memcmp(computed_mac, mac))
     {
-      if(m_block_cipher_type == "aes-256")
-	{
-	  dooble_aes256 aes(m_encryption_key);
+      auto block_cipher(this->block_cipher());
 
-	  return aes.decrypt
-	    (data.mid(dooble_hmac::preferred_output_size_in_bytes()));
-	}
-      else
+      if(Q_LIKELY(block_cipher))
 	{
-	  dooble_threefish256 threefish(m_encryption_key);
-
-	  threefish.set_tweak("76543210fedcba98", nullptr);
-	  return threefish.decrypt
-	    (data.mid(dooble_hmac::preferred_output_size_in_bytes()));
+	  *ok = true;
+	  return block_cipher->decrypt(ciphertext);
 	}
+      else
+	return QByteArray();
     }
 
   return data;
 }
 
+QSharedPointer<dooble_hmac> dooble_cryptography::keyed_hmac(void) const
+{
+  QReadLocker locker(&m_hmac_mutex);
+
+  return m_hmac;
+}
+
+QVector<QByteArray> dooble_cryptography::encrypt_then_mac_batch
+(const QVector<QByteArray> &data) const
+{
+  if(m_as_plaintext)
+    return data;
+
+  QVector<QByteArray> results(data.size());
+  auto r = results.data();
+
+  batch(static_cast<int> (data.size()),
+	[this, &data, r] (int i)
+	{
+	  r[i] = encrypt_then_mac(data.at(i));
+	});
+  return results;
+}
+
+QVector<QByteArray> dooble_cryptography::hmac_many
+(const QVector<QByteArray> &messages) const
+{
+  if(m_as_plaintext)
+    return messages;
+
+  auto hmac(keyed_hmac());
+
+  if(Q_LIKELY(hmac))
+    return hmac->hmac_many(messages);
+  else
+    return QVector<QByteArray> ();
+}
+
+QSharedPointer<dooble_aes256_gcm> dooble_cryptography::aead(void) const
+{
+  QReadLocker locker(&m_block_cipher_mutex);
+
+  return m_aead;
+}
+
+QSharedPointer<dooble_block_cipher> dooble_cryptography::block_cipher
+(void) const
+{
+  QReadLocker locker(&m_block_cipher_mutex);
+
+  return m_block_cipher;
+}
+
+QSharedPointer<dooble_cryptography> dooble_cryptography::previous(void) const
+{
+  QReadLocker locker(&m_previous_mutex);
+
+  return m_previous;
+}
+
+QVector<QByteArray> dooble_cryptography::mac_then_decrypt_batch
+(const QVector<QByteArray> &data) const
+{
+  return mac_then_decrypt_batch(data, nullptr);
+}
+
+QVector<QByteArray> dooble_cryptography::mac_then_decrypt_batch
+(const QVector<QByteArray> &data, QVector<bool> *ok) const
+{
+  if(ok)
+    ok->fill(true, data.size());
+
+  if(m_as_plaintext)
+    return data;
+
+  QVector<QByteArray> results(data.size());
+  auto o = ok ? ok->data() : nullptr;
+  auto r = results.data();
+
+  batch(static_cast<int> (data.size()),
+	[this, &data, o, r] (int i)
+	{
+	  r[i] = mac_then_decrypt(data.at(i), o ? &o[i] : nullptr);
+	});
+  return results;
+}
+
+QByteArray dooble_cryptography::memoized_hmac(const QByteArray &message) const
+{
+  /*
+  ** Reserved for constant messages such as "true" and "favorite".
+  */
+
+  if(m_as_plaintext)
+    return message;
+
+  {
+    QReadLocker locker(&m_hmac_mutex);
+    auto it = m_memoized_hmacs.constFind(message);
+
+    if(it != m_memoized_hmacs.constEnd())
+      return it.value();
+  }
+
+  QWriteLocker locker(&m_hmac_mutex);
+
+  if(Q_UNLIKELY(!m_hmac))
+    return QByteArray();
+
+  auto bytes(m_hmac->hmac(message));
+
+  m_memoized_hmacs[message] = bytes;
+  return bytes;
+}
+
 QPair<QByteArray, QByteArray> dooble_cryptography::keys(void) const
 {
   return QPair<QByteArray, QByteArray> (m_authentication_key, m_encryption_key);
 }
 
+QString dooble_cryptography::block_cipher_type(void) const
+{
+  return m_block_cipher_type;
+}
+
+QString dooble_cryptography::hash_type(void) const
+{
+  if(m_hash_type == dooble_cryptography::HashTypes::KECCAK_512)
+    return "keccak-512";
+  else
+    return "sha3-512";
+}
+
 bool dooble_cryptography::as_plaintext(void) const
 {
   return m_as_plaintext;
@@ -222,18 +529,78 @@ bool dooble_cryptography::authenticated(void) const
   return m_authenticated;
 }
 
+bool dooble_cryptography::needs_rewrite(const QByteArray &data) const
+{
+  /*
+  ** True if the authenticated data was not prepared by the selected
+  ** AEAD mode. Such data should be encrypted again and stored.
+  */
+
+  if(m_as_plaintext || !aead())
+    return false;
+
+  return data.length() < aead_overhead() || data.at(0) != s_aead_version;
+}
+
 bool dooble_cryptography::memcmp(const QByteArray &a, const QByteArray &b)
 {
-  QByteArray c1;
-  QByteArray c2;
-  auto length = qMax(a.length(), b.length());
+  return memcmp(a.constData(), a.length(), b.constData(), b.length());
+}
+
+bool dooble_cryptography::memcmp(const char *a,
+				 const int a_length,
+				 const char *b,
+				 const int b_length)
+{
+  /*
+  ** The duration depends upon the lengths only. The shorter array is
+  ** treated as if it were padded with zeros.
+  */
+
+  if(Q_UNLIKELY(a_length < 0 || b_length < 0))
+    return false;
+  else if(Q_UNLIKELY((!a && a_length > 0) || (!b && b_length > 0)))
+    return false;
+
+  auto length = qMin(a_length, b_length);
+  int i = 0;
   quint64 rc = 0;
 
-  c1 = a.leftJustified(length, 0);
-  c2 = b.leftJustified(length, 0);
+#ifdef __SSE2__
+  auto r = _mm_setzero_si128();
 
-  for(int i = 0; i < length; i++)
-    rc |= static_cast<quint64> (c1[i]) ^ static_cast<quint64> (c2[i]);
+  for(; i + 16 <= length; i += 16)
+    {
+      auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *> (a + i));
+      auto y = _mm_loadu_si128(reinterpret_cast<const __m128i *> (b + i));
+
+      r = _mm_or_si128(r, _mm_xor_si128(x, y));
+    }
+
+  quint64 words[2];
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *> (words), r);
+  rc = words[0] | words[1];
+#endif
+
+  for(; i + 8 <= length; i += 8)
+    {
+      quint64 x = 0;
+      quint64 y = 0;
+
+      ::memcpy(&x, a + i, sizeof(x));
+      ::memcpy(&y, b + i, sizeof(y));
+      rc |= x ^ y;
+    }
+
+  for(; i < length; i++)
+    rc |= static_cast<quint64> (static_cast<uchar> (a[i] ^ b[i]));
+
+  for(i = length; i < a_length; i++)
+    rc |= static_cast<quint64> (static_cast<uchar> (a[i]));
+
+  for(i = length; i < b_length; i++)
+    rc |= static_cast<quint64> (static_cast<uchar> (b[i]));
 
   return rc == 0;
 }
@@ -263,16 +630,148 @@ void dooble_cryptography::authenticate(const QByteArray &salt,
   m_authenticated = dooble_cryptography::memcmp(hash, salted_password);
 }
 
+void dooble_cryptography::batch
+(int size, const std::function<void (int)> &function) const
+{
+  /*
+  ** The entries are divided into contiguous chunks. The first chunk is
+  ** processed by the calling thread. Every entry is written to its own
+  ** position, so the order is preserved. Each result is exactly what
+  ** the individual method would have returned for its entry.
+  */
+
+  if(size <= 0)
+    return;
+
+  auto chunk_size = qMax
+    (s_batch_minimum_chunk_size,
+     qCeil(static_cast<double> (size) /
+	   static_cast<double> (qMax(1, QThreadPool::globalInstance()->
+				     maxThreadCount()))));
+  QList<QFuture<void> > futures;
+
+  for(int i = chunk_size; i < size; i += chunk_size)
+    futures << QtConcurrent::run
+      ([chunk_size, &function, i, size] (void)
+       {
+	 for(int j = i; j < qMin(i + chunk_size, size); j++)
+	   function(j);
+       });
+
+  for(int i = 0; i < qMin(chunk_size, size); i++)
+    function(i);
+
+  for(auto &future : futures)
+    future.waitForFinished();
+}
+
 void dooble_cryptography::memzero(QByteArray &bytes)
 {
-  for(auto &&byte : bytes)
-    byte = 0;
+  /*
+  ** A shared array is not detached, the copy would not be wiped.
+  ** Release the reference instead. The remaining owners are
+  ** responsible for the data.
+  */
+
+  if(bytes.isEmpty())
+    return;
+  else if(bytes.isDetached())
+    memzero(bytes.data(), static_cast<size_t> (bytes.length()));
+  else
+    bytes.clear();
 }
 
 void dooble_cryptography::memzero(QString &text)
 {
-  for(auto &&i : text)
-    i = QChar(0);
+  if(text.isEmpty())
+    return;
+  else if(text.isDetached())
+    memzero(text.data(), sizeof(QChar) * static_cast<size_t> (text.length()));
+  else
+    text.clear();
+}
+
+void dooble_cryptography::memzero(void *data, const size_t size)
+{
+  if(Q_UNLIKELY(!data || size == 0))
+    return;
+
+#ifdef DOOBLE_EXPLICIT_BZERO_PRESENT
+  explicit_bzero(data, size);
+#else
+  auto d = static_cast<volatile char *> (data);
+
+  for(size_t i = 0; i < size; i++)
+    d[i] = 0;
+#endif
+}
+
+void dooble_cryptography::prepare_block_cipher(void)
+{
+  /*
+  ** The key schedule is prepared once per key. The block cipher's
+  ** methods are constant, so the object may be shared by all threads.
+  ** Threads which hold the previous object release it when they're done.
+  */
+
+  QSharedPointer<dooble_aes256_gcm> aead;
+  QSharedPointer<dooble_block_cipher> block_cipher;
+
+  if(!m_as_plaintext)
+    {
+      if(m_block_cipher_type == "aes-256")
+	block_cipher.reset(new dooble_aes256(m_encryption_key));
+      else if(m_block_cipher_type == "aes-256-gcm")
+	{
+	  /*
+	  ** Legacy CBC containers are read with the same key schedule.
+	  */
+
+	  aead.reset(new dooble_aes256_gcm(m_encryption_key));
+	  block_cipher = aead;
+	}
+      else
+	{
+	  auto threefish = new dooble_threefish256(m_encryption_key);
+
+	  threefish->set_tweak("76543210fedcba98", nullptr);
+	  block_cipher.reset(threefish);
+	}
+    }
+
+  QWriteLocker locker(&m_block_cipher_mutex);
+
+  m_aead.swap(aead);
+  m_block_cipher.swap(block_cipher);
+}
+
+void dooble_cryptography::prepare_hmac(void)
+{
+  QSharedPointer<dooble_hmac> hmac;
+
+  if(!m_as_plaintext)
+    switch(m_hash_type)
+      {
+      case dooble_cryptography::HashTypes::KECCAK_512:
+	{
+	  hmac.reset
+	    (new dooble_hmac(m_authentication_key,
+			     dooble_hmac::Algorithms::KECCAK_512));
+	  break;
+	}
+      default:
+	{
+	  hmac.reset
+	    (new dooble_hmac(m_authentication_key,
+			     dooble_hmac::Algorithms::SHA3_512));
+	  break;
+	}
+      }
+
+  QWriteLocker locker(&m_hmac_mutex);
+
+  m_hmac.swap(hmac);
+  m_memoized_hmacs.clear();
 }
 
 void dooble_cryptography::set_authenticated(bool state)
@@ -283,15 +782,27 @@ void dooble_cryptography::set_authenticated(bool state)
 void dooble_cryptography::set_block_cipher_type
 (const QString &block_cipher_type_index)
 {
-  m_block_cipher_type = block_cipher_type_index.toLower().trimmed();
+  auto block_cipher_type(block_cipher_type_index.toLower().trimmed());
+
+  if(block_cipher_type != m_block_cipher_type)
+    {
+      m_block_cipher_type = block_cipher_type;
+      prepare_block_cipher();
+    }
 }
 
 void dooble_cryptography::set_hash_type(const QString &hash_type)
 {
+  auto hash_type_index = dooble_cryptography::HashTypes::SHA3_512;
+
   if(hash_type.toLower().trimmed() == "keccak-512")
-    m_hash_type = dooble_cryptography::HashTypes::KECCAK_512;
-  else
-    m_hash_type = dooble_cryptography::HashTypes::SHA3_512;
+    hash_type_index = dooble_cryptography::HashTypes::KECCAK_512;
+
+  if(hash_type_index != m_hash_type)
+    {
+      m_hash_type = hash_type_index;
+      prepare_hmac();
+    }
 }
 
 void dooble_cryptography::set_keys(const QByteArray &authentication_key,
@@ -323,4 +834,125 @@ void dooble_cryptography::set_keys(const QByteArray &authentication_key,
 	    static_cast<size_t> (m_encryption_key.length()));
 #endif
     }
+
+  prepare_block_cipher();
+  prepare_hmac();
+}
+
+void dooble_cryptography::set_previous
+(const QSharedPointer<dooble_cryptography> &previous)
+{
+  /*
+  ** The previous keys decrypt the values which were prepared before
+  ** the keys were replaced. See dooble_database_rekey.
+  */
+
+  QWriteLocker locker(&m_previous_mutex);
+
+  m_previous = previous;
+}
+
+void dooble_cryptography::test1(void)
+{
+  auto memcmp_ok = true;
+
+  for(int i = 0; i < 100; i++)
+    {
+      auto a(dooble_random::random_bytes(i));
+      auto b(a);
+
+      b.detach();
+      memcmp_ok &= memcmp(a, b);
+      memcmp_ok &= memcmp(a, b + QByteArray(i % 5, 0));
+
+      if(i > 0)
+	{
+	  b[i / 2] = static_cast<char> (b.at(i / 2) ^ 1);
+	  memcmp_ok &= !memcmp(a, b);
+	  memcmp_ok &= !memcmp(a.constData(), i, b.constData(), i);
+	  memcmp_ok &= !memcmp(a, a + QByteArray(1, 1));
+	}
+    }
+
+  memcmp_ok &= memcmp(QByteArray(), QByteArray());
+  memcmp_ok &= !memcmp(nullptr, 1, nullptr, 1);
+
+  auto memzero_ok = true;
+  auto bytes(dooble_random::random_bytes(64) + QByteArray(1, 1));
+  auto data = bytes.constData();
+
+  memzero(bytes);
+  memzero_ok &= bytes.constData() == data && bytes.count('\0') == 65;
+
+  auto shared(dooble_random::random_bytes(64) + QByteArray(1, 1));
+  auto copy(shared);
+
+  memzero(shared);
+  memzero_ok &= shared.isEmpty() && copy.count('\0') < copy.length();
+
+  /*
+  ** AES-256-GCM must read its own containers and legacy CBC containers.
+  */
+
+  auto aead_ok = true;
+  auto authentication_key(dooble_random::random_bytes(64));
+  auto encryption_key(dooble_random::random_bytes(32));
+  dooble_cryptography aes256
+    (authentication_key, encryption_key, "AES-256", "SHA3-512");
+  dooble_cryptography aes256_gcm
+    (authentication_key, encryption_key, "AES-256-GCM", "SHA3-512");
+
+  for(int i = 0; i < 100; i++)
+    {
+      auto data(dooble_random::random_bytes(i + 1));
+      auto legacy(aes256.encrypt_then_mac(data));
+      auto sealed(aes256_gcm.encrypt_then_mac(data));
+
+      aead_ok &= aes256_gcm.mac_then_decrypt(legacy) == data;
+      aead_ok &= aes256_gcm.mac_then_decrypt(sealed) == data;
+      aead_ok &= aes256_gcm.needs_rewrite(legacy) ==
+	(legacy.at(0) != sealed.at(0));
+      aead_ok &= !aes256_gcm.needs_rewrite(sealed);
+      aead_ok &= !aes256.needs_rewrite(legacy);
+      sealed[i % sealed.length()] = static_cast<char>
+	(sealed.at(i % sealed.length()) ^ 1);
+      aead_ok &= aes256_gcm.mac_then_decrypt(sealed) != data;
+    }
+
+  /*
+  ** Values which were prepared by the previous keys must be
+  ** authenticated by them. Other values must not be.
+  */
+
+  auto previous_ok = true;
+  dooble_cryptography current
+    (dooble_random::random_bytes(64),
+     dooble_random::random_bytes(32),
+     "AES-256-GCM",
+     "SHA3-512");
+  QSharedPointer<dooble_cryptography> previous
+    (new dooble_cryptography(authentication_key,
+			     encryption_key,
+			     "AES-256",
+			     "SHA3-512"));
+
+  current.set_previous(previous);
+
+  for(int i = 0; i < 100; i++)
+    {
+      auto data(dooble_random::random_bytes(i + 1));
+      auto ok = false;
+
+      previous_ok &= current.mac_then_decrypt
+	(previous->encrypt_then_mac(data), &ok) == data && ok;
+      previous_ok &= current.mac_then_decrypt
+	(current.encrypt_then_mac(data), &ok) == data && ok;
+      current.mac_then_decrypt(data, &ok);
+      previous_ok &= !ok;
+    }
+
+  qDebug() << "memcmp()" << memcmp_ok
+	   << "memzero()" << memzero_ok
+	   << "AES-256-GCM" << aead_ok
+	   << "Previous keys" << previous_ok;
 }
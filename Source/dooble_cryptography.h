@@ -29,8 +29,18 @@
 #define dooble_cryptography_h
 
 #include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QPair>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <functional>
+
+class dooble_aes256_gcm;
+class dooble_block_cipher;
+class dooble_hmac;
 
 class dooble_cryptography: public QObject
 {
@@ -44,6 +54,7 @@ class dooble_cryptography: public QObject
     };
 
   static int s_authentication_key_length;
+  static int s_batch_minimum_chunk_size;
   static int s_encryption_key_length;
   dooble_cryptography(const QByteArray &authentication_key,
 		      const QByteArray &encryption_key,
@@ -56,12 +67,30 @@ class dooble_cryptography: public QObject
   QByteArray hmac(const QByteArray &message) const;
   QByteArray hmac(const QString &message) const;
   QByteArray mac_then_decrypt(const QByteArray &data) const;
+  QByteArray mac_then_decrypt(const QByteArray &data, bool *ok) const;
+  QByteArray memoized_hmac(const QByteArray &message) const;
   QPair<QByteArray, QByteArray> keys(void) const;
+  QString block_cipher_type(void) const;
+  QString hash_type(void) const;
+  QVector<QByteArray> encrypt_then_mac_batch
+    (const QVector<QByteArray> &data) const;
+  QVector<QByteArray> hmac_many(const QVector<QByteArray> &messages) const;
+  QVector<QByteArray> mac_then_decrypt_batch
+    (const QVector<QByteArray> &data) const;
+  QVector<QByteArray> mac_then_decrypt_batch
+    (const QVector<QByteArray> &data, QVector<bool> *ok) const;
   bool as_plaintext(void) const;
   bool authenticated(void) const;
+  bool needs_rewrite(const QByteArray &data) const;
   static bool memcmp(const QByteArray &a, const QByteArray &b);
+  static bool memcmp(const char *a,
+		     const int a_length,
+		     const char *b,
+		     const int b_length);
   static void memzero(QByteArray &bytes);
   static void memzero(QString &text);
+  static void memzero(void *data, const size_t size);
+  static void test1(void);
   void authenticate(const QByteArray &salt,
 		    const QByteArray &salted_password,
 		    const QString &password);
@@ -70,14 +99,32 @@ class dooble_cryptography: public QObject
   void set_hash_type(const QString &hash_type);
   void set_keys(const QByteArray &authentication_key,
 		const QByteArray &encryption_key);
+  void set_previous(const QSharedPointer<dooble_cryptography> &previous);
 
  private:
   QByteArray m_authentication_key;
   QByteArray m_encryption_key;
+  QSharedPointer<dooble_aes256_gcm> m_aead;
+  QSharedPointer<dooble_block_cipher> m_block_cipher;
+  QSharedPointer<dooble_cryptography> m_previous;
+  QSharedPointer<dooble_hmac> m_hmac;
   QString m_block_cipher_type;
   bool m_as_plaintext;
   bool m_authenticated;
   dooble_cryptography::HashTypes m_hash_type;
+  mutable QHash<QByteArray, QByteArray> m_memoized_hmacs;
+  mutable QReadWriteLock m_block_cipher_mutex;
+  mutable QReadWriteLock m_hmac_mutex;
+  mutable QReadWriteLock m_previous_mutex;
+  QByteArray seal(const QByteArray &data) const;
+  QByteArray unseal(const QByteArray &data, bool *ok) const;
+  QSharedPointer<dooble_aes256_gcm> aead(void) const;
+  QSharedPointer<dooble_block_cipher> block_cipher(void) const;
+  QSharedPointer<dooble_cryptography> previous(void) const;
+  QSharedPointer<dooble_hmac> keyed_hmac(void) const;
+  void batch(int size, const std::function<void (int)> &function) const;
+  void prepare_block_cipher(void);
+  void prepare_hmac(void);
 };
 
 #endif
@@ -0,0 +1,765 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QNetworkCookie>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include <limits>
+
+#include "dooble_cookies.h"
+#include "dooble_cryptography.h"
+#include "dooble_database_rekey.h"
+#include "dooble_database_utilities.h"
+#include "dooble_history.h"
+#include "dooble_random.h"
+
+typedef QByteArray (*dooble_database_rekey_message)
+  (const QHash<QString, QByteArray> &values);
+
+struct dooble_database_rekey_digest
+{
+  /*
+  ** The message of a digest is either the value of an encrypted
+  ** column, a function of the values of the encrypted columns, or
+  ** one of a few constants.
+  */
+
+  QList<QByteArray> m_constants;
+  QString m_column;
+  QString m_source;
+  bool m_binary;
+  dooble_database_rekey_message m_message;
+};
+
+struct dooble_database_rekey_table
+{
+  QList<dooble_database_rekey_digest> m_digests;
+  QString m_file_name;
+  QString m_table;
+  QStringList m_columns;
+};
+
+static QByteArray cookie_domain_message
+(const QHash<QString, QByteArray> &values)
+{
+  return QNetworkCookie::parseCookies(values.value("raw_form")).value(0).
+    domain().toUtf8();
+}
+
+static QByteArray cookie_identifier_message
+(const QHash<QString, QByteArray> &values)
+{
+  auto list(QNetworkCookie::parseCookies(values.value("raw_form")));
+
+  if(list.isEmpty())
+    return QByteArray();
+  else
+    return dooble_cookies::identifier(list.at(0));
+}
+
+static QByteArray day_message(const QHash<QString, QByteArray> &values)
+{
+  auto date_time
+    (QDateTime::fromString(QString::fromUtf8(values.value("last_visited")),
+			   Qt::ISODate));
+
+  if(date_time.isValid())
+    return dooble_history::day_message(date_time.date());
+  else
+    return QByteArray();
+}
+
+static QByteArray decode(const QVariant &value, bool binary)
+{
+  if(binary)
+    return dooble_database_utilities::blob(value);
+  else
+    return QByteArray::fromBase64(value.toByteArray());
+}
+
+static QVariant encode(const QByteArray &bytes,
+		       const QVariant &value,
+		       bool binary)
+{
+  /*
+  ** The storage class of a value is retained so that older values
+  ** remain recognizable by migrate_blobs().
+  */
+
+  if(value.isNull())
+    return value;
+  else if(binary && value.userType() == QMetaType::QByteArray)
+    return bytes;
+  else if(binary)
+    return QString::fromLatin1(bytes.toBase64());
+  else
+    return bytes.toBase64();
+}
+
+static dooble_database_rekey_digest digest
+(const QString &column, const QList<QByteArray> &constants)
+{
+  dooble_database_rekey_digest digest;
+
+  digest.m_binary = false;
+  digest.m_column = column;
+  digest.m_constants = constants;
+  digest.m_message = nullptr;
+  return digest;
+}
+
+static dooble_database_rekey_digest digest
+(const QString &column, const QString &source)
+{
+  dooble_database_rekey_digest digest;
+
+  digest.m_binary = false;
+  digest.m_column = column;
+  digest.m_message = nullptr;
+  digest.m_source = source;
+  return digest;
+}
+
+static dooble_database_rekey_digest digest
+(const QString &column,
+ dooble_database_rekey_message message,
+ bool binary = false)
+{
+  /*
+  ** Binary digests are stored as raw BLOBs, independent of
+  ** dooble_database_utilities::blob_columns().
+  */
+
+  dooble_database_rekey_digest digest;
+
+  digest.m_binary = binary;
+  digest.m_column = column;
+  digest.m_message = message;
+  return digest;
+}
+
+static dooble_database_rekey_table table
+(const QString &file_name,
+ const QString &table,
+ const QStringList &columns,
+ const QList<dooble_database_rekey_digest> &digests)
+{
+  dooble_database_rekey_table t;
+
+  t.m_columns = columns;
+  t.m_digests = digests;
+  t.m_file_name = file_name;
+  t.m_table = table;
+  return t;
+}
+
+static QMap<QString, dooble_database_rekey_table> prepare_descriptions(void)
+{
+  /*
+  ** The encrypted columns of every table and the messages of their
+  ** digests. The messages of the favicon digests are not stored,
+  ** so favicons are removed instead.
+  */
+
+  QList<dooble_database_rekey_table> list;
+  QMap<QString, dooble_database_rekey_table> map;
+
+  list << table("dooble_accepted_or_blocked_domains.db",
+		"dooble_accepted_or_blocked_domains",
+		QStringList() << "domain" << "state",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("domain_digest", QString("domain")))
+       << table("dooble_accepted_or_blocked_domains.db",
+		"dooble_accepted_or_blocked_domains_exceptions",
+		QStringList() << "state" << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("url_digest", QString("url")))
+       << table("dooble_certificate_exceptions.db",
+		"dooble_certificate_exceptions",
+		QStringList() << "error" << "exception_accepted" << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("url_digest", QString("url")))
+       << table("dooble_cookies.db",
+		"dooble_cookies_domains",
+		QStringList() << "domain",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("domain_digest", QString("domain"))
+		<< digest("favorite_digest",
+			  QList<QByteArray> () << "blocked"
+			                       << "favorite"
+			                       << "xyz"))
+       << table("dooble_cookies.db",
+		"dooble_cookies",
+		QStringList() << "raw_form",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("domain_digest", &cookie_domain_message)
+		<< digest("identifier_digest", &cookie_identifier_message))
+       << table("dooble_downloads.db",
+		"dooble_downloads",
+		QStringList() << "download_path"
+		              << "file_name"
+		              << "information"
+		              << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("url_digest", QString("url")))
+       << table("dooble_favicons.db",
+		"dooble_favicons",
+		QStringList(),
+		QList<dooble_database_rekey_digest> ())
+       << table("dooble_history.db",
+		"dooble_history",
+		QStringList() << "last_visited"
+		              << "number_of_visits"
+		              << "title"
+		              << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("day_digest", &day_message, true)
+		<< digest("favorite_digest",
+			  QList<QByteArray> () << "false" << "true")
+		<< digest("url_digest", QString("url")))
+       << table("dooble_search_engines.db",
+		"dooble_search_engines",
+		QStringList() << "default_address_bar_engine"
+		              << "title"
+		              << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("url_digest", QString("url")))
+       << table("dooble_settings.db",
+		"dooble_features_permissions",
+		QStringList() << "feature" << "permission" << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("feature_digest", QString("feature"))
+		<< digest("url_digest", QString("url")))
+       << table("dooble_settings.db",
+		"dooble_javascript_block_popup_exceptions",
+		QStringList() << "state" << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("url_digest", QString("url")))
+       << table("dooble_style_sheets.db",
+		"dooble_style_sheets",
+		QStringList() << "name" << "style_sheet" << "url",
+		QList<dooble_database_rekey_digest> ()
+		<< digest("name_digest", QString("name"))
+		<< digest("url_digest", QString("url")));
+
+  foreach(const auto &i, list)
+    map[i.m_file_name + "/" + i.m_table] = i;
+
+  return map;
+}
+
+static QMap<QString, dooble_database_rekey_table> descriptions(void)
+{
+  static auto map(prepare_descriptions());
+
+  return map;
+}
+
+static QByteArray journal_digest(const dooble_database_rekey_table &description,
+				 const dooble_cryptography &current)
+{
+  return current.hmac("rekey/" + description.m_table.toUtf8()).toBase64();
+}
+
+static bool journal(const QSqlDatabase &db,
+		    const dooble_database_rekey_table &description,
+		    const dooble_cryptography &current)
+{
+  /*
+  ** Records the table in its own database so that the record is
+  ** committed with the table's values.
+  */
+
+  QSqlQuery query(db);
+
+  query.prepare("INSERT OR REPLACE INTO dooble_database_rekey "
+		"(digest, name) VALUES (?, ?)");
+  query.addBindValue(journal_digest(description, current));
+  query.addBindValue(description.m_table);
+  return dooble_database_utilities::exec(db, &query);
+}
+
+static bool journaled(const QSqlDatabase &db,
+		      const dooble_database_rekey_table &description,
+		      const dooble_cryptography &current)
+{
+  /*
+  ** Has the table been re-encrypted by the current keys?
+  */
+
+  QSqlQuery query(db);
+
+  query.exec("CREATE TABLE IF NOT EXISTS dooble_database_rekey ("
+	     "digest TEXT NOT NULL, "
+	     "name TEXT PRIMARY KEY NOT NULL)");
+  query.prepare("SELECT digest FROM dooble_database_rekey WHERE name = ?");
+  query.addBindValue(description.m_table);
+
+  if(dooble_database_utilities::exec(db, &query) && query.next())
+    return dooble_cryptography::memcmp
+      (journal_digest(description, current), query.value(0).toByteArray());
+  else
+    return false;
+}
+
+static bool rekey_rows(const QSqlDatabase &db,
+		       const dooble_database_rekey_table &description,
+		       const QStringList &binary,
+		       const dooble_cryptography &previous,
+		       const dooble_cryptography &current,
+		       const QAtomicInteger<short> &interrupt,
+		       int rows)
+{
+  if(description.m_columns.isEmpty())
+    {
+      QSqlQuery query(db);
+
+      return dooble_database_utilities::exec
+	(db, query, QString("DELETE FROM %1").arg(description.m_table));
+    }
+
+  QSqlQuery query(db);
+  QSqlQuery update_query(db);
+  QStringList assignments;
+  auto columns(description.m_columns);
+  auto oid = std::numeric_limits<qint64>::min();
+  auto size = description.m_columns.size();
+
+  foreach(const auto &digest, description.m_digests)
+    columns << digest.m_column;
+
+  foreach(const auto &column, columns)
+    assignments << QString("%1 = ?").arg(column);
+
+  query.setForwardOnly(true);
+
+  if(!query.prepare(QString("SELECT OID, %1 FROM %2 WHERE OID > ? "
+			    "ORDER BY OID LIMIT %3").
+		    arg(columns.join(", ")).
+		    arg(description.m_table).
+		    arg(rows)) ||
+     !update_query.prepare(QString("UPDATE OR IGNORE %1 SET %2 "
+				   "WHERE OID = ?").
+			   arg(description.m_table).
+			   arg(assignments.join(", "))))
+    return false;
+
+  while(!interrupt.loadAcquire())
+    {
+      QList<QVariantList> values;
+
+      query.bindValue(0, oid);
+
+      if(!dooble_database_utilities::exec(db, &query))
+	return false;
+
+      while(query.next())
+	{
+	  QVariantList list;
+
+	  for(int i = 0; i <= columns.size(); i++)
+	    list << query.value(i);
+
+	  values << list;
+	}
+
+      if(values.isEmpty())
+	return true;
+
+      oid = values.last().value(0).toLongLong();
+
+      /*
+      ** The values of a chunk are decrypted together.
+      */
+
+      QVector<QByteArray> data;
+
+      foreach(const auto &list, values)
+	for(int i = 0; i < size; i++)
+	  data << decode
+	    (list.at(i + 1), binary.contains(description.m_columns.at(i)));
+
+      QVector<bool> authenticated;
+      auto plaintexts(previous.mac_then_decrypt_batch(data, &authenticated));
+
+      if(authenticated.size() != data.size() ||
+	 plaintexts.size() != data.size())
+	return false;
+
+      if(previous.as_plaintext())
+	{
+	  /*
+	  ** Every value is plaintext to the previous keys. Values which
+	  ** the current keys authenticate were written in the meantime.
+	  */
+
+	  QVector<bool> current_authenticated;
+
+	  current.mac_then_decrypt_batch(data, &current_authenticated);
+
+	  for(int i = 0; i < current_authenticated.size(); i++)
+	    if(current_authenticated.at(i))
+	      authenticated[i] = false;
+	}
+
+      QList<int> indexes;
+      QList<qint64> removed;
+      QVector<QByteArray> messages;
+      QVector<QByteArray> values_to_encrypt;
+
+      for(int i = 0; i < values.size(); i++)
+	{
+	  QByteArray ciphertext;
+	  QHash<QString, QByteArray> hash;
+	  auto decrypted = true;
+	  auto offset = i * size;
+
+	  for(int j = 0; j < size; j++)
+	    {
+	      if(data.at(offset + j).isEmpty())
+		continue;
+	      else if(!authenticated.at(offset + j))
+		{
+		  ciphertext = data.at(offset + j);
+		  decrypted = false;
+		  break;
+		}
+
+	      hash[description.m_columns.at(j)] = plaintexts.at(offset + j);
+	    }
+
+	  if(!decrypted)
+	    {
+	      /*
+	      ** A value which the current keys authenticate was prepared
+	      ** earlier or in the meantime.
+	      */
+
+	      auto ok = false;
+
+	      current.mac_then_decrypt(ciphertext, &ok);
+
+	      if(!ok)
+		removed << values.at(i).at(0).toLongLong();
+
+	      continue;
+	    }
+
+	  QVector<QByteArray> list;
+
+	  for(int j = 0; j < description.m_digests.size(); j++)
+	    {
+	      QByteArray message;
+	      const auto &digest(description.m_digests.at(j));
+	      const auto &value(values.at(i).at(size + j + 1));
+
+	      if(value.isNull())
+		{
+		  list << QByteArray();
+		  continue;
+		}
+	      else if(!digest.m_source.isEmpty())
+		message = hash.value(digest.m_source);
+	      else if(digest.m_message)
+		message = digest.m_message(hash);
+	      else
+		{
+		  auto bytes
+		    (decode(value, binary.contains(digest.m_column)));
+
+		  foreach(const auto &constant, digest.m_constants)
+		    if(dooble_cryptography::
+		       memcmp(bytes, previous.memoized_hmac(constant)))
+		      {
+			message = constant;
+			break;
+		      }
+		}
+
+	      if(message.isEmpty())
+		{
+		  decrypted = false;
+		  break;
+		}
+
+	      list << message;
+	    }
+
+	  if(!decrypted)
+	    {
+	      removed << values.at(i).at(0).toLongLong();
+	      continue;
+	    }
+
+	  indexes << i;
+	  messages << list;
+	  values_to_encrypt << plaintexts.mid(offset, size);
+	}
+
+      /*
+      ** The digests and the values are prepared together.
+      */
+
+      auto ciphertexts(current.encrypt_then_mac_batch(values_to_encrypt));
+      auto digests(current.hmac_many(messages));
+
+      if(ciphertexts.size() != values_to_encrypt.size() ||
+	 digests.size() != messages.size())
+	return false;
+
+      for(int i = 0; i < indexes.size(); i++)
+	{
+	  const auto &list(values.at(indexes.at(i)));
+
+	  for(int j = 0; j < size; j++)
+	    update_query.bindValue
+	      (j,
+	       encode(ciphertexts.at(i * size + j),
+		      list.at(j + 1),
+		      binary.contains(description.m_columns.at(j))));
+
+	  for(int j = 0; j < description.m_digests.size(); j++)
+	    update_query.bindValue
+	      (size + j,
+	       encode(digests.at(i * description.m_digests.size() + j),
+		      list.at(size + j + 1),
+		      binary.contains(description.m_digests.at(j).m_column)));
+
+	  update_query.bindValue(columns.size(), list.at(0));
+
+	  if(!dooble_database_utilities::exec(db, &update_query))
+	    return false;
+
+	  if(update_query.numRowsAffected() == 0)
+	    removed << list.at(0).toLongLong();
+	}
+
+      foreach(auto i, removed)
+	dooble_database_utilities::remove_entry(db, description.m_table, i);
+    }
+
+  return false;
+}
+
+QStringList dooble_database_rekey::tables(void)
+{
+  return descriptions().keys();
+}
+
+bool dooble_database_rekey::rekey(const QString &home_path,
+				  const QString &table,
+				  const dooble_cryptography &previous,
+				  const dooble_cryptography &current,
+				  const QAtomicInteger<short> &interrupt,
+				  int rows)
+{
+  /*
+  ** Re-encrypts a table in a single transaction. The rows are read
+  ** in chunks of at most the specified number of rows whose values
+  ** are decrypted, digested and encrypted in parallel. Values which
+  ** the previous keys do not authenticate remain if the current keys
+  ** authenticate them and are removed otherwise, as are rows whose
+  ** new digests collide with newer rows. A journal entry is committed
+  ** with the table, so the current keys visit a table once. Returns
+  ** true if the table was committed or does not exist.
+  */
+
+  auto map(descriptions());
+
+  if(!map.contains(table))
+    return false;
+
+  auto description(map.value(table));
+  auto file_name(home_path + QDir::separator() + description.m_file_name);
+
+  if(!QFileInfo(file_name).exists())
+    return true;
+
+  QStringList binary;
+
+  foreach(const auto &i, dooble_database_utilities::blob_columns(file_name))
+    if(i.value(0) == description.m_table)
+      binary = i.mid(1);
+
+  foreach(const auto &digest, description.m_digests)
+    if(digest.m_binary)
+      binary << digest.m_column;
+
+  auto database_name(dooble_database_utilities::database_name());
+  auto ok = false;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(dooble_database_utilities::open(db))
+      {
+	if(!db.tables().contains(description.m_table))
+	  ok = true;
+	else if(db.transaction())
+	  {
+	    if(journaled(db, description, current))
+	      ok = true;
+	    else
+	      ok = rekey_rows
+		(db, description, binary, previous, current, interrupt, rows) &&
+		journal(db, description, current);
+
+	    if(ok)
+	      ok = db.commit();
+	    else
+	      db.rollback();
+	  }
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  return ok;
+}
+
+void dooble_database_rekey::test1(void)
+{
+  /*
+  ** A re-encrypted history row must still expire by its day digest
+  ** and a second pass must not encrypt it again.
+  */
+
+  QAtomicInteger<short> interrupt(0);
+  QTemporaryDir directory;
+  auto date(QDate::currentDate().addDays(-30));
+  auto database_name(dooble_database_utilities::database_name());
+  auto file_name(directory.path() + QDir::separator() + "dooble_history.db");
+  auto ok = directory.isValid();
+  dooble_cryptography current
+    (dooble_random::random_bytes(dooble_cryptography::
+				 s_authentication_key_length),
+     dooble_random::random_bytes(dooble_cryptography::
+				 s_encryption_key_length),
+     "AES-256-GCM",
+     "SHA3-512");
+  dooble_cryptography previous
+    (dooble_random::random_bytes(dooble_cryptography::
+				 s_authentication_key_length),
+     dooble_random::random_bytes(dooble_cryptography::
+				 s_encryption_key_length),
+     "AES-256",
+     "SHA3-512");
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(ok && dooble_database_utilities::open(db))
+      {
+	QSqlQuery query(db);
+
+	query.exec("CREATE TABLE IF NOT EXISTS dooble_history ("
+		   "day_digest BLOB, "
+		   "favorite_digest TEXT NOT NULL, "
+		   "last_visited BLOB NOT NULL, "
+		   "number_of_visits BLOB NOT NULL, "
+		   "title BLOB NOT NULL, "
+		   "url BLOB NOT NULL, "
+		   "url_digest TEXT PRIMARY KEY NOT NULL)");
+	query.prepare("INSERT INTO dooble_history "
+		      "(day_digest, "
+		      "favorite_digest, "
+		      "last_visited, "
+		      "number_of_visits, "
+		      "title, "
+		      "url, "
+		      "url_digest) "
+		      "VALUES (?, ?, ?, ?, ?, ?, ?)");
+	query.addBindValue(previous.hmac(dooble_history::day_message(date)));
+	query.addBindValue(previous.hmac(QByteArray("false")).toBase64());
+	query.addBindValue
+	  (previous.encrypt_then_mac(QDateTime(date, QTime(12, 0)).
+				     toString(Qt::ISODate).toUtf8()));
+	query.addBindValue(previous.encrypt_then_mac("1"));
+	query.addBindValue(previous.encrypt_then_mac("Dooble"));
+	query.addBindValue(previous.encrypt_then_mac("https://dooble.test"));
+	query.addBindValue
+	  (previous.hmac(QByteArray("https://dooble.test")).toBase64());
+	ok &= query.exec();
+      }
+    else
+      ok = false;
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+
+  for(int i = 0; i < 2; i++)
+    ok &= rekey(directory.path(),
+		"dooble_history.db/dooble_history",
+		previous,
+		current,
+		interrupt,
+		16);
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(ok && dooble_database_utilities::open(db))
+      {
+	QSqlQuery query(db);
+	auto authenticated = false;
+
+	ok &= query.exec("SELECT title FROM dooble_history") &&
+	  query.next() &&
+	  current.mac_then_decrypt
+	  (dooble_database_utilities::blob(query.value(0)),
+	   &authenticated) == "Dooble" &&
+	  authenticated;
+	query.finish();
+	query.prepare("DELETE FROM dooble_history WHERE "
+		      "favorite_digest = ? AND day_digest IN (?)");
+	query.addBindValue(current.hmac(QByteArray("false")).toBase64());
+	query.addBindValue(current.hmac(dooble_history::day_message(date)));
+	ok &= query.exec() && query.numRowsAffected() == 1;
+      }
+    else
+      ok = false;
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  qDebug() << "dooble_database_rekey::test1()" << ok;
+}
@@ -25,13 +25,337 @@
 ** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
 #include <QSqlQuery>
+#include <QThreadStorage>
 #include <QVariant>
 
 #include "dooble_database_utilities.h"
+#include "dooble_instrumentation.h"
 
+class dooble_database_utilities_connections
+{
+  /*
+  ** A thread's connections, keyed by file name, and its prepared
+  ** statements, keyed by connection name and statement. The
+  ** consolidated connection and the purges which it will perform
+  ** are also kept here. Everything is removed when the thread exits.
+  ** The generation of each file is recorded when it is opened. The
+  ** prepared statements retain their instrumentation histograms.
+  */
+
+ public:
+  QHash<QPair<QString, QString>, QSqlQuery *> m_queries;
+  QHash<QSqlQuery *, dooble_instrumentation_histogram *> m_histograms;
+  QHash<QString, QString> m_names;
+  QHash<QString, quint64> m_generations;
+  QList<QPair<QString, QVariantList> > m_purge;
+  QSet<QString> m_attached;
+  QSet<QString> m_purge_file_names;
+  QString m_consolidated;
+  bool m_purging;
+
+  dooble_database_utilities_connections(void)
+  {
+    m_purging = false;
+  }
+
+  ~dooble_database_utilities_connections()
+  {
+    close();
+  }
+
+  void close(void)
+  {
+    foreach(const auto &name, m_names.values())
+      remove(name);
+
+    m_generations.clear();
+    m_names.clear();
+    close_consolidated();
+  }
+
+  void close(const QString &file_name)
+  {
+    auto name(m_names.take(file_name));
+
+    m_generations.remove(file_name);
+
+    if(!name.isEmpty())
+      remove(name);
+
+    /*
+    ** The consolidated connection may have attached the file.
+    */
+
+    close_consolidated();
+  }
+
+  void close_consolidated(void)
+  {
+    if(!m_consolidated.isEmpty())
+      remove(m_consolidated);
+
+    m_attached.clear();
+    m_consolidated.clear();
+  }
+
+ private:
+  void remove(const QString &name)
+  {
+    QMutableHashIterator<QPair<QString, QString>, QSqlQuery *> it
+      (m_queries);
+
+    while(it.hasNext())
+      {
+	it.next();
+
+	if(it.key().first == name)
+	  {
+	    m_histograms.remove(it.value());
+	    delete it.value();
+	    it.remove();
+	  }
+      }
+
+    {
+      auto db(QSqlDatabase::database(name, false));
+
+      db.close();
+    }
+
+    QSqlDatabase::removeDatabase(name);
+  }
+};
+
+QAtomicInteger<short> dooble_database_utilities::s_consolidated = 0;
+QAtomicInteger<quint64> dooble_database_utilities::s_statement_cache_hits = 0;
+QAtomicInteger<quint64> dooble_database_utilities::s_statement_cache_misses =
+  0;
+QReadWriteLock dooble_database_utilities::s_blobs_prepared_mutex;
 QReadWriteLock dooble_database_utilities::s_db_id_mutex;
+QReadWriteLock dooble_database_utilities::s_generations_mutex;
+QReadWriteLock dooble_database_utilities::s_tables_mutex;
+QHash<QString, quint64> dooble_database_utilities::s_generations;
+QSet<QString> dooble_database_utilities::s_blobs_migrated;
+QSet<QString> dooble_database_utilities::s_blobs_prepared;
+QSet<QString> dooble_database_utilities::s_tables;
 quint64 dooble_database_utilities::s_db_id = 0;
+static QThreadStorage<dooble_database_utilities_connections *> s_connections;
+static int s_blob_schema_version = 2;
+static int s_blob_text_version = 1;
+static int s_mmap_size = 67108864;
+static int s_page_size = 4096;
+static int s_wal_autocheckpoint = 4096;
+
+QByteArray dooble_database_utilities::blob(const QVariant &value)
+{
+  /*
+  ** Older rows store their values as base64 text. Rows which have
+  ** not been migrated are decoded. See prepare_blobs().
+  */
+
+  if(value.userType() == QMetaType::QByteArray)
+    return value.toByteArray();
+  else
+    return QByteArray::fromBase64(value.toString().toLatin1());
+}
+
+QList<QStringList> dooble_database_utilities::blob_columns
+(const QString &file_name)
+{
+  /*
+  ** The tables of a database and their columns which are stored as
+  ** binary values. The first entry of a list is the table.
+  */
+
+  QList<QStringList> list;
+  auto name(QFileInfo(file_name).fileName());
+
+  if(name == "dooble_cookies.db")
+    list << (QStringList() << "dooble_cookies_domains" << "domain")
+	 << (QStringList() << "dooble_cookies" << "raw_form");
+  else if(name == "dooble_favicons.db")
+    list << (QStringList() << "dooble_favicons"
+	     << "favicon"
+	     << "url_digest"
+	     << "url_host_digest");
+  else if(name == "dooble_history.db")
+    list << (QStringList() << "dooble_history"
+	     << "last_visited"
+	     << "number_of_visits"
+	     << "title"
+	     << "url");
+
+  return list;
+}
+
+QSqlDatabase dooble_database_utilities::database(const QString &file_name)
+{
+  /*
+  ** A QSqlDatabase connection may only be used by the thread which
+  ** created it. Each thread therefore owns a persistent connection
+  ** per file. A connection which was opened before the file was
+  ** forgotten by any thread is replaced.
+  */
+
+  if(!s_connections.hasLocalData())
+    s_connections.setLocalData(new dooble_database_utilities_connections());
+
+  auto connections = s_connections.localData();
+  auto generation = dooble_database_utilities::generation(file_name);
+  auto name(connections->m_names.value(file_name));
+
+  if(!name.isEmpty() &&
+     connections->m_generations.value(file_name) != generation)
+    {
+      connections->close(file_name);
+      name.clear();
+    }
+
+  if(name.isEmpty())
+    {
+      name = database_name();
+      connections->m_generations[file_name] = generation;
+      connections->m_names[file_name] = name;
+
+      auto db = QSqlDatabase::addDatabase("QSQLITE", name);
+
+      db.setDatabaseName(file_name);
+      open(db);
+      return db;
+    }
+
+  auto db(QSqlDatabase::database(name, false));
+
+  open(db);
+  return db;
+}
+
+QSqlDatabase dooble_database_utilities::consolidated_database
+(const QString &home_path)
+{
+  /*
+  ** The calling thread's primary connection. The settings database
+  ** is the main schema and the other databases are attached under
+  ** their names. Databases which do not exist yet are attached once
+  ** their owners have created them. The connection only performs
+  ** purges and checkpoints and is closed once they are complete.
+  ** Reads and writes use the connections of database().
+  */
+
+  if(!s_connections.hasLocalData())
+    s_connections.setLocalData(new dooble_database_utilities_connections());
+
+  auto connections = s_connections.localData();
+  auto file_name(home_path + QDir::separator() + "dooble_settings.db");
+
+  if(!connections->m_consolidated.isEmpty() &&
+     QSqlDatabase::database(connections->m_consolidated, false).
+     databaseName() != file_name)
+    connections->close_consolidated();
+
+  if(connections->m_consolidated.isEmpty())
+    {
+      connections->m_consolidated = database_name();
+
+      auto db = QSqlDatabase::addDatabase
+	("QSQLITE", connections->m_consolidated);
+
+      db.setDatabaseName(file_name);
+    }
+
+  auto db(QSqlDatabase::database(connections->m_consolidated, false));
+
+  if(!db.isOpen())
+    {
+      if(!open(db))
+	return db;
+
+      QSqlQuery query(db);
+
+      exec(db, query, "PRAGMA foreign_keys = ON");
+    }
+
+  QSqlQuery query(db);
+
+  foreach(const auto &i, file_names())
+    {
+      auto name(schema(i));
+
+      if(connections->m_attached.contains(name) || name == "main")
+	continue;
+
+      auto path(home_path + QDir::separator() + i);
+
+      if(!QFileInfo(path).exists())
+	continue;
+
+      query.prepare(QString("ATTACH DATABASE ? AS %1").arg(name));
+      query.addBindValue(path);
+
+      if(!exec(db, &query))
+	continue;
+
+      connections->m_attached << name;
+      exec(db, query, QString("PRAGMA %1.journal_mode = WAL").arg(name));
+      exec(db,
+	   query,
+	   QString("PRAGMA %1.synchronous = %2").
+	   arg(name).arg(synchronous(i)));
+    }
+
+  return db;
+}
+
+QSqlQuery *dooble_database_utilities::prepared_query
+(const QSqlDatabase &db, const QString &statement)
+{
+  /*
+  ** The query belongs to the calling thread's cache and is prepared once
+  ** per connection. The database must be a connection of the calling
+  ** thread which was provided by database(). Values should be bound
+  ** by position since the statement is reused. Finish the query once
+  ** its results are consumed.
+  */
+
+  if(Q_UNLIKELY(!s_connections.hasLocalData()))
+    return nullptr;
+
+  auto connections = s_connections.localData();
+  auto key(qMakePair(db.connectionName(), statement));
+  auto query = connections->m_queries.value(key);
+
+  if(query)
+    {
+      query->finish();
+      s_statement_cache_hits.fetchAndAddOrdered(1);
+      return query;
+    }
+
+  if(Q_UNLIKELY(!connections->m_names.values().contains(key.first)))
+    return nullptr;
+
+  s_statement_cache_misses.fetchAndAddOrdered(1);
+  query = new QSqlQuery(db);
+  query->setForwardOnly(true);
+
+  if(!query->prepare(statement))
+    {
+      delete query;
+      return nullptr;
+    }
+
+  connections->m_histograms[query] = dooble_instrumentation::histogram
+    (db.databaseName(), statement);
+  connections->m_queries[key] = query;
+  return query;
+}
 
 QString dooble_database_utilities::database_name(void)
 {
@@ -41,6 +365,721 @@ QString dooble_database_utilities::database_name(void)
   return QString("dooble_database_name_%1").arg(s_db_id);
 }
 
+QString dooble_database_utilities::schema(const QString &file_name)
+{
+  auto name(QFileInfo(file_name).completeBaseName());
+
+  if(name == "dooble_settings")
+    return "main";
+  else
+    return name;
+}
+
+QString dooble_database_utilities::synchronous(const QString &file_name)
+{
+  /*
+  ** Caches which can be rebuilt may lose their latest transactions if
+  ** the system fails. The write-ahead log keeps them consistent
+  ** otherwise. History is user data.
+  */
+
+  auto name(QFileInfo(file_name).fileName());
+
+  if(name == "dooble_cookies.db" || name == "dooble_favicons.db")
+    return "OFF";
+  else
+    return "NORMAL";
+}
+
+QStringList dooble_database_utilities::file_names(void)
+{
+  QStringList list;
+
+  list << "dooble_accepted_or_blocked_domains.db"
+       << "dooble_certificate_exceptions.db"
+       << "dooble_charts.db"
+       << "dooble_cookies.db"
+       << "dooble_downloads.db"
+       << "dooble_favicons.db"
+       << "dooble_history.db"
+       << "dooble_search_engines.db"
+       << "dooble_settings.db"
+       << "dooble_style_sheets.db";
+  return list;
+}
+
+bool dooble_database_utilities::blobs_migrated(const QString &file_name)
+{
+  /*
+  ** True once the binary values of the database have been migrated.
+  ** Lookups of older databases should also bind their base64 text.
+  */
+
+  QReadLocker locker(&s_blobs_prepared_mutex);
+
+  return s_blobs_migrated.contains(file_name);
+}
+
+bool dooble_database_utilities::consolidated(void)
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  return s_consolidated.load() != 0;
+#else
+  return s_consolidated.loadRelaxed() != 0;
+#endif
+}
+
+bool dooble_database_utilities::end_purge(void)
+{
+  /*
+  ** Performs the purges which were requested since begin_purge() by
+  ** a single transaction. The space of the affected databases is
+  ** then reclaimed. A transaction which spans write-ahead logs is
+  ** atomic per database only.
+  */
+
+  if(!s_connections.hasLocalData())
+    return true;
+
+  auto connections = s_connections.localData();
+  auto files(connections->m_purge_file_names);
+  auto list(connections->m_purge);
+
+  connections->m_purge.clear();
+  connections->m_purge_file_names.clear();
+  connections->m_purging = false;
+
+  if(files.isEmpty() || list.isEmpty())
+    return true;
+
+  auto ok = false;
+
+  {
+    auto db(consolidated_database(QFileInfo(*files.begin()).path()));
+    QSqlQuery query(db);
+
+    if(db.isOpen() && exec(db, query, "BEGIN IMMEDIATE"))
+      {
+	for(int i = 0; i < list.size(); i++)
+	  {
+	    query.prepare(list.at(i).first);
+
+	    foreach(const auto &value, list.at(i).second)
+	      query.addBindValue(value);
+
+	    exec(db, &query);
+	  }
+
+	if((ok = exec(db, query, "COMMIT")))
+	  foreach(const auto &i, files)
+	    {
+	      auto name(schema(i));
+
+	      if(query.exec(QString("PRAGMA %1.auto_vacuum").arg(name)) &&
+		 query.next() &&
+		 query.value(0).toInt() == 2)
+		{
+		  query.finish();
+
+		  if(exec(db,
+			  query,
+			  QString("PRAGMA %1.incremental_vacuum").arg(name)))
+		    while(query.next())
+		      ;
+		}
+	      else
+		{
+		  query.finish();
+		  exec(db, query, QString("VACUUM %1").arg(name));
+		}
+	    }
+	else
+	  exec(db, query, "ROLLBACK");
+      }
+  }
+
+  /*
+  ** The primary connection is not retained.
+  */
+
+  connections->close_consolidated();
+  return ok;
+}
+
+bool dooble_database_utilities::exec(const QSqlDatabase &db, QSqlQuery *query)
+{
+  /*
+  ** Executes a prepared query and records its duration.
+  */
+
+  if(Q_UNLIKELY(!query))
+    return false;
+
+  QElapsedTimer timer;
+
+  timer.start();
+
+  auto ok = query->exec();
+  auto histogram = s_connections.hasLocalData() ?
+    s_connections.localData()->m_histograms.value(query) : nullptr;
+
+  /*
+  ** Queries which are not cached are recorded by their statements.
+  */
+
+  if(histogram)
+    dooble_instrumentation::record(histogram, timer);
+  else
+    dooble_instrumentation::record
+      (db.databaseName(), query->lastQuery(), timer);
+
+  return ok;
+}
+
+bool dooble_database_utilities::exec(const QSqlDatabase &db,
+				     QSqlQuery &query,
+				     const QString &statement)
+{
+  QElapsedTimer timer;
+
+  timer.start();
+
+  auto ok = query.exec(statement);
+
+  dooble_instrumentation::record(db.databaseName(), statement, timer);
+  return ok;
+}
+
+bool dooble_database_utilities::incremental_auto_vacuum
+(const QString &file_name)
+{
+  auto database_name(dooble_database_utilities::database_name());
+  auto state = false;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(QFileInfo(file_name).exists() && db.open())
+      {
+	QSqlQuery query(db);
+
+	if(query.exec("PRAGMA auto_vacuum") && query.next())
+	  state = query.value(0).toInt() == 2;
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  return state;
+}
+
+bool dooble_database_utilities::migrate_blobs(const QString &file_name,
+					      int rows)
+{
+  /*
+  ** Converts a batch of at most the specified number of rows per
+  ** table. Returns true once the database has been migrated.
+  */
+
+  auto list(blob_columns(file_name));
+
+  if(list.isEmpty() || !QFileInfo(file_name).exists())
+    return true;
+
+  auto database_name(dooble_database_utilities::database_name());
+  auto migrated = true;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(open(db))
+      {
+	QSqlQuery query(db);
+	auto version = query.exec("PRAGMA user_version") && query.next();
+
+	if(version && query.value(0).toInt() < s_blob_schema_version)
+	  {
+	    foreach(const auto &i, list)
+	      if(migrate_blobs(db, i.value(0), i.mid(1), rows) > 0)
+		migrated = false;
+
+	    if(migrated)
+	      version = migrated = query.exec
+		(QString("PRAGMA user_version = %1").
+		 arg(s_blob_schema_version));
+	  }
+
+	if(migrated && version)
+	  {
+	    QWriteLocker locker(&s_blobs_prepared_mutex);
+
+	    s_blobs_migrated << file_name;
+	  }
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  return migrated;
+}
+
+int dooble_database_utilities::migrate_blobs(QSqlDatabase &db,
+					     const QString &table,
+					     const QStringList &columns,
+					     int rows)
+{
+  /*
+  ** Base64 text is replaced by binary values in a single transaction.
+  ** A digest which collides with a newer row causes the older row
+  ** to be removed. Returns the number of rows which were converted
+  ** or removed.
+  */
+
+  QList<QVariantList> values;
+  QSqlQuery query(db);
+  QStringList assignments;
+  QStringList conditions;
+
+  foreach(const auto &column, columns)
+    {
+      assignments << QString("%1 = ?").arg(column);
+      conditions << QString("typeof(%1) = 'text'").arg(column);
+    }
+
+  query.setForwardOnly(true);
+
+  if(!query.exec(QString("SELECT OID, %1 FROM %2 WHERE %3 LIMIT %4").
+		 arg(columns.join(", ")).
+		 arg(table).
+		 arg(conditions.join(" OR ")).
+		 arg(rows)))
+    return 0;
+
+  while(query.next())
+    {
+      QVariantList list;
+
+      for(int i = 1; i <= columns.size(); i++)
+	if(query.isNull(i))
+	  list << query.value(i);
+	else
+	  list << blob(query.value(i));
+
+      list << query.value(0);
+      values << list;
+    }
+
+  if(values.isEmpty())
+    return 0;
+
+  int count = 0;
+
+  db.transaction();
+  query.prepare(QString("UPDATE OR IGNORE %1 SET %2 WHERE OID = ?").
+		arg(table).arg(assignments.join(", ")));
+
+  foreach(const auto &list, values)
+    {
+      for(int i = 0; i < list.size(); i++)
+	query.bindValue(i, list.at(i));
+
+      if(!exec(db, &query))
+	continue;
+
+      if(query.numRowsAffected() == 0)
+	remove_entry(db, table, list.last().toLongLong());
+
+      count += 1;
+    }
+
+  db.commit();
+  return count;
+}
+
+bool dooble_database_utilities::open(QSqlDatabase &db)
+{
+  /*
+  ** Opens the database and applies the storage profile. Readers of
+  ** a write-ahead log do not wait for writers. The page size and
+  ** the incremental vacuum only apply to new databases; vacuuming
+  ** converts older ones. Checkpoints are mostly performed by
+  ** checkpoint().
+  */
+
+  if(db.isOpen())
+    return true;
+  else if(!db.open())
+    return false;
+
+  QSqlQuery query(db);
+
+  query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+  query.exec(QString("PRAGMA page_size = %1").arg(s_page_size));
+  query.exec("PRAGMA journal_mode = WAL");
+  query.exec(QString("PRAGMA mmap_size = %1").arg(s_mmap_size));
+  query.exec
+    (QString("PRAGMA synchronous = %1").arg(synchronous(db.databaseName())));
+  query.exec
+    (QString("PRAGMA wal_autocheckpoint = %1").arg(s_wal_autocheckpoint));
+  prepare_blobs(db);
+  return true;
+}
+
+bool dooble_database_utilities::purge(const QString &file_name,
+				      const QStringList &statements,
+				      const QList<QVariantList> &values)
+{
+  /*
+  ** Performs the statements and reclaims the database's space. The
+  ** values of a statement are bound by position. Consolidated purges
+  ** are deferred until end_purge() if begin_purge() was issued.
+  */
+
+  if(consolidated())
+    {
+      if(!s_connections.hasLocalData())
+	s_connections.setLocalData
+	  (new dooble_database_utilities_connections());
+
+      auto connections = s_connections.localData();
+
+      for(int i = 0; i < statements.size(); i++)
+	connections->m_purge << qMakePair(statements.at(i), values.value(i));
+
+      connections->m_purge_file_names << file_name;
+
+      if(connections->m_purging)
+	return true;
+      else
+	return end_purge();
+    }
+
+  auto database_name(dooble_database_utilities::database_name());
+  auto ok = false;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if((ok = open(db)))
+      {
+	QSqlQuery query(db);
+
+	for(int i = 0; i < statements.size(); i++)
+	  {
+	    query.prepare(statements.at(i));
+
+	    foreach(const auto &value, values.value(i))
+	      query.addBindValue(value);
+
+	    exec(db, &query);
+	  }
+
+	exec(db, query, "VACUUM");
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  return ok;
+}
+
+void dooble_database_utilities::prepare_blobs(QSqlDatabase &db)
+{
+  /*
+  ** Older rows bound their base64 text as binary values. Before a
+  ** binary value is written, the older values are declared as text
+  ** so that blob() and migrate_blobs() can distinguish them. The
+  ** immediate transaction prevents other connections from writing
+  ** binary values in the meantime. Each file is examined once per
+  ** process.
+  */
+
+  auto list(blob_columns(db.databaseName()));
+
+  if(list.isEmpty())
+    return;
+
+  {
+    QReadLocker locker(&s_blobs_prepared_mutex);
+
+    if(s_blobs_prepared.contains(db.databaseName()))
+      return;
+  }
+
+  QSqlQuery query(db);
+
+  if(!query.exec("PRAGMA user_version") || !query.next())
+    return;
+  else if(query.value(0).toInt() >= s_blob_text_version)
+    {
+      QWriteLocker locker(&s_blobs_prepared_mutex);
+
+      if(query.value(0).toInt() >= s_blob_schema_version)
+	s_blobs_migrated << db.databaseName();
+
+      s_blobs_prepared << db.databaseName();
+      return;
+    }
+
+  query.finish();
+
+  if(!query.exec("BEGIN IMMEDIATE"))
+    return;
+
+  auto ok = query.exec("PRAGMA user_version") &&
+    query.next() &&
+    query.value(0).toInt() < s_blob_text_version;
+
+  query.finish();
+
+  if(ok)
+    {
+      auto tables(db.tables());
+
+      foreach(const auto &i, list)
+	{
+	  if(!tables.contains(i.value(0)))
+	    continue;
+
+	  QStringList assignments;
+	  QStringList conditions;
+
+	  foreach(const auto &column, i.mid(1))
+	    {
+	      assignments << QString("%1 = CAST(%1 AS TEXT)").arg(column);
+	      conditions << QString("typeof(%1) = 'blob'").arg(column);
+	    }
+
+	  if(!exec(db,
+		   query,
+		   QString("UPDATE %1 SET %2 WHERE %3").
+		   arg(i.value(0)).
+		   arg(assignments.join(", ")).
+		   arg(conditions.join(" OR "))))
+	    {
+	      ok = false;
+	      break;
+	    }
+	}
+
+      if(ok)
+	ok = query.exec
+	  (QString("PRAGMA user_version = %1").arg(s_blob_text_version));
+    }
+
+  if(query.exec(ok ? "COMMIT" : "ROLLBACK") && ok)
+    {
+      QWriteLocker locker(&s_blobs_prepared_mutex);
+
+      s_blobs_prepared << db.databaseName();
+    }
+}
+
+qint64 dooble_database_utilities::incremental_vacuum(const QString &file_name,
+						      int pages)
+{
+  /*
+  ** Returns at most the specified number of free pages to the file
+  ** system. The number of reclaimed bytes is returned.
+  */
+
+  auto database_name(dooble_database_utilities::database_name());
+  qint64 bytes = 0;
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(QFileInfo(file_name).exists() && db.open())
+      {
+	QSqlQuery query(db);
+	qint64 free_pages = 0;
+	qint64 page_size = 0;
+
+	if(query.exec("PRAGMA page_size") && query.next())
+	  page_size = query.value(0).toLongLong();
+
+	if(query.exec("PRAGMA freelist_count") && query.next())
+	  free_pages = query.value(0).toLongLong();
+
+	if(free_pages > 0 &&
+	   exec(db,
+		query,
+		QString("PRAGMA incremental_vacuum(%1)").arg(pages)))
+	  {
+	    while(query.next())
+	      ;
+
+	    if(query.exec("PRAGMA freelist_count") && query.next())
+	      bytes = page_size * (free_pages - query.value(0).toLongLong());
+	  }
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  return qMax(static_cast<qint64> (0), bytes);
+}
+
+quint64 dooble_database_utilities::generation(const QString &file_name)
+{
+  QReadLocker locker(&s_generations_mutex);
+
+  return s_generations.value(file_name);
+}
+
+quint64 dooble_database_utilities::statement_cache_hits(void)
+{
+  return s_statement_cache_hits.loadRelaxed();
+}
+
+quint64 dooble_database_utilities::statement_cache_misses(void)
+{
+  return s_statement_cache_misses.loadRelaxed();
+}
+
+bool dooble_database_utilities::tables_created(const QString &file_name)
+{
+  QReadLocker locker(&s_tables_mutex);
+
+  return s_tables.contains(file_name);
+}
+
+void dooble_database_utilities::begin_purge(void)
+{
+  /*
+  ** Defers the calling thread's consolidated purges until
+  ** end_purge().
+  */
+
+  if(!s_connections.hasLocalData())
+    s_connections.setLocalData(new dooble_database_utilities_connections());
+
+  s_connections.localData()->m_purging = true;
+}
+
+void dooble_database_utilities::checkpoint(const QString &home_path)
+{
+  /*
+  ** Copies the write-ahead logs into their databases. Readers and
+  ** writers are not waited upon.
+  */
+
+  if(consolidated())
+    {
+      {
+	auto db(consolidated_database(home_path));
+
+	if(db.isOpen())
+	  {
+	    QSqlQuery query(db);
+
+	    foreach(const auto &i, file_names())
+	      if(QFileInfo(home_path + QDir::separator() + i + "-wal").
+		 size() > 0)
+		exec(db,
+		     query,
+		     QString("PRAGMA %1.wal_checkpoint(PASSIVE)").
+		     arg(schema(i)));
+	  }
+      }
+
+      s_connections.localData()->close_consolidated();
+      return;
+    }
+
+  foreach(const auto &i, file_names())
+    {
+      auto file_name(home_path + QDir::separator() + i);
+
+      if(QFileInfo(file_name + "-wal").size() <= 0)
+	continue;
+
+      auto database_name(dooble_database_utilities::database_name());
+
+      {
+	auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+	db.setDatabaseName(file_name);
+
+	if(db.open())
+	  {
+	    QSqlQuery query(db);
+
+	    exec(db, query, "PRAGMA wal_checkpoint(PASSIVE)");
+	  }
+
+	db.close();
+      }
+
+      QSqlDatabase::removeDatabase(database_name);
+    }
+}
+
+void dooble_database_utilities::close_databases(void)
+{
+  /*
+  ** Closes the calling thread's connections.
+  */
+
+  if(s_connections.hasLocalData())
+    s_connections.localData()->close();
+}
+
+void dooble_database_utilities::forget_database(const QString &file_name)
+{
+  /*
+  ** The file is about to be removed or its tables dropped. The
+  ** calling thread's connection is closed and the tables will be
+  ** created again. The connections of other threads are replaced
+  ** when they are next requested. The database writer closes its
+  ** connection itself, please see dooble_database_writer::close().
+  */
+
+  if(s_connections.hasLocalData())
+    s_connections.localData()->close(file_name);
+
+  {
+    QWriteLocker locker(&s_generations_mutex);
+
+    s_generations[file_name] += 1;
+  }
+
+  {
+    QWriteLocker locker(&s_blobs_prepared_mutex);
+
+    s_blobs_migrated.remove(file_name);
+    s_blobs_prepared.remove(file_name);
+  }
+
+  QWriteLocker locker(&s_tables_mutex);
+
+  s_tables.remove(file_name);
+}
+
+void dooble_database_utilities::remove_database(const QString &file_name)
+{
+  /*
+  ** Removes the database and its write-ahead files.
+  */
+
+  forget_database(file_name);
+  QFile::remove(file_name);
+  QFile::remove(file_name + "-shm");
+  QFile::remove(file_name + "-wal");
+}
+
 void dooble_database_utilities::remove_entry(const QSqlDatabase &db,
 					     const QString &table,
 					     qint64 oid)
@@ -49,5 +1088,71 @@ void dooble_database_utilities::remove_entry(const QSqlDatabase &db,
 
   query.prepare(QString("DELETE FROM %1 WHERE OID = ?").arg(table));
   query.addBindValue(oid);
-  query.exec();
+  exec(db, &query);
+}
+
+void dooble_database_utilities::set_consolidated(const bool state)
+{
+  /*
+  ** Only purges are consolidated. The databases remain in place.
+  ** The calling thread's consolidated connection is closed if the
+  ** mode is disabled.
+  */
+
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  s_consolidated.store(state ? 1 : 0);
+#else
+  s_consolidated.storeRelaxed(state ? 1 : 0);
+#endif
+
+  if(!state && s_connections.hasLocalData())
+    s_connections.localData()->close_consolidated();
+}
+
+qint64 dooble_database_utilities::vacuum(const QString &file_name)
+{
+  /*
+  ** The page size of a database may only be changed outside of
+  ** write-ahead logging. The calling thread's connection is closed
+  ** so that the journal mode may be switched. The journal mode is not
+  ** switched while other connections remain open. The page size is then
+  ** retained. Vacuuming also enables the incremental vacuum of older
+  ** databases. The number of reclaimed bytes is returned.
+  */
+
+  forget_database(file_name);
+
+  auto database_name(dooble_database_utilities::database_name());
+  auto size = QFileInfo(file_name).size() +
+    QFileInfo(file_name + "-wal").size();
+
+  {
+    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+
+    db.setDatabaseName(file_name);
+
+    if(open(db))
+      {
+	QSqlQuery query(db);
+
+	auto journal_mode = query.exec("PRAGMA journal_mode = DELETE") &&
+	  query.next() &&
+	  query.value(0).toString().toLower() == "delete";
+
+	query.finish();
+	query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
+	if(journal_mode)
+	  query.exec(QString("PRAGMA page_size = %1").arg(s_page_size));
+
+	exec(db, query, "VACUUM");
+	query.exec("PRAGMA journal_mode = WAL");
+      }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(database_name);
+  size -= QFileInfo(file_name).size() + QFileInfo(file_name + "-wal").size();
+  return qMax(static_cast<qint64> (0), size);
 }
@@ -28,21 +28,99 @@
 #ifndef dooble_database_utilities_h
 #define dooble_database_utilities_h
 
+#include <QAtomicInteger>
+#include <QHash>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QSqlDatabase>
+#include <QStringList>
+#include <QVariant>
+
+class QSqlQuery;
 
 class dooble_database_utilities
 {
  public:
+  static QByteArray blob(const QVariant &value);
+  static QList<QStringList> blob_columns(const QString &file_name);
+  static QSqlDatabase consolidated_database(const QString &home_path);
+  static QSqlDatabase database(const QString &file_name);
+  static QSqlQuery *prepared_query(const QSqlDatabase &db,
+				   const QString &statement);
   static QString database_name(void);
+  static QStringList file_names(void);
+  static bool blobs_migrated(const QString &file_name);
+  static bool consolidated(void);
+  static bool end_purge(void);
+  static bool exec(const QSqlDatabase &db, QSqlQuery *query);
+  static bool exec(const QSqlDatabase &db,
+		   QSqlQuery &query,
+		   const QString &statement);
+  static bool incremental_auto_vacuum(const QString &file_name);
+  static bool migrate_blobs(const QString &file_name, int rows);
+  static bool open(QSqlDatabase &db);
+  static bool purge(const QString &file_name,
+		    const QStringList &statements,
+		    const QList<QVariantList> &values = QList<QVariantList> ());
+  static qint64 incremental_vacuum(const QString &file_name, int pages);
+  static qint64 vacuum(const QString &file_name);
+  static quint64 statement_cache_hits(void);
+  static quint64 statement_cache_misses(void);
+  static void begin_purge(void);
+  static void checkpoint(const QString &home_path);
+  static void close_databases(void);
+  static void forget_database(const QString &file_name);
+  static void remove_database(const QString &file_name);
   static void remove_entry(const QSqlDatabase &db,
 			   const QString &table,
 			   qint64 oid);
+  static void set_consolidated(const bool state);
+
+  template<typename Function>
+  static QSqlDatabase database(const QString &file_name,
+			       Function create_tables)
+  {
+    /*
+    ** The tables are created once per process.
+    */
+
+    auto db(database(file_name));
+
+    if(db.isOpen() && !tables_created(file_name))
+      {
+	create_tables(db);
+
+	QWriteLocker locker(&s_tables_mutex);
+
+	s_tables << file_name;
+      }
+
+    return db;
+  }
 
  private:
+  static QAtomicInteger<short> s_consolidated;
+  static QAtomicInteger<quint64> s_statement_cache_hits;
+  static QAtomicInteger<quint64> s_statement_cache_misses;
+  static QHash<QString, quint64> s_generations;
+  static QReadWriteLock s_blobs_prepared_mutex;
   static QReadWriteLock s_db_id_mutex;
+  static QReadWriteLock s_generations_mutex;
+  static QReadWriteLock s_tables_mutex;
+  static QSet<QString> s_blobs_migrated;
+  static QSet<QString> s_blobs_prepared;
+  static QSet<QString> s_tables;
   static quint64 s_db_id;
   dooble_database_utilities(void);
+  static int migrate_blobs(QSqlDatabase &db,
+			   const QString &table,
+			   const QStringList &columns,
+			   int rows);
+  static QString schema(const QString &file_name);
+  static QString synchronous(const QString &file_name);
+  static bool tables_created(const QString &file_name);
+  static quint64 generation(const QString &file_name);
+  static void prepare_blobs(QSqlDatabase &db);
 };
 
 #endif
@@ -0,0 +1,289 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QtConcurrent>
+
+#include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
+#include "dooble_instrumentation.h"
+
+/*
+** Queued statements are written by a single thread. Each database's
+** statements are grouped into one transaction. A statement replaces
+** a pending statement which has the same key, so only the latest
+** state of a row is written. A transaction which cannot be completed
+** because the database is busy is rolled back and queued again.
+*/
+
+int dooble_database_writer::s_interval = 250;
+int dooble_database_writer::s_maximum_size = 128;
+
+dooble_database_writer::dooble_database_writer(QObject *parent):
+  QObject(parent)
+{
+  m_size = 0;
+  m_thread_pool.setExpiryTimeout(-1);
+  m_thread_pool.setMaxThreadCount(1);
+  m_timer.setInterval(s_interval);
+  connect(&m_timer,
+	  SIGNAL(timeout(void)),
+	  this,
+	  SLOT(slot_timeout(void)));
+}
+
+dooble_database_writer::~dooble_database_writer()
+{
+  m_timer.stop();
+  flush();
+  m_thread_pool.waitForDone();
+}
+
+bool dooble_database_writer::busy(const QSqlError &error)
+{
+  /*
+  ** SQLITE_BUSY and SQLITE_LOCKED, including their extended codes.
+  */
+
+  auto code = error.nativeErrorCode().toInt() & 0xff;
+
+  return code == 5 || code == 6;
+}
+
+void dooble_database_writer::close(const QString &file_name)
+{
+  /*
+  ** Closes the writing thread's connection to the database from
+  ** within that thread. The thread pool has a single thread, so a
+  ** running transaction is completed first. Pending statements are
+  ** kept and will open the database again.
+  */
+
+  QMutexLocker locker(&m_mutex);
+
+  m_future = QtConcurrent::run
+    (&m_thread_pool, &dooble_database_utilities::forget_database, file_name);
+
+  auto future(m_future);
+
+  locker.unlock();
+  future.waitForFinished();
+}
+
+void dooble_database_writer::discard(const QString &file_name)
+{
+  /*
+  ** The database is about to be purged or removed. Pending statements
+  ** are removed and the writing thread's connection is closed.
+  */
+
+  QMutexLocker locker(&m_mutex);
+
+  m_size -= m_queues.take(file_name).m_keys.size();
+  locker.unlock();
+  close(file_name);
+
+  /*
+  ** A transaction which was running may have been queued again.
+  */
+
+  locker.relock();
+  m_size -= m_queues.take(file_name).m_keys.size();
+}
+
+void dooble_database_writer::enqueue
+(const QString &file_name,
+ void (*create_tables) (QSqlDatabase &db),
+ const QString &key,
+ const QString &statement,
+ const QVariantList &values)
+{
+  /*
+  ** Must be called from the thread which owns the timer.
+  */
+
+  QMutexLocker locker(&m_mutex);
+  auto &queue = m_queues[file_name];
+
+  if(!queue.m_statements.contains(key))
+    {
+      m_size += 1;
+      queue.m_keys << key;
+    }
+
+  queue.m_create_tables = create_tables;
+  queue.m_statements[key] = qMakePair(statement, values);
+
+  auto size = m_size;
+
+  locker.unlock();
+
+  if(size >= s_maximum_size)
+    slot_timeout();
+  else if(!m_timer.isActive())
+    m_timer.start();
+}
+
+void dooble_database_writer::flush(void)
+{
+  /*
+  ** Writes the pending statements and waits. The thread pool
+  ** has a single thread, so earlier transactions are completed first.
+  */
+
+  QMutexLocker locker(&m_mutex);
+  auto queues(m_queues);
+
+  m_queues.clear();
+  m_size = 0;
+  m_future = QtConcurrent::run
+    (&m_thread_pool, &dooble_database_writer::write, this, queues);
+
+  auto future(m_future);
+
+  locker.unlock();
+  future.waitForFinished();
+}
+
+void dooble_database_writer::requeue
+(const QString &file_name, const dooble_database_writer_queue &queue)
+{
+  /*
+  ** Statements which were enqueued after the failed transaction
+  ** replace its statements of the same keys.
+  */
+
+  QMutexLocker locker(&m_mutex);
+  auto pending(m_queues.value(file_name));
+  auto q(queue);
+
+  foreach(const auto &key, pending.m_keys)
+    {
+      if(!q.m_statements.contains(key))
+	q.m_keys << key;
+
+      q.m_statements[key] = pending.m_statements.value(key);
+    }
+
+  if(pending.m_create_tables)
+    q.m_create_tables = pending.m_create_tables;
+
+  m_queues[file_name] = q;
+  m_size += q.m_keys.size() - pending.m_keys.size();
+  locker.unlock();
+  QMetaObject::invokeMethod(&m_timer, "start", Qt::QueuedConnection);
+}
+
+void dooble_database_writer::slot_timeout(void)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if(m_queues.isEmpty())
+    {
+      m_timer.stop();
+      return;
+    }
+  else if(!m_future.isFinished())
+    return;
+
+  auto queues(m_queues);
+
+  m_queues.clear();
+  m_size = 0;
+  m_future = QtConcurrent::run
+    (&m_thread_pool, &dooble_database_writer::write, this, queues);
+}
+
+void dooble_database_writer::write
+(dooble_database_writer *writer,
+ const QHash<QString, dooble_database_writer_queue> &queues)
+{
+  QHashIterator<QString, dooble_database_writer_queue> it(queues);
+
+  while(it.hasNext())
+    {
+      it.next();
+
+      if(!it.value().m_create_tables)
+	continue;
+
+      auto db
+	(dooble_database_utilities::
+	 database(it.key(), it.value().m_create_tables));
+
+      if(!db.isOpen())
+	continue;
+
+      if(!db.transaction())
+	{
+	  writer->requeue(it.key(), it.value());
+	  continue;
+	}
+
+      auto ok = true;
+
+      foreach(const auto &key, it.value().m_keys)
+	{
+	  auto pair(it.value().m_statements.value(key));
+	  auto query = dooble_database_utilities::prepared_query
+	    (db, pair.first);
+
+	  if(!query)
+	    continue;
+
+	  for(int i = 0; i < pair.second.size(); i++)
+	    query->bindValue(i, pair.second.at(i));
+
+	  /*
+	  ** A statement which fails for another reason is not repeated.
+	  */
+
+	  if(!dooble_database_utilities::exec(db, query) &&
+	     busy(query->lastError()))
+	    {
+	      ok = false;
+	      break;
+	    }
+	}
+
+      if(ok)
+	{
+	  QElapsedTimer timer;
+
+	  timer.start();
+	  ok = db.commit();
+	  dooble_instrumentation::record(it.key(), "COMMIT", timer);
+	}
+
+      if(!ok)
+	{
+	  db.rollback();
+	  writer->requeue(it.key(), it.value());
+	}
+    }
+}
@@ -0,0 +1,91 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef dooble_database_writer_h
+#define dooble_database_writer_h
+
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariant>
+
+class dooble_database_writer_queue
+{
+ public:
+  dooble_database_writer_queue(void)
+  {
+    m_create_tables = nullptr;
+  }
+
+  QHash<QString, QPair<QString, QVariantList> > m_statements;
+  QStringList m_keys;
+  void (*m_create_tables) (QSqlDatabase &db);
+};
+
+class dooble_database_writer: public QObject
+{
+  Q_OBJECT
+
+ public:
+  dooble_database_writer(QObject *parent);
+  ~dooble_database_writer();
+  void close(const QString &file_name);
+  void discard(const QString &file_name);
+  void enqueue(const QString &file_name,
+	       void (*create_tables) (QSqlDatabase &db),
+	       const QString &key,
+	       const QString &statement,
+	       const QVariantList &values);
+  void flush(void);
+
+ private:
+  QFuture<void> m_future;
+  QHash<QString, dooble_database_writer_queue> m_queues;
+  QMutex m_mutex;
+  QThreadPool m_thread_pool;
+  QTimer m_timer;
+  int m_size;
+  static int s_interval;
+  static int s_maximum_size;
+  static bool busy(const QSqlError &error);
+  static void write
+    (dooble_database_writer *writer,
+     const QHash<QString, dooble_database_writer_queue> &queues);
+  void requeue(const QString &file_name,
+	       const dooble_database_writer_queue &queue);
+
+ private slots:
+  void slot_timeout(void);
+};
+
+#endif
@@ -0,0 +1,259 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QtDebug>
+
+#include "dooble_domain_matcher.h"
+
+static const quint32 s_multiplier = 0x01000193;
+
+dooble_domain_matcher::dooble_domain_matcher(void)
+{
+  m_count = 0;
+  m_garbage = 0;
+  m_removed = 0;
+}
+
+bool dooble_domain_matcher::matches(const QString &host) const
+{
+  if(m_count == 0)
+    return false;
+
+  /*
+  ** The host is read from right to left so that the hash of every
+  ** parent domain is available at its first character. Parents which
+  ** follow an empty label are not examined.
+  */
+
+  auto data = host.constData();
+  auto length = host.length();
+  int empty = -1;
+  int match = -1;
+  quint32 hash = 0;
+
+  for(int i = length - 1; i >= 0; i--)
+    {
+      hash = s_multiplier * hash + data[i].toLower().unicode();
+
+      if(i > 0 && data[i - 1] != '.')
+	continue;
+      else if(data[i] == '.')
+	empty = i;
+
+      if(find(data + i, length - i, mix(hash)) >= 0)
+	match = i;
+    }
+
+  return match >= 0 && (empty < 0 || match <= empty);
+}
+
+int dooble_domain_matcher::find
+(const QChar *data, int length, quint32 hash) const
+{
+  if(m_slots.isEmpty())
+    return -1;
+
+  auto mask = m_slots.size() - 1;
+  auto index = static_cast<int> (hash) & mask;
+
+  while(true)
+    {
+      const auto &slot(m_slots.at(index));
+
+      if(slot.m_length == 0)
+	return -1;
+      else if(slot.m_hash == hash && slot.m_length == length)
+	{
+	  auto arena = m_arena.constData() + slot.m_offset;
+	  auto equal = true;
+
+	  for(int i = 0; i < length; i++)
+	    if(arena[i] != data[i].toLower())
+	      {
+		equal = false;
+		break;
+	      }
+
+	  if(equal)
+	    return index;
+	}
+
+      index = (index + 1) & mask;
+    }
+}
+
+quint32 dooble_domain_matcher::hash(const QChar *data, int length)
+{
+  quint32 hash = 0;
+
+  for(int i = length - 1; i >= 0; i--)
+    hash = s_multiplier * hash + data[i].toLower().unicode();
+
+  return mix(hash);
+}
+
+quint32 dooble_domain_matcher::mix(quint32 hash)
+{
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+void dooble_domain_matcher::clear(void)
+{
+  m_arena.clear();
+  m_count = 0;
+  m_garbage = 0;
+  m_removed = 0;
+  m_slots.clear();
+}
+
+void dooble_domain_matcher::insert(const QString &d)
+{
+  auto domain(d.toLower().trimmed());
+
+  if(domain.isEmpty())
+    return;
+
+  auto h = hash(domain.constData(), domain.length());
+
+  if(find(domain.constData(), domain.length(), h) >= 0)
+    return;
+
+  if(2 * (m_count + m_removed + 1) > m_slots.size())
+    {
+      auto capacity = 16;
+
+      while(capacity < 4 * (m_count + 1))
+	capacity *= 2;
+
+      rehash(capacity);
+    }
+
+  auto mask = m_slots.size() - 1;
+  auto index = static_cast<int> (h) & mask;
+
+  while(m_slots.at(index).m_length > 0)
+    index = (index + 1) & mask;
+
+  if(m_slots.at(index).m_length < 0)
+    m_removed -= 1;
+
+  m_count += 1;
+  m_slots[index].m_hash = h;
+  m_slots[index].m_length = domain.length();
+  m_slots[index].m_offset = m_arena.length();
+  m_arena.append(domain);
+}
+
+void dooble_domain_matcher::rehash(int capacity)
+{
+  /*
+  ** Removed domains are discarded from the arena.
+  */
+
+  QString arena;
+  QVector<Slot> slots(capacity);
+  auto mask = capacity - 1;
+
+  arena.reserve(m_arena.length() - m_garbage);
+
+  for(int i = 0; i < m_slots.size(); i++)
+    {
+      auto slot(m_slots.at(i));
+
+      if(slot.m_length <= 0)
+	continue;
+
+      auto index = static_cast<int> (slot.m_hash) & mask;
+
+      while(slots.at(index).m_length != 0)
+	index = (index + 1) & mask;
+
+      arena.append(m_arena.constData() + slot.m_offset, slot.m_length);
+      slot.m_offset = arena.length() - slot.m_length;
+      slots[index] = slot;
+    }
+
+  m_arena = arena;
+  m_garbage = 0;
+  m_removed = 0;
+  m_slots = slots;
+}
+
+void dooble_domain_matcher::remove(const QString &d)
+{
+  auto domain(d.toLower().trimmed());
+
+  if(domain.isEmpty())
+    return;
+
+  auto index = find
+    (domain.constData(),
+     domain.length(),
+     hash(domain.constData(), domain.length()));
+
+  if(index < 0)
+    return;
+
+  m_count -= 1;
+  m_garbage += domain.length();
+  m_removed += 1;
+  m_slots[index].m_length = -1;
+
+  if(m_count == 0)
+    clear();
+  else if(m_garbage > 4096 && 2 * m_garbage > m_arena.length())
+    rehash(m_slots.size());
+}
+
+void dooble_domain_matcher::test1(void)
+{
+  /*
+  ** Domains are inserted as populate() reads them from the table.
+  */
+
+  dooble_domain_matcher matcher;
+  auto ok = true;
+
+  matcher.insert(" Example.COM ");
+  matcher.insert("Sub.Example.Org");
+  ok &= matcher.matches("example.com");
+  ok &= matcher.matches("Example.COM");
+  ok &= matcher.matches("www.EXAMPLE.com");
+  ok &= matcher.matches("a.sub.example.org");
+  ok &= !matcher.matches("example.org");
+  ok &= !matcher.matches("example.com.test");
+  ok &= !matcher.matches("notexample.com");
+  matcher.remove("EXAMPLE.com");
+  ok &= !matcher.matches("www.example.com");
+  ok &= matcher.matches("SUB.example.org");
+  qDebug() << "dooble_domain_matcher::test1()" << ok;
+}
@@ -0,0 +1,70 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef dooble_domain_matcher_h
+#define dooble_domain_matcher_h
+
+#include <QString>
+#include <QVector>
+
+class dooble_domain_matcher
+{
+  /*
+  ** A set of domains which are stored in a single arena and indexed by
+  ** an open-addressed table of hashes. A host and its parent domains
+  ** are matched in one pass over the host without allocations.
+  */
+
+ public:
+  dooble_domain_matcher(void);
+  bool matches(const QString &host) const;
+  void clear(void);
+  void insert(const QString &domain);
+  void remove(const QString &domain);
+  static void test1(void);
+
+ private:
+  class Slot
+  {
+   public:
+    quint32 m_hash {};
+    int m_length {}; // Zero if empty, negative if removed.
+    int m_offset {};
+  };
+
+  QString m_arena;
+  QVector<Slot> m_slots;
+  int m_count;
+  int m_garbage;
+  int m_removed;
+  int find(const QChar *data, int length, quint32 hash) const;
+  static quint32 hash(const QChar *data, int length);
+  static quint32 mix(quint32 hash);
+  void rehash(int capacity);
+};
+
+#endif
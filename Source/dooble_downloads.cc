@@ -30,7 +30,6 @@
 #include <QKeyEvent>
 #include <QMessageBox>
 #include <QSqlQuery>
-#include <QSqlRecord>
 #include <QStandardPaths>
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 #include <QWebEngineDownloadItem>
@@ -41,6 +40,8 @@
 
 #include "dooble.h"
 #include "dooble_cryptography.h"
+#include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_downloads.h"
 #include "dooble_downloads_item.h"
 #include "dooble_page.h"
@@ -222,7 +223,7 @@ void dooble_downloads::closeEvent(QCloseEvent *event)
 
 void dooble_downloads::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlDatabase query(db);
 
@@ -330,28 +331,17 @@ void dooble_downloads::purge(void)
   m_ui.search->clear();
   m_ui.table->setRowCount(0);
 
-  QString database_name("dooble_downloads");
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_downloads.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_downloads");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->discard
+      (dooble_settings::setting("home_path").toString() +
+       QDir::separator() +
+       "dooble_downloads.db");
+
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_downloads.db",
+     QStringList() << "DELETE FROM dooble_downloads");
   slot_search_timer_timeout();
 }
 
@@ -439,6 +429,9 @@ void dooble_downloads::record_download
 
 void dooble_downloads::remove_entry(qintptr oid)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   QString database_name("dooble_downloads");
 
   {
@@ -448,11 +441,10 @@ void dooble_downloads::remove_entry(qintptr oid)
 		       QDir::separator() +
 		       "dooble_downloads.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
 	query.prepare("DELETE FROM dooble_downloads WHERE OID = ?");
 	query.addBindValue(oid);
 	query.exec();
@@ -723,7 +715,7 @@ void dooble_downloads::slot_populate(void)
 		       QDir::separator() +
 		       "dooble_downloads.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -739,82 +731,70 @@ void dooble_downloads::slot_populate(void)
 
 	if(query.exec("SELECT download_path, file_name, information, url, OID "
 		      "FROM dooble_downloads ORDER BY insert_order"))
-	  while(query.next() && total_rows < m_ui.table->rowCount())
-	    {
-	      QString download_path("");
-	      QString file_name("");
-	      QString information("");
-	      QUrl url;
-	      auto record(query.record());
-	      qintptr oid = -1;
-
-	      for(int i = 0; i < record.count(); i++)
-		switch(i)
+	  {
+	    QVector<QByteArray> fields;
+	    QVector<QVariant> oids;
+
+	    while(query.next())
+	      {
+		for(int i = 0; i < 4; i++)
+		  fields << QByteArray::fromBase64
+		    (query.value(i).toByteArray());
+
+		oids << query.value(4);
+	      }
+
+	    fields = dooble::s_cryptography->mac_then_decrypt_batch(fields);
+
+	    for(int i = 0; i < oids.size(); i++)
+	      {
+		if(total_rows >= m_ui.table->rowCount())
+		  break;
+
+		auto download_path(QString::fromUtf8(fields.at(4 * i)));
+		auto file_name(QString::fromUtf8(fields.at(4 * i + 1)));
+		auto information(QString::fromUtf8(fields.at(4 * i + 2)));
+		auto url(QUrl::fromEncoded(fields.at(4 * i + 3)));
+		qintptr oid = -1;
+
+		if(sizeof(qintptr) == 4)
+		  oid = oids.at(i).toInt();
+		else
+		  oid = oids.at(i).toLongLong();
+
+		if(download_path.isEmpty() ||
+		   file_name.isEmpty() ||
+		   information.isEmpty() ||
+		   url.isEmpty() ||
+		   !url.isValid())
 		  {
-		  case 0:
-		  case 1:
-		  case 2:
-		  case 3:
-		    {
-		      auto bytes
-			(QByteArray::fromBase64(query.value(i).toByteArray()));
-
-		      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-		      if(i == 0)
-			download_path = QString::fromUtf8(bytes);
-		      else if(i == 1)
-			file_name = QString::fromUtf8(bytes);
-		      else if(i == 2)
-			information = QString::fromUtf8(bytes);
-		      else
-			url = QUrl::fromEncoded(bytes);
-
-		      break;
-		    }
-		  default:
-		    {
-		      if(sizeof(qintptr) == 4)
-			oid = query.value(i).toInt();
-		      else
-			oid = query.value(i).toLongLong();
-
-		      break;
-		    }
+		    QSqlQuery delete_query(db);
+
+		    delete_query.prepare("DELETE FROM dooble_downloads "
+					 "WHERE OID = ?");
+		    delete_query.addBindValue(oids.at(i));
+		    delete_query.exec();
+		    continue;
 		  }
 
-	      if(download_path.isEmpty() ||
-		 file_name.isEmpty() ||
-		 information.isEmpty() ||
-		 url.isEmpty() ||
-		 !url.isValid())
-		{
-		  QSqlQuery delete_query(db);
-
-		  delete_query.prepare("DELETE FROM dooble_downloads "
-				       "WHERE OID = ?");
-		  delete_query.addBindValue(query.value(record.count() - 1));
-		  delete_query.exec();
-		  continue;
-		}
-
-	      auto downloads_item = new dooble_downloads_item
-		(download_path, file_name, information, url, oid, this);
-
-	      connect(downloads_item,
-		      SIGNAL(finished(void)),
-		      this,
-		      SLOT(slot_download_finished(void)));
-	      connect(downloads_item,
-		      SIGNAL(reload(const QString &, const QUrl &)),
-		      this,
-		      SLOT(slot_reload(const QString &, const QUrl &)));
-	      m_ui.table->setCellWidget(row, 0, downloads_item);
-	      m_ui.table->setRowHeight(row, 100);
-	      m_ui.table->resizeRowToContents(row);
-	      row += 1;
-	      total_rows += 1;
-	    }
+		auto downloads_item = new dooble_downloads_item
+		  (download_path, file_name, information, url, oid, this);
+
+		connect(downloads_item,
+			SIGNAL(finished(void)),
+			this,
+			SLOT(slot_download_finished(void)));
+		connect(downloads_item,
+			SIGNAL(reload(const QString &, const QUrl &)),
+			this,
+			SLOT(slot_reload(const QString &, const QUrl &)));
+		m_ui.table->setCellWidget(row, 0, downloads_item);
+		m_ui.table->setRowHeight(row, 100);
+		m_ui.table->resizeRowToContents(row);
+		row += 1;
+		total_rows += 1;
+	      }
+	  }
 
 	m_ui.table->setRowCount(total_rows);
       }
@@ -37,6 +37,7 @@
 #include "dooble.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_downloads.h"
 #include "dooble_downloads_item.h"
 #include "dooble_ui_utilities.h"
@@ -286,7 +287,7 @@ void dooble_downloads_item::record(void)
 		       QDir::separator() +
 		       "dooble_downloads.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	dooble_downloads::create_tables(db);
 
@@ -370,42 +371,25 @@ void dooble_downloads_item::record_information(void)
 {
   if(!dooble::s_cryptography ||
      !dooble::s_cryptography->authenticated() ||
+     !dooble::s_database_writer ||
      m_is_private)
     return;
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_downloads.db");
-
-    if(db.open())
-      {
-	QByteArray bytes;
-	QSqlQuery query(db);
-	auto information(m_ui.information->text());
-
-	query.prepare
-	  ("UPDATE dooble_downloads SET information = ? WHERE OID = ?");
-	bytes = dooble::s_cryptography->encrypt_then_mac(information.toUtf8());
-
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  auto bytes
+    (dooble::s_cryptography->encrypt_then_mac(m_ui.information->text().
+					      toUtf8()));
 
-	query.addBindValue(m_oid);
-	query.exec();
-      }
-
-  done_label:
-    db.close();
-  }
+  if(bytes.isEmpty())
+    return;
 
-  QSqlDatabase::removeDatabase(database_name);
+  dooble::s_database_writer->enqueue
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_downloads.db",
+     &dooble_downloads::create_tables,
+     QString::number(m_oid),
+     "UPDATE dooble_downloads SET information = ? WHERE OID = ?",
+     QVariantList() << bytes.toBase64() << m_oid);
 }
 
 void dooble_downloads_item::slot_cancel(void)
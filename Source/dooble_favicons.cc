@@ -32,6 +32,7 @@
 #include "dooble.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_favicons.h"
 #include "dooble_search_engines_popup.h"
 
@@ -53,67 +54,83 @@ QIcon dooble_favicons::icon(const QUrl &url)
     return QIcon(":/Miscellaneous/blank_page.png");
 
   QIcon icon;
-  auto database_name(dooble_database_utilities::database_name());
+  auto db
+    (dooble_database_utilities::
+     database(dooble_settings::setting("home_path").toString() +
+	      QDir::separator() +
+	      "dooble_favicons.db",
+	      &create_tables));
+
+  if(db.isOpen())
+    {
+      /*
+      ** Digests which have not been migrated are stored as base64 text.
+      */
+
+      auto migrated = dooble_database_utilities::blobs_migrated
+	(db.databaseName());
+      auto query = dooble_database_utilities::prepared_query
+	(db,
+	 migrated ?
+	 "SELECT favicon, OID FROM dooble_favicons WHERE "
+	 "url_digest IN (?, ?)" :
+	 "SELECT favicon, OID FROM dooble_favicons WHERE "
+	 "url_digest IN (?, ?, ?, ?)");
+
+      if(!query)
+	return QIcon(":/Miscellaneous/blank_page.png");
+
+      auto digest1(dooble::s_cryptography->hmac(url.toEncoded()));
+      auto digest2(dooble::s_cryptography->hmac(url.toEncoded() + "/"));
+
+      query->bindValue(0, digest1);
+      query->bindValue(1, digest2);
+
+      if(!migrated)
+	{
+	  query->bindValue(2, QString(digest1.toBase64()));
+	  query->bindValue(3, QString(digest2.toBase64()));
+	}
+
+      if(dooble_database_utilities::exec(db, query) && query->next())
+	if(!query->isNull(0))
+	  {
+	    auto bytes(dooble_database_utilities::blob(query->value(0)));
+	    auto needs_rewrite = dooble::s_cryptography->needs_rewrite(bytes);
+	    auto ok = false;
 
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+	    bytes = dooble::s_cryptography->mac_then_decrypt(bytes, &ok);
 
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_favicons.db");
+	    if(!bytes.isEmpty() && ok)
+	      {
+		if(needs_rewrite)
+		  rewrite(db, bytes, query->value(1).toLongLong());
 
-    if(db.open())
-      {
-	create_tables(db);
+		QBuffer buffer;
 
-	QSqlQuery query(db);
+		buffer.setBuffer(&bytes);
 
-	query.setForwardOnly(true);
-	query.prepare("SELECT favicon, OID FROM dooble_favicons WHERE "
-		      "url_digest IN (?, ?)");
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded() + "/").toBase64());
-
-	if(query.exec() && query.next())
-	  if(!query.isNull(0))
-	    {
-	      auto bytes
-		(QByteArray::fromBase64(query.value(0).toByteArray()));
-
-	      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-	      if(!bytes.isEmpty())
-		{
-		  QBuffer buffer;
-
-		  buffer.setBuffer(&bytes);
-
-		  if(buffer.open(QIODevice::ReadOnly))
-		    {
-		      QDataStream in(&buffer);
-
-		      in >> icon;
-
-		      if(in.status() != QDataStream::Ok)
-			icon = QIcon();
-
-		      buffer.close();
-		    }
-		}
-	      else
-		dooble_database_utilities::remove_entry
-		  (db,
-		   "dooble_favicons",
-		   query.value(1).toLongLong());
-	    }
-      }
+		if(buffer.open(QIODevice::ReadOnly))
+		  {
+		    QDataStream in(&buffer);
 
-    db.close();
-  }
+		    in >> icon;
 
-  QSqlDatabase::removeDatabase(database_name);
+		    if(in.status() != QDataStream::Ok)
+		      icon = QIcon();
+
+		    buffer.close();
+		  }
+	      }
+	    else
+	      dooble_database_utilities::remove_entry
+		(db,
+		 "dooble_favicons",
+		 query->value(1).toLongLong());
+	  }
+
+      query->finish();
+    }
 
   if(icon.isNull())
     icon = QIcon(":/Miscellaneous/blank_page.png");
@@ -131,65 +148,78 @@ QIcon dooble_favicons::icon_from_host(const QUrl &url)
     return QIcon(":/Miscellaneous/blank_page.png");
 
   QIcon icon;
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_favicons.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.setForwardOnly(true);
-	query.prepare("SELECT favicon, OID FROM dooble_favicons WHERE "
-		      "url_host_digest = ?");
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.host()).toBase64());
-
-	if(query.exec() && query.next())
-	  if(!query.isNull(0))
-	    {
-	      auto bytes
-		(QByteArray::fromBase64(query.value(0).toByteArray()));
+  auto db
+    (dooble_database_utilities::
+     database(dooble_settings::setting("home_path").toString() +
+	      QDir::separator() +
+	      "dooble_favicons.db",
+	      &create_tables));
+
+  if(db.isOpen())
+    {
+      /*
+      ** Digests which have not been migrated are stored as base64 text.
+      */
+
+      auto migrated = dooble_database_utilities::blobs_migrated
+	(db.databaseName());
+      auto query = dooble_database_utilities::prepared_query
+	(db,
+	 migrated ?
+	 "SELECT favicon, OID FROM dooble_favicons WHERE "
+	 "url_host_digest = ?" :
+	 "SELECT favicon, OID FROM dooble_favicons WHERE "
+	 "url_host_digest IN (?, ?)");
+
+      if(!query)
+	return QIcon(":/Miscellaneous/blank_page.png");
+
+      auto digest(dooble::s_cryptography->hmac(url.host()));
+
+      query->bindValue(0, digest);
+
+      if(!migrated)
+	query->bindValue(1, QString(digest.toBase64()));
+
+      if(dooble_database_utilities::exec(db, query) && query->next())
+	if(!query->isNull(0))
+	  {
+	    auto bytes(dooble_database_utilities::blob(query->value(0)));
+	    auto needs_rewrite = dooble::s_cryptography->needs_rewrite(bytes);
+	    auto ok = false;
 
-	      bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
+	    bytes = dooble::s_cryptography->mac_then_decrypt(bytes, &ok);
 
-	      if(!bytes.isEmpty())
-		{
-		  QBuffer buffer;
+	    if(!bytes.isEmpty() && ok)
+	      {
+		if(needs_rewrite)
+		  rewrite(db, bytes, query->value(1).toLongLong());
 
-		  buffer.setBuffer(&bytes);
+		QBuffer buffer;
 
-		  if(buffer.open(QIODevice::ReadOnly))
-		    {
-		      QDataStream in(&buffer);
+		buffer.setBuffer(&bytes);
 
-		      in >> icon;
+		if(buffer.open(QIODevice::ReadOnly))
+		  {
+		    QDataStream in(&buffer);
 
-		      if(in.status() != QDataStream::Ok)
-			icon = QIcon();
+		    in >> icon;
 
-		      buffer.close();
-		    }
-		}
-	      else
-		dooble_database_utilities::remove_entry
-		  (db,
-		   "dooble_favicons",
-		   query.value(1).toLongLong());
-	    }
-      }
+		    if(in.status() != QDataStream::Ok)
+		      icon = QIcon();
 
-    db.close();
-  }
+		    buffer.close();
+		  }
+	      }
+	    else
+	      dooble_database_utilities::remove_entry
+		(db,
+		 "dooble_favicons",
+		 query->value(1).toLongLong());
+	  }
 
-  QSqlDatabase::removeDatabase(database_name);
+      query->finish();
+    }
 
   if(icon.isNull())
     icon = QIcon(":/Miscellaneous/blank_page.png");
@@ -199,15 +229,15 @@ QIcon dooble_favicons::icon_from_host(const QUrl &url)
 
 void dooble_favicons::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
   query.exec("CREATE TABLE IF NOT EXISTS dooble_favicons ("
 	     "favicon BLOB DEFAULT NULL, "
 	     "temporary INTEGER NOT NULL DEFAULT 1, "
-	     "url_digest TEXT PRIMARY KEY NOT NULL, "
-	     "url_host_digest NOT NULL)");
+	     "url_digest BLOB PRIMARY KEY NOT NULL, "
+	     "url_host_digest BLOB NOT NULL)");
   query.exec
     ("CREATE INDEX IF NOT EXISTS dooble_favicons_index_url_digest ON "
      "dooble_favicons (url_digest)");
@@ -218,6 +248,24 @@ void dooble_favicons::create_tables(QSqlDatabase &db)
 
 void dooble_favicons::purge(void)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->discard
+      (dooble_settings::setting("home_path").toString() +
+       QDir::separator() +
+       "dooble_favicons.db");
+
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_favicons.db",
+     QStringList() << "DELETE FROM dooble_favicons");
+}
+
+void dooble_favicons::purge_temporary(void)
+{
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto database_name(dooble_database_utilities::database_name());
 
   {
@@ -227,13 +275,11 @@ void dooble_favicons::purge(void)
 		       QDir::separator() +
 		       "dooble_favicons.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_favicons");
-	query.exec("VACUUM");
+	query.exec("DELETE FROM dooble_favicons WHERE temporary = 1");
       }
 
     db.close();
@@ -242,29 +288,29 @@ void dooble_favicons::purge(void)
   QSqlDatabase::removeDatabase(database_name);
 }
 
-void dooble_favicons::purge_temporary(void)
+void dooble_favicons::rewrite(const QSqlDatabase &db,
+			      const QByteArray &bytes,
+			      const qint64 oid)
 {
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+  /*
+  ** Containers which were not prepared by the selected mode are
+  ** replaced as they are read.
+  */
 
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_favicons.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
+  auto data(dooble::s_cryptography->encrypt_then_mac(bytes));
 
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_favicons WHERE temporary = 1");
-      }
+  if(data.isEmpty())
+    return;
 
-    db.close();
-  }
+  auto query = dooble_database_utilities::prepared_query
+    (db, "UPDATE dooble_favicons SET favicon = ? WHERE OID = ?");
 
-  QSqlDatabase::removeDatabase(database_name);
+  if(query)
+    {
+      query->bindValue(0, data);
+      query->bindValue(1, oid);
+      dooble_database_utilities::exec(db, query);
+    }
 }
 
 void dooble_favicons::save_favicon(const QIcon &icon, const QUrl &url)
@@ -273,75 +319,60 @@ void dooble_favicons::save_favicon(const QIcon &icon, const QUrl &url)
     dooble::s_search_engines_window->set_icon(icon, url);
 
   if(!dooble::s_cryptography ||
+     !dooble::s_database_writer ||
      !dooble::s_settings->setting("favicons").toBool() ||
      icon.isNull())
     return;
 
-  auto database_name(dooble_database_utilities::database_name());
+  QBuffer buffer;
+  QByteArray bytes;
+  QVariantList values;
 
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
+  buffer.setBuffer(&bytes);
 
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_favicons.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.prepare
-	  ("INSERT OR REPLACE INTO dooble_favicons "
-	   "(favicon, temporary, url_digest, url_host_digest) "
-	   "VALUES (?, ?, ?, ?)");
-
-	QBuffer buffer;
-	QByteArray bytes;
-
-	buffer.setBuffer(&bytes);
-
-	if(buffer.open(QIODevice::WriteOnly))
-	  {
-	    QDataStream out(&buffer);
-
-	    out << icon;
+  if(buffer.open(QIODevice::WriteOnly))
+    {
+      QDataStream out(&buffer);
 
-	    if(out.status() != QDataStream::Ok)
-	      bytes.clear();
-	  }
-	else
-	  bytes.clear();
+      out << icon;
 
-	buffer.close();
-	bytes = dooble::s_cryptography->encrypt_then_mac(bytes);
+      if(out.status() != QDataStream::Ok)
+	bytes.clear();
+    }
+  else
+    bytes.clear();
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  buffer.close();
+  bytes = dooble::s_cryptography->encrypt_then_mac(bytes);
 
-	query.addBindValue(dooble::s_cryptography->authenticated() ? 0 : 1);
-	bytes = dooble::s_cryptography->hmac(url.toEncoded());
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	if(bytes.isEmpty())
-	  goto done_label;
+  values << (dooble::s_cryptography->authenticated() ? 0 : 1);
+  bytes = dooble::s_cryptography->hmac(url.toEncoded());
 
-	query.addBindValue(bytes.toBase64());
-	bytes = dooble::s_cryptography->hmac(url.host());
+  if(bytes.isEmpty())
+    return;
 
-	if(bytes.isEmpty())
-	  goto done_label;
+  auto url_digest(bytes.toBase64());
 
-	query.addBindValue(bytes.toBase64());
-	query.exec();
-      }
+  values << bytes;
+  bytes = dooble::s_cryptography->hmac(url.host());
 
-  done_label:
-    db.close();
-  }
+  if(bytes.isEmpty())
+    return;
 
-  QSqlDatabase::removeDatabase(database_name);
+  values << bytes;
+  dooble::s_database_writer->enqueue
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_favicons.db",
+     &create_tables,
+     url_digest,
+     "INSERT OR REPLACE INTO dooble_favicons "
+     "(favicon, temporary, url_digest, url_host_digest) "
+     "VALUES (?, ?, ?, ?)",
+     values);
 }
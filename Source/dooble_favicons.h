@@ -45,6 +45,9 @@ class dooble_favicons
  private:
   dooble_favicons(void);
   static void create_tables(QSqlDatabase &db);
+  static void rewrite(const QSqlDatabase &db,
+		      const QByteArray &bytes,
+		      const qint64 oid);
 };
 
 #endif
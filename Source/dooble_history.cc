@@ -33,10 +33,13 @@
 #include "dooble.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_favicons.h"
 #include "dooble_history.h"
 #include "dooble_ui_utilities.h"
 
+static int s_expired_days = 366;
+
 dooble_history::dooble_history(void):QObject()
 {
   connect(&m_purge_timer,
@@ -147,17 +150,51 @@ void dooble_history::abort(void)
 
 void dooble_history::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
   query.exec("CREATE TABLE IF NOT EXISTS dooble_history ("
+	     "day_digest BLOB, "
 	     "favorite_digest TEXT NOT NULL, "
-	     "last_visited TEXT NOT NULL, "
-	     "number_of_visits TEXT NOT NULL, "
-	     "title TEXT NOT NULL, "
-	     "url TEXT NOT NULL, "
+	     "last_visited BLOB NOT NULL, "
+	     "number_of_visits BLOB NOT NULL, "
+	     "title BLOB NOT NULL, "
+	     "url BLOB NOT NULL, "
 	     "url_digest TEXT PRIMARY KEY NOT NULL)");
+
+  /*
+  ** Older tables lack the day digests.
+  */
+
+  auto day_digest = false;
+
+  if(query.exec("PRAGMA table_info(dooble_history)"))
+    while(query.next())
+      if(query.value(1).toString() == "day_digest")
+	{
+	  day_digest = true;
+	  break;
+	}
+
+  query.finish();
+
+  if(!day_digest)
+    query.exec("ALTER TABLE dooble_history ADD COLUMN day_digest BLOB");
+
+  query.exec
+    ("CREATE INDEX IF NOT EXISTS dooble_history_index_day_digest ON "
+     "dooble_history (day_digest)");
+}
+
+QByteArray dooble_history::day_message(const QDate &date)
+{
+  /*
+  ** Rows are grouped by the days of their visits. The digests of
+  ** the days reveal neither the days nor their order.
+  */
+
+  return "day/" + date.toString(Qt::ISODate).toLatin1();
 }
 
 void dooble_history::populate(const QByteArray &authentication_key,
@@ -174,7 +211,7 @@ void dooble_history::populate(const QByteArray &authentication_key,
 		       QDir::separator() +
 		       "dooble_history.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -185,6 +222,8 @@ void dooble_history::populate(const QByteArray &authentication_key,
 	   encryption_key,
 	   dooble_settings::setting("block_cipher_type").toString(),
 	   dooble_settings::setting("hash_type").toString());
+	auto favorite
+	  (cryptography.memoized_hmac(QByteArray("true")).toBase64());
 
 	query.setForwardOnly(true);
 
@@ -194,125 +233,166 @@ void dooble_history::populate(const QByteArray &authentication_key,
 		      "number_of_visits, " // 2
 		      "title, "            // 3
 		      "url, "              // 4
-		      "url_digest "        // 5
+		      "url_digest, "       // 5
 		      "OID "               // 6
 		      "FROM dooble_history"))
-	  while(query.next())
-	    {
-	      if(m_populate_future.isCanceled())
-		break;
+	  {
+	    /*
+	    ** Rows are read in windows. The fields of a window are
+	    ** decrypted in parallel.
+	    */
+
+	    QVector<QByteArray> favorite_digests;
+	    QVector<QByteArray> last_visited;
+	    QVector<QByteArray> number_of_visits;
+	    QVector<QByteArray> titles;
+	    QVector<QByteArray> url_digests;
+	    QVector<QByteArray> urls;
+	    QVector<qint64> oids;
+	    auto more = true;
+	    const int window = 512;
+
+	    while(more)
+	      {
+		if(m_populate_future.isCanceled())
+		  break;
 
-	      auto last_visited
-		(QByteArray::fromBase64(query.value(1).toByteArray()));
+		favorite_digests.clear();
+		last_visited.clear();
+		number_of_visits.clear();
+		oids.clear();
+		titles.clear();
+		url_digests.clear();
+		urls.clear();
 
-	      last_visited = cryptography.mac_then_decrypt
-		(last_visited);
+		while((more = query.next()))
+		  {
+		    favorite_digests << query.value(0).toByteArray();
+		    last_visited << dooble_database_utilities::blob
+		      (query.value(1));
+		    number_of_visits << dooble_database_utilities::blob
+		      (query.value(2));
+		    titles << dooble_database_utilities::blob(query.value(3));
+		    urls << dooble_database_utilities::blob(query.value(4));
+		    url_digests << QByteArray::fromBase64
+		      (query.value(5).toByteArray());
+		    oids << query.value(6).toLongLong();
+
+		    if(oids.size() >= window)
+		      break;
+		  }
 
-	      if(last_visited.isEmpty())
-		{
-		  dooble_database_utilities::remove_entry
-		    (db,
-		     "dooble_history",
-		     query.value(6).toLongLong());
-		  continue;
-		}
-
-	      auto is_favorite = dooble_cryptography::memcmp
-		(cryptography.hmac(QByteArray("true")).toBase64(),
-		 query.value(0).toByteArray());
-
-	      if(!is_favorite)
-		{
-		  auto date_time
-		    (QDateTime::
-		     fromString(last_visited.constData(), Qt::ISODate));
-		  auto now(QDateTime::currentDateTime());
-
-		  if(date_time.daysTo(now) >= qAbs(days))
-		    /*
-		    ** Ignore an expired entry, unless the entry is a favorite.
-		    */
-
-		    continue;
-		}
-
-	      auto number_of_visits
-		(QByteArray::fromBase64(query.value(2).toByteArray()));
-
-	      number_of_visits = cryptography.mac_then_decrypt
-		(number_of_visits);
-
-	      if(number_of_visits.isEmpty())
-		{
-		  dooble_database_utilities::remove_entry
-		    (db,
-		     "dooble_history",
-		     query.value(6).toLongLong());
-		  continue;
-		}
+		if(oids.isEmpty())
+		  break;
 
-	      auto title
-		(QByteArray::fromBase64(query.value(3).toByteArray()));
+		last_visited = cryptography.mac_then_decrypt_batch
+		  (last_visited);
 
-	      title = cryptography.mac_then_decrypt(title);
+		QVector<QByteArray> fields;
+		QVector<bool> is_favorite(oids.size(), false);
+		QVector<int> indices;
+		auto now(QDateTime::currentDateTime());
 
-	      if(title.isEmpty())
-		{
-		  dooble_database_utilities::remove_entry
-		    (db,
-		     "dooble_history",
-		     query.value(6).toLongLong());
-		  continue;
-		}
+		for(int i = 0; i < oids.size(); i++)
+		  {
+		    if(last_visited.at(i).isEmpty())
+		      {
+			dooble_database_utilities::remove_entry
+			  (db, "dooble_history", oids.at(i));
+			continue;
+		      }
 
-	      auto url
-		(QByteArray::fromBase64(query.value(4).toByteArray()));
+		    is_favorite[i] = dooble_cryptography::memcmp
+		      (favorite, favorite_digests.at(i));
 
-	      url = cryptography.mac_then_decrypt(url);
+		    if(!is_favorite.at(i))
+		      {
+			auto date_time
+			  (QDateTime::
+			   fromString(last_visited.at(i).constData(),
+				      Qt::ISODate));
+
+			if(date_time.daysTo(now) >= qAbs(days))
+			  {
+			    /*
+			    ** Remove an expired entry, unless the entry
+			    ** is a favorite. Purges only examine the
+			    ** most recently expired days.
+			    */
+
+			    dooble_database_utilities::remove_entry
+			      (db, "dooble_history", oids.at(i));
+			    continue;
+			  }
+		      }
 
-	      if(url.isEmpty())
-		{
-		  dooble_database_utilities::remove_entry
-		    (db,
-		     "dooble_history",
-		     query.value(6).toLongLong());
-		  continue;
-		}
-
-	      QHash<dooble_history::HistoryItem, QVariant> hash;
-
-	      hash[dooble_history::HistoryItem::FAVORITE] = is_favorite;
-	      hash[dooble_history::HistoryItem::LAST_VISITED] =
-		QDateTime::fromString
-		(last_visited.constData(), Qt::ISODate);
-	      hash[dooble_history::HistoryItem::NUMBER_OF_VISITS] = qMax
-		(1ULL, number_of_visits.toULongLong());
-	      hash[dooble_history::HistoryItem::TITLE] = title.constData();
-	      hash[dooble_history::HistoryItem::URL] = QUrl::fromEncoded(url);
-	      hash[dooble_history::HistoryItem::URL_DIGEST] =
-		QByteArray::fromBase64(query.value(5).toByteArray());
-
-	      if(is_favorite)
-		{
-		  QVector<QByteArray> vector;
-
-		  vector << title << url << last_visited << number_of_visits;
-		  favorites << vector;
-		}
-
-	      map.insert
-		(hash.value(dooble_history::HistoryItem::LAST_VISITED).
-		 toDateTime(), QPair<QIcon, QString> (QIcon(), url));
-
-	      QWriteLocker locker(&m_history_mutex);
-
-	      m_history[hash.value(dooble_history::HistoryItem::URL).toUrl()] =
-		hash;
-	      m_history_date_time.insert
-		(hash.value(dooble_history::HistoryItem::LAST_VISITED).
-		 toDateTime(),
-		 hash.value(dooble_history::HistoryItem::URL).toUrl());
-	    }
+		    fields << number_of_visits.at(i)
+			   << titles.at(i)
+			   << urls.at(i);
+		    indices << i;
+		  }
+
+		fields = cryptography.mac_then_decrypt_batch(fields);
+
+		for(int j = 0; j < indices.size(); j++)
+		  {
+		    auto i = indices.at(j);
+		    const auto &number_of_visits(fields.at(3 * j));
+		    const auto &title(fields.at(3 * j + 1));
+		    const auto &url(fields.at(3 * j + 2));
+
+		    if(number_of_visits.isEmpty() ||
+		       title.isEmpty() ||
+		       url.isEmpty())
+		      {
+			dooble_database_utilities::remove_entry
+			  (db, "dooble_history", oids.at(i));
+			continue;
+		      }
+
+		    QHash<dooble_history::HistoryItem, QVariant> hash;
+
+		    hash[dooble_history::HistoryItem::FAVORITE] =
+		      is_favorite.at(i);
+		    hash[dooble_history::HistoryItem::LAST_VISITED] =
+		      QDateTime::fromString
+		      (last_visited.at(i).constData(), Qt::ISODate);
+		    hash[dooble_history::HistoryItem::NUMBER_OF_VISITS] = qMax
+		      (1ULL, number_of_visits.toULongLong());
+		    hash[dooble_history::HistoryItem::TITLE] =
+		      title.constData();
+		    hash[dooble_history::HistoryItem::URL] =
+		      QUrl::fromEncoded(url);
+		    hash[dooble_history::HistoryItem::URL_DIGEST] =
+		      url_digests.at(i);
+
+		    if(is_favorite.at(i))
+		      {
+			QVector<QByteArray> vector;
+
+			vector << title
+			       << url
+			       << last_visited.at(i)
+			       << number_of_visits;
+			favorites << vector;
+		      }
+
+		    map.insert
+		      (hash.value(dooble_history::HistoryItem::LAST_VISITED).
+		       toDateTime(), QPair<QIcon, QString> (QIcon(), url));
+
+		    QWriteLocker locker(&m_history_mutex);
+
+		    m_history
+		      [hash.value(dooble_history::HistoryItem::URL).toUrl()] =
+		      hash;
+		    m_history_date_time.insert
+		      (hash.value(dooble_history::HistoryItem::LAST_VISITED).
+		       toDateTime(),
+		       hash.value(dooble_history::HistoryItem::URL).toUrl());
+		  }
+	      }
+	  }
       }
 
     db.close();
@@ -331,7 +411,12 @@ void dooble_history::populate(const QByteArray &authentication_key,
 void dooble_history::purge(const QByteArray &authentication_key,
 			   const QByteArray &encryption_key)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto database_name(dooble_database_utilities::database_name());
+  auto days = qAbs(dooble_settings::setting("browsing_history_days").toInt());
+  auto today(QDate::currentDate());
 
   {
     auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
@@ -340,7 +425,7 @@ void dooble_history::purge(const QByteArray &authentication_key,
 		       QDir::separator() +
 		       "dooble_history.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -350,68 +435,116 @@ void dooble_history::purge(const QByteArray &authentication_key,
 	   encryption_key,
 	   dooble_settings::setting("block_cipher_type").toString(),
 	   dooble_settings::setting("hash_type").toString());
+	auto f(cryptography.memoized_hmac(QByteArray("false")).toBase64());
 
 	query.setForwardOnly(true);
-	query.exec("SELECT last_visited, url, url_digest "
-		   "FROM dooble_history WHERE favorite_digest = ?");
-	query.addBindValue(cryptography.hmac(QByteArray("false")).toBase64());
+	query.prepare("SELECT last_visited, favorite_digest, OID "
+		      "FROM dooble_history WHERE day_digest IS NULL");
 
 	if(query.exec())
 	  {
-	    QListUrl urls;
-	    auto days = dooble_settings::setting
-	      ("browsing_history_days").toInt();
+	    /*
+	    ** Rows which precede the day digests are examined once.
+	    */
+
+	    QSqlQuery update_query(db);
+
+	    update_query.prepare
+	      ("UPDATE dooble_history SET day_digest = ? WHERE OID = ?");
 
 	    while(query.next())
 	      {
 		if(m_interrupt.loadAcquire())
 		  break;
 
-		auto bytes
-		  (QByteArray::fromBase64(query.value(0).toByteArray()));
-
-		bytes = cryptography.mac_then_decrypt(bytes);
-
+		auto bytes(dooble_database_utilities::blob(query.value(0)));
 		auto date_time
-		  (QDateTime::fromString(bytes.constData(), Qt::ISODate));
-		auto now(QDateTime::currentDateTime());
+		  (QDateTime::
+		   fromString(cryptography.mac_then_decrypt(bytes).constData(),
+			      Qt::ISODate));
 
-		if(date_time.daysTo(now) >= qAbs(days))
-		  {
-		    QSqlQuery delete_query(db);
+		/*
+		** A row which cannot be decrypted would never match the
+		** digest of an expired day.
+		*/
 
-		    delete_query.prepare
-		      ("DELETE FROM dooble_history WHERE url_digest = ?");
-		    delete_query.addBindValue(query.value(2));
+		auto expired = !date_time.isValid() ||
+		  date_time.daysTo(QDateTime::currentDateTime()) >= days;
 
-		    if(delete_query.exec())
-		      {
-			bytes = QByteArray::fromBase64
-			  (query.value(1).toByteArray());
-			bytes = dooble::s_cryptography->mac_then_decrypt(bytes);
-
-			if(!bytes.isEmpty())
-			  urls << QUrl::fromUserInput(bytes);
-		      }
+		if(expired &&
+		   dooble_cryptography::memcmp(f, query.value(1).toByteArray()))
+		  dooble_database_utilities::remove_entry
+		    (db, "dooble_history", query.value(2).toLongLong());
+		else if(date_time.isValid())
+		  {
+		    update_query.addBindValue
+		      (cryptography.hmac(day_message(date_time.date())));
+		    update_query.addBindValue(query.value(2));
+		    dooble_database_utilities::exec(db, &update_query);
 		  }
 	      }
+	  }
 
-	    if(!urls.isEmpty())
-	      {
-		emit remove_items(urls);
-		query.exec("VACUUM");
-	      }
+	/*
+	** Expired days are removed by their digests. Earlier purges
+	** have removed older days.
+	*/
+
+	QStringList placeholders;
+	QVector<QByteArray> messages;
+
+	for(int i = 0; i < s_expired_days; i++)
+	  {
+	    messages << day_message(today.addDays(-days - i));
+	    placeholders << "?";
 	  }
+
+	messages = cryptography.hmac_many(messages);
+	query.prepare
+	  (QString("DELETE FROM dooble_history WHERE favorite_digest = ? AND "
+		   "day_digest IN (%1)").arg(placeholders.join(", ")));
+	query.addBindValue(f);
+
+	foreach(const auto &i, messages)
+	  query.addBindValue(i);
+
+	dooble_database_utilities::exec(db, &query);
       }
 
     db.close();
   }
 
   QSqlDatabase::removeDatabase(database_name);
+
+  QListUrl urls;
+
+  {
+    QReadLocker locker(&m_history_mutex);
+    auto it(m_history_date_time.constBegin());
+
+    while(it != m_history_date_time.constEnd() &&
+	  it.key().date().daysTo(today) >= days)
+      {
+	if(!m_history.value(it.value()).
+	   value(dooble_history::HistoryItem::FAVORITE, false).toBool())
+	  urls << it.value();
+
+	++it;
+      }
+  }
+
+  if(!urls.isEmpty())
+    emit remove_items(urls);
 }
 
 void dooble_history::purge_all(void)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->discard
+      (dooble_settings::setting("home_path").toString() +
+       QDir::separator() +
+       "dooble_history.db");
+
   m_favorites_model->removeRows(0, m_favorites_model->rowCount());
 
   QWriteLocker locker(&m_history_mutex);
@@ -420,32 +553,18 @@ void dooble_history::purge_all(void)
   m_history_date_time.clear();
   m_history_mutex.unlock();
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_history.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_history");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_history.db",
+     QStringList() << "DELETE FROM dooble_history");
 }
 
 void dooble_history::purge_favorites(void)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   for(int i = 0; i < m_favorites_model->rowCount(); i++)
     {
       auto item = m_favorites_model->item(i, 1);
@@ -470,8 +589,10 @@ void dooble_history::purge_favorites(void)
   if(dooble::s_cryptography && dooble::s_cryptography->authenticated())
     {
       auto database_name(dooble_database_utilities::database_name());
-      auto f(dooble::s_cryptography->hmac(QByteArray("false")).toBase64());
-      auto t(dooble::s_cryptography->hmac(QByteArray("true")).toBase64());
+      auto f
+	(dooble::s_cryptography->memoized_hmac(QByteArray("false")).toBase64());
+      auto t
+	(dooble::s_cryptography->memoized_hmac(QByteArray("true")).toBase64());
 
       {
 	auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
@@ -480,11 +601,10 @@ void dooble_history::purge_favorites(void)
 			   QDir::separator() +
 			   "dooble_history.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
 	    query.prepare
 	      ("UPDATE dooble_history SET favorite_digest = ? WHERE "
 	       "favorite_digest = ?");
@@ -502,6 +622,9 @@ void dooble_history::purge_favorites(void)
 
 void dooble_history::purge_history(void)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   m_populate_future.cancel();
   m_populate_future.waitForFinished();
 
@@ -527,38 +650,24 @@ void dooble_history::purge_history(void)
 
   if(dooble::s_cryptography && dooble::s_cryptography->authenticated())
     {
-      auto database_name(dooble_database_utilities::database_name());
       auto f
-	(dooble::s_cryptography->hmac(QByteArray("false")).toBase64());
-
-      {
-	auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-	db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-			   QDir::separator() +
-			   "dooble_history.db");
-
-	if(db.open())
-	  {
-	    QSqlQuery query(db);
-
-	    query.exec("PRAGMA synchronous = OFF");
-	    query.prepare
-	      ("DELETE FROM dooble_history WHERE favorite_digest = ?");
-	    query.addBindValue(f);
-	    query.exec();
-	    query.exec("VACUUM");
-	  }
-
-	db.close();
-      }
-
-      QSqlDatabase::removeDatabase(database_name);
+	(dooble::s_cryptography->memoized_hmac(QByteArray("false")).toBase64());
+
+      dooble_database_utilities::purge
+	(dooble_settings::setting("home_path").toString() +
+	 QDir::separator() +
+	 "dooble_history.db",
+	 QStringList()
+	 << "DELETE FROM dooble_history WHERE favorite_digest = ?",
+	 QList<QVariantList> () << (QVariantList() << f));
     }
 }
 
 void dooble_history::remove_favorite(const QUrl &url)
 {
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   auto list(m_favorites_model->findItems(url.toString(), Qt::MatchExactly, 1));
 
   if(!list.isEmpty() && list.at(0))
@@ -588,7 +697,7 @@ void dooble_history::remove_favorite(const QUrl &url)
 			   QDir::separator() +
 			   "dooble_history.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
@@ -596,7 +705,8 @@ void dooble_history::remove_favorite(const QUrl &url)
 	      ("UPDATE dooble_history SET favorite_digest = ? "
 	       "WHERE url_digest = ?");
 	    query.addBindValue
-	      (dooble::s_cryptography->hmac(QByteArray("false")).toBase64());
+	      (dooble::s_cryptography->memoized_hmac(QByteArray("false")).
+	       toBase64());
 	    query.addBindValue
 	      (dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
 	    query.exec();
@@ -614,6 +724,9 @@ void dooble_history::remove_items_list(const QList<QUrl> &urls)
   if(urls.isEmpty())
     return;
 
+  if(dooble::s_database_writer)
+    dooble::s_database_writer->flush();
+
   QList<QByteArray> url_digests;
 
   foreach(const auto &url, urls)
@@ -648,12 +761,10 @@ void dooble_history::remove_items_list(const QList<QUrl> &urls)
 			   QDir::separator() +
 			   "dooble_history.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
-
 	    foreach(const auto &url_digest, url_digests)
 	      {
 		query.prepare
@@ -749,89 +860,76 @@ void dooble_history::save_favorite(const QUrl &url, bool state)
 	m_favorites_model->removeRow(list.at(0)->row());
     }
 
-  if(!dooble::s_cryptography || !dooble::s_cryptography->authenticated())
+  if(!dooble::s_cryptography ||
+     !dooble::s_cryptography->authenticated() ||
+     !dooble::s_database_writer)
     return;
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_history.db");
-
-    if(db.open())
-      {
-	create_tables(db);
-
-	QSqlQuery query(db);
-
-	query.prepare
-	  ("INSERT OR REPLACE INTO dooble_history "
-	   "(favorite_digest, "
-	   "last_visited, "
-	   "number_of_visits, "
-	   "title, "
-	   "url, "
-	   "url_digest) "
-	   "VALUES (?, ?, ?, ?, ?, ?)");
-
-	QByteArray bytes;
-
-	query.addBindValue
-	  (dooble::s_cryptography->
-	   hmac(state ? QByteArray("true") : QByteArray("false")).toBase64());
-	bytes = dooble::s_cryptography->encrypt_then_mac
-	  (hash.
-	   value(dooble_history::HistoryItem::LAST_VISITED).
-	   toDateTime().toString(Qt::ISODate).toUtf8());
-
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
-
-	bytes = dooble::s_cryptography->encrypt_then_mac
-	  (QByteArray::
-	   number(hash.value(dooble_history::HistoryItem::NUMBER_OF_VISITS, 1).
-		  toULongLong()));
-
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  QByteArray bytes;
+  QVariantList values;
+
+  values << dooble::s_cryptography->hmac
+    (day_message(hash.value(dooble_history::HistoryItem::LAST_VISITED).
+		 toDateTime().date()));
+  values << dooble::s_cryptography->hmac
+    (state ? QByteArray("true") : QByteArray("false")).toBase64();
+  bytes = dooble::s_cryptography->encrypt_then_mac
+    (hash.
+     value(dooble_history::HistoryItem::LAST_VISITED).
+     toDateTime().toString(Qt::ISODate).toUtf8());
+
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	if(hash.value(dooble_history::HistoryItem::TITLE).
-	   toString().trimmed().isEmpty())
-	  bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
-	else
-	  bytes = dooble::s_cryptography->encrypt_then_mac
-	    (hash.value(dooble_history::HistoryItem::TITLE).
-	     toString().trimmed().toUtf8());
+  bytes = dooble::s_cryptography->encrypt_then_mac
+    (QByteArray::
+     number(hash.value(dooble_history::HistoryItem::NUMBER_OF_VISITS, 1).
+	    toULongLong()));
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
+  if(hash.value(dooble_history::HistoryItem::TITLE).
+     toString().trimmed().isEmpty())
+    bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
+  else
+    bytes = dooble::s_cryptography->encrypt_then_mac
+      (hash.value(dooble_history::HistoryItem::TITLE).
+       toString().trimmed().toUtf8());
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(url.toEncoded()).toBase64());
-	query.exec();
-      }
+  bytes = dooble::s_cryptography->encrypt_then_mac(url.toEncoded());
 
-  done_label:
-    db.close();
-  }
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-  QSqlDatabase::removeDatabase(database_name);
+  values << dooble::s_cryptography->hmac(url.toEncoded()).toBase64();
+  dooble::s_database_writer->enqueue
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_history.db",
+     &create_tables,
+     values.last().toString(),
+     "INSERT OR REPLACE INTO dooble_history "
+     "(day_digest, "
+     "favorite_digest, "
+     "last_visited, "
+     "number_of_visits, "
+     "title, "
+     "url, "
+     "url_digest) "
+     "VALUES (?, ?, ?, ?, ?, ?, ?)",
+     values);
 }
 
 void dooble_history::save_item(const QIcon &icon,
@@ -895,105 +993,91 @@ void dooble_history::save_item(const QIcon &icon,
   else
     return;
 
-  if(!dooble::s_cryptography || !dooble::s_cryptography->authenticated())
+  if(!dooble::s_cryptography ||
+     !dooble::s_cryptography->authenticated() ||
+     !dooble::s_database_writer)
     return;
   else if(dooble_settings::setting("browsing_history_days").toInt() == 0 &&
 	  !force)
     return;
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_history.db");
+  QByteArray bytes;
+  QVariantList values;
 
-    if(db.open())
-      {
-	create_tables(db);
+  values << dooble::s_cryptography->hmac
+    (day_message(item.lastVisited().date()));
 
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.prepare
-	  ("INSERT OR REPLACE INTO dooble_history "
-	   "(favorite_digest, "
-	   "last_visited, "
-	   "number_of_visits, "
-	   "title, "
-	   "url, "
-	   "url_digest) "
-	   "VALUES (?, ?, ?, ?, ?, ?)");
-
-	QByteArray bytes;
-
-	{
-	  QReadLocker locker(&m_history_mutex);
-
-	  query.addBindValue
-	    (dooble::s_cryptography->
-	     hmac(m_history.
-		  value(item.url()).value(dooble_history::HistoryItem::FAVORITE,
-					  false).toBool() ?
-		  QByteArray("true") : QByteArray("false")).toBase64());
-	}
+  {
+    QReadLocker locker(&m_history_mutex);
 
-	bytes = dooble::s_cryptography->encrypt_then_mac
-	  (item.lastVisited().toString(Qt::ISODate).toUtf8());
+    values << dooble::s_cryptography->hmac
+      (m_history.
+       value(item.url()).value(dooble_history::HistoryItem::FAVORITE,
+			       false).toBool() ?
+       QByteArray("true") : QByteArray("false")).toBase64();
+  }
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  bytes = dooble::s_cryptography->encrypt_then_mac
+    (item.lastVisited().toString(Qt::ISODate).toUtf8());
 
-	{
-	  QReadLocker locker(&m_history_mutex);
-
-	  bytes = dooble::s_cryptography->encrypt_then_mac
-	    (QByteArray::number(m_history.value(item.url()).
-				value(dooble_history::HistoryItem::
-				      NUMBER_OF_VISITS, 1).toULongLong()));
-	}
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  {
+    QReadLocker locker(&m_history_mutex);
 
-	auto title
-	  (hash.value(dooble_history::HistoryItem::TITLE).toString().trimmed());
+    bytes = dooble::s_cryptography->encrypt_then_mac
+      (QByteArray::number(m_history.value(item.url()).
+			  value(dooble_history::HistoryItem::
+				NUMBER_OF_VISITS, 1).toULongLong()));
+  }
 
-	if(title.isEmpty())
-	  bytes = dooble::s_cryptography->encrypt_then_mac
-	    (item.url().toEncoded());
-	else
-	  bytes = dooble::s_cryptography->encrypt_then_mac(title.toUtf8());
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  auto title
+    (hash.value(dooble_history::HistoryItem::TITLE).toString().trimmed());
 
-	bytes = dooble::s_cryptography->encrypt_then_mac
-	  (item.url().toEncoded());
+  if(title.isEmpty())
+    bytes = dooble::s_cryptography->encrypt_then_mac
+      (item.url().toEncoded());
+  else
+    bytes = dooble::s_cryptography->encrypt_then_mac(title.toUtf8());
 
-	if(!bytes.isEmpty())
-	  query.addBindValue(bytes.toBase64());
-	else
-	  goto done_label;
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-	query.addBindValue
-	  (dooble::s_cryptography->hmac(item.url().toEncoded()).toBase64());
-	query.exec();
-      }
+  bytes = dooble::s_cryptography->encrypt_then_mac
+    (item.url().toEncoded());
 
-  done_label:
-    db.close();
-  }
+  if(!bytes.isEmpty())
+    values << bytes;
+  else
+    return;
 
-  QSqlDatabase::removeDatabase(database_name);
+  values << dooble::s_cryptography->hmac(item.url().toEncoded()).toBase64();
+  dooble::s_database_writer->enqueue
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_history.db",
+     &create_tables,
+     values.last().toString(),
+     "INSERT OR REPLACE INTO dooble_history "
+     "(day_digest, "
+     "favorite_digest, "
+     "last_visited, "
+     "number_of_visits, "
+     "title, "
+     "url, "
+     "url_digest) "
+     "VALUES (?, ?, ?, ?, ?, ?, ?)",
+     values);
 }
 
 void dooble_history::slot_populate(void)
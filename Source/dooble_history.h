@@ -65,6 +65,7 @@ class dooble_history: public QObject
   QList<QAction *> last_n_actions(int n) const;
   QStandardItemModel *favorites_model(void) const;
   bool is_favorite(const QUrl &url) const;
+  static QByteArray day_message(const QDate &date);
   void abort(void);
   void purge_all(void);
   void purge_favorites(void);
@@ -86,7 +87,7 @@ class dooble_history: public QObject
   QStandardItemModel *m_favorites_model;
   QTimer m_purge_timer;
   mutable QReadWriteLock m_history_mutex;
-  void create_tables(QSqlDatabase &db);
+  static void create_tables(QSqlDatabase &db);
   void populate(const QByteArray &authentication_key,
 		const QByteArray &encryption_key);
   void purge(const QByteArray &authentication_key,
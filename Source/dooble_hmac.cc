@@ -31,58 +31,131 @@
 #endif
 #include <QtDebug>
 
+#ifdef DOOBLE_MMAN_PRESENT
+extern "C"
+{
+#include <sys/mman.h>
+}
+#endif
+
+#include "dooble_cryptography.h"
 #include "dooble_hmac.h"
 
-QByteArray dooble_hmac::keccak_512_hmac(const QByteArray &key,
-					const QByteArray &message)
+dooble_hmac::dooble_hmac(const QByteArray &key,
+			 const dooble_hmac::Algorithms algorithm):
+  m_inner_hash(hash_algorithm(algorithm))
 {
-  /*
-  ** Please read https://keccak.team/keccak_strengths.html.
-  ** Unlike SHA-1 and SHA-2, Keccak does not have the length-extension
-  ** weakness, hence does not need the HMAC nested construction. Instead,
-  ** MAC computation can be performed by simply prepending the message
-  ** with the key.
-  */
+  m_algorithm = algorithm;
+  m_hash_algorithm = hash_algorithm(algorithm);
+
+  if(m_algorithm == dooble_hmac::Algorithms::KECCAK_512)
+    {
+      /*
+      ** Please read https://keccak.team/keccak_strengths.html.
+      ** Unlike SHA-1 and SHA-2, Keccak does not have the length-extension
+      ** weakness, hence does not need the HMAC nested construction.
+      ** Instead, MAC computation can be performed by simply prepending
+      ** the message with the key.
+      */
+
+      m_inner_pad = key;
+    }
+  else
+    {
+      /*
+      ** The padded keys are prepared once. Messages are absorbed
+      ** directly behind them.
+      */
+
+      auto block_length = this->block_length(m_algorithm);
+      auto k(key);
+
+      if(block_length < k.length())
+	k = QCryptographicHash::hash(k, m_hash_algorithm);
+
+      m_inner_pad = QByteArray(block_length, 0x36);
+      m_outer_pad = QByteArray(block_length, 0x5c);
+
+      for(int i = 0; i < k.length(); i++)
+	{
+	  m_inner_pad[i] = static_cast<char> (m_inner_pad.at(i) ^ k.at(i));
+	  m_outer_pad[i] = static_cast<char> (m_outer_pad.at(i) ^ k.at(i));
+	}
+
+      dooble_cryptography::memzero(k);
+    }
+
+#ifdef DOOBLE_MMAN_PRESENT
+  mlock(m_inner_pad.constData(), static_cast<size_t> (m_inner_pad.length()));
+  mlock(m_outer_pad.constData(), static_cast<size_t> (m_outer_pad.length()));
+#endif
+  m_inner_hash.addData(m_inner_pad);
+}
 
-  return QCryptographicHash::hash
-    (key + message, QCryptographicHash::Keccak_512);
+dooble_hmac::~dooble_hmac()
+{
+  dooble_cryptography::memzero(m_inner_pad);
+  dooble_cryptography::memzero(m_outer_pad);
+#ifdef DOOBLE_MMAN_PRESENT
+  munlock(m_inner_pad.constData(),
+	  static_cast<size_t> (m_inner_pad.length()));
+  munlock(m_outer_pad.constData(),
+	  static_cast<size_t> (m_outer_pad.length()));
+#endif
 }
 
-QByteArray dooble_hmac::sha2_512_hmac(const QByteArray &key,
-				      const QByteArray &message)
+QByteArray dooble_hmac::finalize(QCryptographicHash &inner_hash) const
 {
-#ifdef DOOBLE_HMAC
-  /*
-  ** Block length is 1024 bits.
-  ** Please read https://en.wikipedia.org/wiki/SHA-2.
-  */
+  if(m_algorithm == dooble_hmac::Algorithms::KECCAK_512)
+    return inner_hash.result();
 
-  auto k(key);
-  static auto block_length = 1024 / CHAR_BIT;
+  QCryptographicHash outer_hash(m_hash_algorithm);
 
-  if(block_length < k.length())
-    k = QCryptographicHash::hash(k, QCryptographicHash::Sha512);
+  outer_hash.addData(m_outer_pad);
+  outer_hash.addData(inner_hash.result());
+  return outer_hash.result();
+}
 
-  if(block_length > k.length())
-    k.append(QByteArray(block_length - k.length(), 0));
+QByteArray dooble_hmac::hmac(const QByteArray &message) const
+{
+  return hmac(message.constData(), message.length());
+}
 
-  static QByteArray ipad(block_length, 0x36);
-  static QByteArray opad(block_length, 0x5c);
+QByteArray dooble_hmac::hmac(const char *message, const int length) const
+{
+  QCryptographicHash inner_hash(m_hash_algorithm);
 
-  QByteArray left(block_length, 0);
+  inner_hash.addData(m_inner_pad);
 
-  for(int i = 0; i < block_length; i++)
-    left[i] = static_cast<char> (k.at(i) ^ opad.at(i));
+  if(Q_LIKELY(length > 0 && message))
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 4, 0))
+    inner_hash.addData(QByteArrayView(message, length));
+#else
+    inner_hash.addData(message, length);
+#endif
+
+  return finalize(inner_hash);
+}
+
+QByteArray dooble_hmac::keccak_512_hmac(const QByteArray &key,
+					const QByteArray &message)
+{
+  return dooble_hmac(key, dooble_hmac::Algorithms::KECCAK_512).hmac(message);
+}
 
-  QByteArray right(block_length, 0);
+QByteArray dooble_hmac::result(void)
+{
+  auto bytes(finalize(m_inner_hash));
 
-  for(int i = 0; i < block_length; i++)
-    right[i] = static_cast<char> (k.at(i) ^ ipad.at(i));
+  reset();
+  return bytes;
+}
 
-  return QCryptographicHash::hash
-    (left.append(QCryptographicHash::hash(right.append(message),
-					  QCryptographicHash::Sha512)),
-     QCryptographicHash::Sha512);
+QByteArray dooble_hmac::sha2_512_hmac(const QByteArray &key,
+				      const QByteArray &message)
+{
+#ifdef DOOBLE_HMAC
+  return dooble_hmac(key, dooble_hmac::Algorithms::SHA2_512).hmac(message);
 #else
   QMessageAuthenticationCode message_authentication_code
     (QCryptographicHash::Sha512);
@@ -97,37 +170,7 @@ QByteArray dooble_hmac::sha3_512_hmac(const QByteArray &key,
 				      const QByteArray &message)
 {
 #ifdef DOOBLE_HMAC
-  /*
-  ** Block length is 576 bits.
-  ** Please read https://en.wikipedia.org/wiki/SHA-3.
-  */
-
-  auto k(key);
-  static auto block_length = 576 / CHAR_BIT;
-
-  if(block_length < k.length())
-    k = QCryptographicHash::hash(k, QCryptographicHash::Sha3_512);
-
-  if(block_length > k.length())
-    k.append(QByteArray(block_length - k.length(), 0));
-
-  static QByteArray ipad(block_length, 0x36);
-  static QByteArray opad(block_length, 0x5c);
-
-  QByteArray left(block_length, 0);
-
-  for(int i = 0; i < block_length; i++)
-    left[i] = static_cast<char> (k.at(i) ^ opad.at(i));
-
-  QByteArray right(block_length, 0);
-
-  for(int i = 0; i < block_length; i++)
-    right[i] = static_cast<char> (k.at(i) ^ ipad.at(i));
-
-  return QCryptographicHash::hash
-    (left.append(QCryptographicHash::hash(right.append(message),
-					  QCryptographicHash::Sha3_512)),
-     QCryptographicHash::Sha3_512);
+  return dooble_hmac(key, dooble_hmac::Algorithms::SHA3_512).hmac(message);
 #else
   QMessageAuthenticationCode message_authentication_code
     (QCryptographicHash::Sha3_512);
@@ -138,6 +181,58 @@ QByteArray dooble_hmac::sha3_512_hmac(const QByteArray &key,
 #endif
 }
 
+QCryptographicHash::Algorithm dooble_hmac::hash_algorithm
+(const dooble_hmac::Algorithms algorithm)
+{
+  switch(algorithm)
+    {
+    case dooble_hmac::Algorithms::KECCAK_512:
+      return QCryptographicHash::Keccak_512;
+    case dooble_hmac::Algorithms::SHA2_512:
+      return QCryptographicHash::Sha512;
+    default:
+      return QCryptographicHash::Sha3_512;
+    }
+}
+
+QVector<QByteArray> dooble_hmac::hmac_many
+(const QVector<QByteArray> &messages) const
+{
+  QVector<QByteArray> vector;
+
+  vector.reserve(messages.size());
+
+  for(const auto &message : messages)
+    vector << hmac(message);
+
+  return vector;
+}
+
+int dooble_hmac::block_length(const dooble_hmac::Algorithms algorithm)
+{
+  switch(algorithm)
+    {
+    case dooble_hmac::Algorithms::SHA2_512:
+      {
+	/*
+	** Block length is 1024 bits.
+	** Please read https://en.wikipedia.org/wiki/SHA-2.
+	*/
+
+	return 1024 / CHAR_BIT;
+      }
+    default:
+      {
+	/*
+	** Block length is 576 bits.
+	** Please read https://en.wikipedia.org/wiki/SHA-3.
+	*/
+
+	return 576 / CHAR_BIT;
+      }
+    }
+}
+
 int dooble_hmac::preferred_output_size_in_bits(void)
 {
   return 512;
@@ -179,3 +274,69 @@ void dooble_hmac::sha3_512_hmac_test2(void)
 
   qDebug() << sha3_512_hmac(key, message).toHex();
 }
+
+void dooble_hmac::add_data(const QByteArray &data)
+{
+  m_inner_hash.addData(data);
+}
+
+void dooble_hmac::add_data(const char *data, const int length)
+{
+  if(Q_LIKELY(data && length > 0))
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 4, 0))
+    m_inner_hash.addData(QByteArrayView(data, length));
+#else
+    m_inner_hash.addData(data, length);
+#endif
+}
+
+void dooble_hmac::reset(void)
+{
+  m_inner_hash.reset();
+  m_inner_hash.addData(m_inner_pad);
+}
+
+void dooble_hmac::test1(void)
+{
+  /*
+  ** The keyed object must agree with the NIST vectors and with
+  ** itself when messages are supplied in pieces.
+  */
+
+  auto key(QByteArray::fromHex("000102030405060708090a0b0c0d0e0f"
+			       "101112131415161718191a1b1c1d1e1f"
+			       "202122232425262728292a2b2c2d2e2f"
+			       "303132333435363738393a3b3c3d3e3f"));
+  auto message(QByteArray::fromHex("53616d706c65206d6573736167652066"
+				   "6f72206b65796c656e3c626c6f636b6c"
+				   "656e"));
+  dooble_hmac hmac(key, dooble_hmac::Algorithms::SHA3_512);
+
+  hmac.add_data(message.mid(0, 7));
+  hmac.add_data(message.constData() + 7, message.length() - 7);
+
+  auto bytes(hmac.result());
+
+  qDebug() << (bytes ==
+	       QByteArray::fromHex("4efd629d6c71bf86162658f29943b1c3"
+				   "08ce27cdfa6db0d9c3ce81763f9cbce5"
+				   "f7ebe9868031db1a8f8eb7b6b95e5c5e"
+				   "3f657a8996c86a2f6527e307f0213196"));
+  qDebug() << (bytes == hmac.hmac(message) &&
+	       bytes == hmac.hmac_many(QVector<QByteArray> () << message).
+	       value(0) &&
+	       bytes == sha3_512_hmac(key, message));
+
+  for(int i = 0; i < 3; i++)
+    {
+      auto algorithm = static_cast<dooble_hmac::Algorithms> (i);
+      dooble_hmac h(key, algorithm);
+
+      qDebug() << (h.hmac(message) ==
+		   (algorithm == dooble_hmac::Algorithms::KECCAK_512 ?
+		    keccak_512_hmac(key, message) :
+		    algorithm == dooble_hmac::Algorithms::SHA2_512 ?
+		    sha2_512_hmac(key, message) :
+		    sha3_512_hmac(key, message)));
+    }
+}
@@ -29,10 +29,25 @@
 #define dooble_hmac_h
 
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <QVector>
 
 class dooble_hmac
 {
  public:
+  enum Algorithms
+    {
+     KECCAK_512,
+     SHA2_512,
+     SHA3_512
+    };
+
+  dooble_hmac(const QByteArray &key, const dooble_hmac::Algorithms algorithm);
+  ~dooble_hmac();
+  QByteArray hmac(const QByteArray &message) const;
+  QByteArray hmac(const char *message, const int length) const;
+  QByteArray result(void);
+  QVector<QByteArray> hmac_many(const QVector<QByteArray> &messages) const;
   static QByteArray keccak_512_hmac(const QByteArray &key,
 				    const QByteArray &message);
   static QByteArray sha2_512_hmac(const QByteArray &key,
@@ -43,9 +58,22 @@ class dooble_hmac
   static int preferred_output_size_in_bytes(void);
   static void sha3_512_hmac_test1(void);
   static void sha3_512_hmac_test2(void);
+  static void test1(void);
+  void add_data(const QByteArray &data);
+  void add_data(const char *data, const int length);
+  void reset(void);
 
  private:
+  QByteArray m_inner_pad;
+  QByteArray m_outer_pad;
+  QCryptographicHash m_inner_hash;
+  QCryptographicHash::Algorithm m_hash_algorithm;
+  dooble_hmac::Algorithms m_algorithm;
   dooble_hmac(void);
+  QByteArray finalize(QCryptographicHash &inner_hash) const;
+  static QCryptographicHash::Algorithm hash_algorithm
+    (const dooble_hmac::Algorithms algorithm);
+  static int block_length(const dooble_hmac::Algorithms algorithm);
 };
 
 #endif
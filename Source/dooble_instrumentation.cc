@@ -0,0 +1,328 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMultiMap>
+
+#include "dooble_instrumentation.h"
+
+QHash<QPair<QString, QString>, dooble_instrumentation_histogram *>
+dooble_instrumentation::s_statements;
+QMutex dooble_instrumentation::s_mutex;
+dooble_instrumentation_histogram dooble_instrumentation::s_decryption;
+dooble_instrumentation_histogram dooble_instrumentation::s_encryption;
+int dooble_instrumentation::s_maximum_statements = 1024;
+
+static quint64 load(const QAtomicInteger<quint64> &integer)
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  return integer.load();
+#else
+  return integer.loadRelaxed();
+#endif
+}
+
+static void store(QAtomicInteger<quint64> &integer, quint64 value)
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  integer.store(value);
+#else
+  integer.storeRelaxed(value);
+#endif
+}
+
+dooble_instrumentation_histogram::dooble_instrumentation_histogram(void)
+{
+  reset();
+}
+
+QJsonObject dooble_instrumentation_histogram::json(void) const
+{
+  QJsonArray buckets;
+  QJsonObject object;
+
+  for(int i = 0; i < BUCKETS; i++)
+    buckets << static_cast<double> (load(m_buckets[i]));
+
+  object["buckets"] = buckets;
+  object["bytes"] = static_cast<double> (load(m_bytes));
+  object["count"] = static_cast<double> (load(m_count));
+  object["maximum_microseconds"] =
+    static_cast<double> (load(m_maximum)) / 1000.0;
+  object["total_microseconds"] =
+    static_cast<double> (load(m_nanoseconds)) / 1000.0;
+  return object;
+}
+
+quint64 dooble_instrumentation_histogram::nanoseconds(void) const
+{
+  return load(m_nanoseconds);
+}
+
+void dooble_instrumentation_histogram::record(qint64 nanoseconds,
+					      qint64 bytes)
+{
+  auto n = static_cast<quint64> (qMax(static_cast<qint64> (0), nanoseconds));
+  auto maximum = load(m_maximum);
+  auto microseconds = n / 1000;
+  int i = 0;
+
+  while(microseconds > 0 && i < BUCKETS - 1)
+    {
+      i += 1;
+      microseconds >>= 1;
+    }
+
+  m_buckets[i].fetchAndAddRelaxed(1);
+  m_bytes.fetchAndAddRelaxed
+    (static_cast<quint64> (qMax(static_cast<qint64> (0), bytes)));
+  m_count.fetchAndAddRelaxed(1);
+  m_nanoseconds.fetchAndAddRelaxed(n);
+
+  while(n > maximum && !m_maximum.testAndSetRelaxed(maximum, n, maximum))
+    ;
+}
+
+void dooble_instrumentation_histogram::reset(void)
+{
+  for(int i = 0; i < BUCKETS; i++)
+    store(m_buckets[i], 0);
+
+  store(m_bytes, 0);
+  store(m_count, 0);
+  store(m_maximum, 0);
+  store(m_nanoseconds, 0);
+}
+
+QByteArray dooble_instrumentation::html(void)
+{
+  /*
+  ** The statements are ordered by their total durations.
+  */
+
+  QMultiMap<double, QJsonObject> map;
+  QString html;
+  auto object(json());
+
+  foreach(const auto &value, object.value("statements").toArray())
+    map.insert
+      (-value.toObject().value("total_microseconds").toDouble(),
+       value.toObject());
+
+  html.append("<html><head><title>Dooble Instrumentation</title>");
+  html.append("<style>td, th {padding: 2px 8px; text-align: right;} ");
+  html.append("td.text, th.text {text-align: left;}</style></head><body>");
+  html.append("<h2>Dooble Instrumentation</h2>");
+  html.append("<p>Durations are in microseconds. Bucket i counts ");
+  html.append("durations of fewer than 2<sup>i</sup> microseconds. ");
+  html.append("<a href=\"dooble://instrumentation/json\">JSON</a></p>");
+  html.append("<h3>Cryptography</h3><table><tr><th class=\"text\">");
+  html.append("Operation</th><th>Count</th><th>Bytes</th><th>Total</th>");
+  html.append("<th>Maximum</th><th class=\"text\">Buckets</th></tr>");
+
+  QStringList operations;
+
+  operations << "decryption" << "encryption";
+
+  foreach(const auto &operation, operations)
+    {
+      auto value(object.value("cryptography").toObject().value(operation).
+		 toObject());
+      QStringList buckets;
+
+      foreach(const auto &bucket, value.value("buckets").toArray())
+	buckets << QString::number(bucket.toDouble(), 'f', 0);
+
+      html.append
+	(QString("<tr><td class=\"text\">%1</td><td>%2</td><td>%3</td>"
+		 "<td>%4</td><td>%5</td><td class=\"text\">%6</td></tr>").
+	 arg(operation).
+	 arg(value.value("count").toDouble(), 0, 'f', 0).
+	 arg(value.value("bytes").toDouble(), 0, 'f', 0).
+	 arg(value.value("total_microseconds").toDouble(), 0, 'f', 0).
+	 arg(value.value("maximum_microseconds").toDouble(), 0, 'f', 0).
+	 arg(buckets.join(" ")));
+    }
+
+  html.append("</table><h3>Statements</h3><table><tr><th class=\"text\">");
+  html.append("Database</th><th class=\"text\">Statement</th>");
+  html.append("<th>Count</th><th>Total</th><th>Maximum</th>");
+  html.append("<th class=\"text\">Buckets</th></tr>");
+
+  foreach(const auto &value, map.values())
+    {
+      QStringList buckets;
+
+      foreach(const auto &bucket, value.value("buckets").toArray())
+	buckets << QString::number(bucket.toDouble(), 'f', 0);
+
+      html.append
+	(QString("<tr><td class=\"text\">%1</td><td class=\"text\">%2</td>"
+		 "<td>%3</td><td>%4</td><td>%5</td>"
+		 "<td class=\"text\">%6</td></tr>").
+	 arg(value.value("database").toString().toHtmlEscaped()).
+	 arg(value.value("statement").toString().toHtmlEscaped()).
+	 arg(value.value("count").toDouble(), 0, 'f', 0).
+	 arg(value.value("total_microseconds").toDouble(), 0, 'f', 0).
+	 arg(value.value("maximum_microseconds").toDouble(), 0, 'f', 0).
+	 arg(buckets.join(" ")));
+    }
+
+  html.append("</table></body></html>");
+  return html.toUtf8();
+}
+
+QJsonObject dooble_instrumentation::json(void)
+{
+  QJsonArray statements;
+  QJsonObject cryptography;
+  QJsonObject object;
+
+  {
+    QMutexLocker locker(&s_mutex);
+    QHashIterator<QPair<QString, QString>,
+		  dooble_instrumentation_histogram *> it(s_statements);
+
+    while(it.hasNext())
+      {
+	it.next();
+
+	auto value(it.value()->json());
+
+	if(value.value("count").toDouble() <= 0)
+	  continue;
+
+	value["database"] = QFileInfo(it.key().first).fileName();
+	value["statement"] = it.key().second;
+	statements << value;
+      }
+  }
+
+  cryptography["decryption"] = s_decryption.json();
+  cryptography["encryption"] = s_encryption.json();
+  object["cryptography"] = cryptography;
+  object["statements"] = statements;
+  return object;
+}
+
+bool dooble_instrumentation::save(const QString &file_name)
+{
+  QFile file(file_name);
+
+  if(file.open(QIODevice::Truncate | QIODevice::WriteOnly))
+    return file.write(QJsonDocument(json()).toJson()) > 0;
+  else
+    return false;
+}
+
+dooble_instrumentation_histogram *dooble_instrumentation::histogram
+(const QString &file_name, const QString &statement)
+{
+  /*
+  ** Statements beyond the limit are counted together so that
+  ** generated statements do not grow the table without bounds.
+  ** Histograms are never deleted, so callers may retain them.
+  */
+
+  auto key(qMakePair(file_name, statement));
+  QMutexLocker locker(&s_mutex);
+  auto histogram = s_statements.value(key);
+
+  if(!histogram)
+    {
+      if(s_statements.size() >= s_maximum_statements)
+	key.second = QObject::tr("(other)");
+
+      histogram = s_statements.value(key);
+
+      if(!histogram)
+	{
+	  histogram = new dooble_instrumentation_histogram();
+	  s_statements[key] = histogram;
+	}
+    }
+
+  return histogram;
+}
+
+void dooble_instrumentation::record(const QString &file_name,
+				    const QString &statement,
+				    const QElapsedTimer &timer)
+{
+  auto nanoseconds = timer.nsecsElapsed();
+
+  histogram(file_name, statement)->record(nanoseconds, 0);
+}
+
+void dooble_instrumentation::record
+(dooble_instrumentation_histogram *histogram, const QElapsedTimer &timer)
+{
+  /*
+  ** Lock-free. Please see histogram().
+  */
+
+  if(Q_LIKELY(histogram))
+    histogram->record(timer.nsecsElapsed(), 0);
+}
+
+void dooble_instrumentation::record
+(dooble_instrumentation::Cryptography operation,
+ qint64 bytes,
+ const QElapsedTimer &timer)
+{
+  switch(operation)
+    {
+    case dooble_instrumentation::Cryptography::DECRYPTION:
+      {
+	s_decryption.record(timer.nsecsElapsed(), bytes);
+	break;
+      }
+    case dooble_instrumentation::Cryptography::ENCRYPTION:
+      {
+	s_encryption.record(timer.nsecsElapsed(), bytes);
+	break;
+      }
+    }
+}
+
+void dooble_instrumentation::reset(void)
+{
+  /*
+  ** The histograms may be retained by callers and are reset in place.
+  */
+
+  QMutexLocker locker(&s_mutex);
+
+  foreach(auto histogram, s_statements.values())
+    histogram->reset();
+
+  s_decryption.reset();
+  s_encryption.reset();
+}
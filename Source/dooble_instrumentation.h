@@ -0,0 +1,100 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef dooble_instrumentation_h
+#define dooble_instrumentation_h
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+class dooble_instrumentation_histogram
+{
+  /*
+  ** Bucket i counts the durations of at least 2^(i - 1) and fewer
+  ** than 2^i microseconds. The last bucket is unbounded.
+  */
+
+ public:
+  enum
+    {
+     BUCKETS = 22
+    };
+
+  dooble_instrumentation_histogram(void);
+  QJsonObject json(void) const;
+  quint64 nanoseconds(void) const;
+  void record(qint64 nanoseconds, qint64 bytes);
+  void reset(void);
+
+ private:
+  QAtomicInteger<quint64> m_buckets[BUCKETS];
+  QAtomicInteger<quint64> m_bytes;
+  QAtomicInteger<quint64> m_count;
+  QAtomicInteger<quint64> m_maximum;
+  QAtomicInteger<quint64> m_nanoseconds;
+};
+
+class dooble_instrumentation
+{
+ public:
+  enum class Cryptography
+    {
+     DECRYPTION = 0,
+     ENCRYPTION
+    };
+
+  static QByteArray html(void);
+  static QJsonObject json(void);
+  static bool save(const QString &file_name);
+  static dooble_instrumentation_histogram *histogram
+    (const QString &file_name, const QString &statement);
+  static void record(const QString &file_name,
+		     const QString &statement,
+		     const QElapsedTimer &timer);
+  static void record(dooble_instrumentation_histogram *histogram,
+		     const QElapsedTimer &timer);
+  static void record(dooble_instrumentation::Cryptography operation,
+		     qint64 bytes,
+		     const QElapsedTimer &timer);
+  static void reset(void);
+
+ private:
+  static QHash<QPair<QString, QString>, dooble_instrumentation_histogram *>
+    s_statements;
+  static QMutex s_mutex;
+  static dooble_instrumentation_histogram s_decryption;
+  static dooble_instrumentation_histogram s_encryption;
+  static int s_maximum_statements;
+  dooble_instrumentation(void);
+};
+
+#endif
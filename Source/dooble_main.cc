@@ -53,15 +53,21 @@ extern "C"
 #include "dooble.h"
 #include "dooble_accepted_or_blocked_domains.h"
 #include "dooble_aes256.h"
+#include "dooble_aes256_gcm.h"
 #include "dooble_application.h"
 #include "dooble_certificate_exceptions.h"
 #include "dooble_certificate_exceptions_menu_widget.h"
 #include "dooble_charts.h"
 #include "dooble_cookies.h"
 #include "dooble_cookies_window.h"
+#include "dooble_cryptography.h"
+#include "dooble_database_rekey.h"
+#include "dooble_domain_matcher.h"
 #include "dooble_downloads.h"
 #include "dooble_favicons.h"
 #include "dooble_history.h"
+#include "dooble_hmac.h"
+#include "dooble_pbkdf2.h"
 #include "dooble_random.h"
 #include "dooble_search_engines_popup.h"
 #include "dooble_style_sheet.h"
@@ -93,9 +99,12 @@ int main(int argc, char *argv[])
 
   QList<QUrl> urls;
   auto test_aes = false;
-  auto test_aes_performance = false;
+  auto test_cryptography = false;
+  auto test_database_rekey = false;
+  auto test_domain_matcher = false;
+  auto test_hmac = false;
+  auto test_pbkdf2 = false;
   auto test_threefish = false;
-  auto test_threefish_performance = false;
 
   for(int i = 1; i < argc; i++)
     if(argv && argv[i])
@@ -114,12 +123,18 @@ int main(int argc, char *argv[])
 	  }
 	else if(strcmp(argv[i], "--test-aes") == 0)
 	  test_aes = true;
-	else if(strcmp(argv[i], "--test-aes-performance") == 0)
-	  test_aes_performance = true;
+	else if(strcmp(argv[i], "--test-cryptography") == 0)
+	  test_cryptography = true;
+	else if(strcmp(argv[i], "--test-database-rekey") == 0)
+	  test_database_rekey = true;
+	else if(strcmp(argv[i], "--test-domain-matcher") == 0)
+	  test_domain_matcher = true;
+	else if(strcmp(argv[i], "--test-hmac") == 0)
+	  test_hmac = true;
+	else if(strcmp(argv[i], "--test-pbkdf2") == 0)
+	  test_pbkdf2 = true;
 	else if(strcmp(argv[i], "--test-threefish") == 0)
 	  test_threefish = true;
-	else if(strcmp(argv[i], "--test-threefish-performance") == 0)
-	  test_threefish_performance = true;
 	else
 	  {
 	    QUrl url(QUrl::fromUserInput(argv[i]));
@@ -135,21 +150,40 @@ int main(int argc, char *argv[])
       dooble_aes256::test1_encrypt_block();
       dooble_aes256::test1_decrypt_block();
       dooble_aes256::test1_key_expansion();
+      dooble_aes256_gcm::test1();
+      dooble_aes256_gcm::test2();
     }
 
-  if(test_aes_performance)
-    dooble_aes256::test_performance();
+  if(test_cryptography)
+    dooble_cryptography::test1();
+
+  if(test_database_rekey)
+    dooble_database_rekey::test1();
+
+  if(test_domain_matcher)
+    dooble_domain_matcher::test1();
+
+  if(test_hmac)
+    {
+      dooble_hmac::sha3_512_hmac_test1();
+      dooble_hmac::sha3_512_hmac_test2();
+      dooble_hmac::test1();
+    }
+
+  if(test_pbkdf2)
+    {
+      dooble_pbkdf2::test1();
+      dooble_pbkdf2::test2();
+    }
 
   if(test_threefish)
     {
       dooble_threefish256::test1();
       dooble_threefish256::test2();
       dooble_threefish256::test3();
+      dooble_threefish256::test4();
     }
 
-  if(test_threefish_performance)
-    dooble_threefish256::test_performance();
-
 #ifdef Q_OS_MACOS
   struct rlimit rlim = {0, 0};
 
@@ -231,6 +265,15 @@ int main(int argc, char *argv[])
 #endif
 #endif
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
+  {
+    QWebEngineUrlScheme scheme("dooble");
+
+    scheme.setFlags(QWebEngineUrlScheme::LocalScheme |
+		    QWebEngineUrlScheme::LocalAccessAllowed);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+    QWebEngineUrlScheme::registerScheme(scheme);
+  }
+
 #ifdef DOOBLE_REGISTER_GOPHER_SCHEME
   QWebEngineUrlScheme scheme("gopher");
 
@@ -25,6 +25,9 @@
 ** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <QFuture>
+#include <QScopedPointer>
+#include <QtConcurrent>
 #include <QtDebug>
 #include <QtEndian>
 #include <QtMath>
@@ -41,7 +44,7 @@ dooble_pbkdf2::dooble_pbkdf2
  int iterations_count,
  int output_size):QObject()
 {
-  m_block_cipher_type_index = qBound(0, block_cipher_type_index, 1);
+  m_block_cipher_type_index = qBound(0, block_cipher_type_index, 2);
   m_hash_type_index = qBound(0, hash_type_index, 1);
 #if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
   m_interrupt.store(0);
@@ -66,21 +69,48 @@ QByteArray dooble_pbkdf2::salt(void) const
   return m_salt;
 }
 
-QByteArray dooble_pbkdf2::x_or(const QByteArray &a, const QByteArray &b) const
+QByteArray dooble_pbkdf2::block
+(QByteArray (*function) (const QByteArray &key,
+			 const QByteArray &message),
+ const int i) const
 {
-  QByteArray c(qMin(a.length(), b.length()), 0);
+  /*
+  ** Compute T_i. The password's padded keys are prepared once if the
+  ** PRF is one of Dooble's.
+  */
 
-  for(int i = 0; i < c.length(); i++)
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-    if(m_interrupt.load())
-#else
-    if(m_interrupt.loadRelaxed())
-#endif
-      return QByteArray();
-    else
-      c[i] = static_cast<char> (a.at(i) ^ b.at(i));
+  QScopedPointer<dooble_hmac> hmac;
+
+  if(function == &dooble_hmac::keccak_512_hmac)
+    hmac.reset
+      (new dooble_hmac(m_password, dooble_hmac::Algorithms::KECCAK_512));
+  else if(function == &dooble_hmac::sha2_512_hmac)
+    hmac.reset
+      (new dooble_hmac(m_password, dooble_hmac::Algorithms::SHA2_512));
+  else if(function == &dooble_hmac::sha3_512_hmac)
+    hmac.reset
+      (new dooble_hmac(m_password, dooble_hmac::Algorithms::SHA3_512));
+
+  QByteArray INT_32_BE_i(static_cast<int> (sizeof(int)), 0);
+  QByteArray U;
+  QByteArray Ua;
 
-  return c;
+  qToBigEndian(i, INT_32_BE_i.data());
+  U = Ua = hmac ?
+    hmac->hmac(QByteArray(m_salt).append(INT_32_BE_i)) :
+    function(m_password, QByteArray(m_salt).append(INT_32_BE_i));
+
+  for(int j = 2; j <= m_iteration_count; j++)
+    {
+      if(interrupted())
+	return QByteArray();
+
+      Ua = hmac ? hmac->hmac(Ua) : function(m_password, Ua);
+      x_or(U, Ua);
+    }
+
+  dooble_cryptography::memzero(Ua);
+  return U;
 }
 
 QList<QByteArray> dooble_pbkdf2::pbkdf2
@@ -96,80 +126,42 @@ QList<QByteArray> dooble_pbkdf2::pbkdf2
 
   /*
   ** Partial implementation of https://en.wikipedia.org/wiki/PBKDF2.
+  ** The blocks T_i are independent of one another. T_1 is computed
+  ** here and the remaining blocks are computed on other threads.
   */
 
   QList<QByteArray> T;
+  QList<QFuture<QByteArray> > futures;
   auto iterations = m_output_size /
     dooble_hmac::preferred_output_size_in_bits(); /*
 						  ** Only 512-bit PRFs are
 						  ** expected.
 						  */
 
-  for(int i = 1; i <= iterations; i++)
-    {
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-      if(m_interrupt.load())
-#else
-      if(m_interrupt.loadRelaxed())
-#endif
-	break;
-
-      QByteArray INT_32_BE_i(static_cast<int> (sizeof(int)), 0);
-      QByteArray U;
-      QByteArray Ua;
-
-      qToBigEndian(i, INT_32_BE_i.data());
-      U = Ua = function(m_password, QByteArray(m_salt).append(INT_32_BE_i));
-
-      for(int j = 2; j <= m_iteration_count; j++)
-	{
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-	  if(m_interrupt.load())
-#else
-	  if(m_interrupt.loadRelaxed())
-#endif
-	    break;
+  for(int i = 2; i <= iterations; i++)
+    futures << QtConcurrent::run([this, function, i](void)
+				 {
+				   return block(function, i);
+				 });
 
-	  auto Ub(function(m_password, Ua));
+  if(iterations >= 1)
+    T << block(function, 1);
 
-	  U = x_or(U, Ub);
-	  Ua = Ub;
-	}
-
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-      if(m_interrupt.load())
-#else
-      if(m_interrupt.loadRelaxed())
-#endif
-	break;
-
-      T.append(U);
+  for(auto &future : futures)
+    {
+      future.waitForFinished();
+      T << future.result();
     }
 
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-  if(m_interrupt.load())
-#else
-  if(m_interrupt.loadRelaxed())
-#endif
+  if(interrupted())
     return QList<QByteArray> ();
 
   QByteArray bytes;
 
   foreach(const auto &i, T)
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-    if(m_interrupt.load())
-#else
-    if(m_interrupt.loadRelaxed())
-#endif
-      break;
-    else
-      bytes.append(i);
+    bytes.append(i);
 
-#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
-  if(m_interrupt.load())
-#else
-  if(m_interrupt.loadRelaxed())
-#endif
+  if(interrupted())
     return QList<QByteArray> ();
   else
     return QList<QByteArray> () << bytes
@@ -180,6 +172,15 @@ QList<QByteArray> dooble_pbkdf2::pbkdf2
 				<< m_salt;
 }
 
+bool dooble_pbkdf2::interrupted(void) const
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
+  return m_interrupt.load();
+#else
+  return m_interrupt.loadRelaxed();
+#endif
+}
+
 void dooble_pbkdf2::slot_interrupt(void)
 {
 #if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
@@ -204,3 +205,37 @@ void dooble_pbkdf2::test1(void)
 
   qDebug() << pbkdf2.pbkdf2(&dooble_hmac::sha2_512_hmac).value(0).toHex();
 }
+
+void dooble_pbkdf2::test2(void)
+{
+  /*
+  ** T_1 and T_2 are computed on separate threads.
+  */
+
+  dooble_pbkdf2 pbkdf2("passwordPASSWORDpassword",
+		       "saltSALTsaltSALTsaltSALTsaltSALTsalt",
+		       0,
+		       0,
+		       4096,
+		       1024);
+
+  qDebug() << (pbkdf2.pbkdf2(&dooble_hmac::sha2_512_hmac).value(0) ==
+	       QByteArray::fromHex("8c0511f4c6e597c6ac6315d8f0362e22"
+				   "5f3c501495ba23b868c005174dc4ee71"
+				   "115b59f9e60cd9532fa33e0f75aefe30"
+				   "225c583a186cd82bd4daea9724a3d3b8"
+				   "04f75bdd41494fa324cab24bcc680fb3"
+				   "b96a30cf5d21fac3c2875913919f3399"
+				   "b1d9ce7eb54c95ba49118596cf746571"
+				   "9bbe02c4ecab1b1541298c321d13c6f6"));
+}
+
+void dooble_pbkdf2::x_or(QByteArray &a, const QByteArray &b)
+{
+  auto length = qMin(a.length(), b.length());
+  auto x = a.data();
+  auto y = b.constData();
+
+  for(int i = 0; i < length; i++)
+    x[i] = static_cast<char> (x[i] ^ y[i]);
+}
@@ -49,6 +49,7 @@ class dooble_pbkdf2: public QObject
     (QByteArray (*function) (const QByteArray &key,
 			     const QByteArray &message)) const;
   static void test1(void);
+  static void test2(void);
 
  private:
   QAtomicInteger<short> m_interrupt;
@@ -58,7 +59,12 @@ class dooble_pbkdf2: public QObject
   int m_hash_type_index;
   int m_iteration_count;
   int m_output_size;
-  QByteArray x_or(const QByteArray &a, const QByteArray &b) const;
+  QByteArray block
+    (QByteArray (*function) (const QByteArray &key,
+			     const QByteArray &message),
+     const int i) const;
+  bool interrupted(void) const;
+  static void x_or(QByteArray &a, const QByteArray &b);
 
  private slots:
   void slot_interrupt(void);
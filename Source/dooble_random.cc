@@ -30,6 +30,7 @@
 #include "dooble_random.h"
 
 QRandomGenerator dooble_random::s_random_generator;
+QReadWriteLock dooble_random::s_random_generator_mutex;
 
 QByteArray dooble_random::random_bytes(int length)
 {
@@ -38,6 +39,13 @@ QByteArray dooble_random::random_bytes(int length)
 
   QVector<quint32> vector(length, 0);
 
+  /*
+  ** QRandomGenerator objects are not thread-safe. Block ciphers
+  ** request initialization vectors from several threads.
+  */
+
+  QWriteLocker locker(&s_random_generator_mutex);
+
   s_random_generator.fillRange
     (vector.data(), static_cast<qsizetype> (vector.size()));
   return QByteArray(reinterpret_cast<char *> (vector.data()), vector.size());
@@ -45,5 +53,7 @@ QByteArray dooble_random::random_bytes(int length)
 
 void dooble_random::initialize(void)
 {
+  QWriteLocker locker(&s_random_generator_mutex);
+
   s_random_generator = QRandomGenerator::securelySeeded();
 }
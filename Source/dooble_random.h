@@ -30,6 +30,7 @@
 
 #include <QByteArray>
 #include <QRandomGenerator>
+#include <QReadWriteLock>
 
 class dooble_random
 {
@@ -40,6 +41,7 @@ class dooble_random
  private:
   dooble_random(void);
   static QRandomGenerator s_random_generator;
+  static QReadWriteLock s_random_generator_mutex;
 };
 
 #endif
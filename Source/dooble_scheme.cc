@@ -0,0 +1,75 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QBuffer>
+#include <QJsonDocument>
+
+#include "dooble_instrumentation.h"
+#include "dooble_scheme.h"
+
+dooble_scheme::dooble_scheme(QObject *parent):
+  QWebEngineUrlSchemeHandler(parent)
+{
+}
+
+void dooble_scheme::requestStarted(QWebEngineUrlRequestJob *request)
+{
+  /*
+  ** dooble://instrumentation presents the instrumentation,
+  ** dooble://instrumentation/json provides it as JSON, and
+  ** dooble://instrumentation/reset discards it.
+  */
+
+  if(!request)
+    return;
+
+  auto url(request->requestUrl());
+
+  if(url.host() != "instrumentation")
+    {
+      request->fail(QWebEngineUrlRequestJob::UrlNotFound);
+      return;
+    }
+
+  /*
+  ** The buffer object should be deleted when request is.
+  */
+
+  auto buffer = new QBuffer(request);
+
+  if(url.path() == "/json")
+    {
+      buffer->setData(QJsonDocument(dooble_instrumentation::json()).toJson());
+      request->reply("application/json", buffer);
+      return;
+    }
+  else if(url.path() == "/reset")
+    dooble_instrumentation::reset();
+
+  buffer->setData(dooble_instrumentation::html());
+  request->reply("text/html", buffer);
+}
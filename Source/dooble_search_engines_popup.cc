@@ -136,7 +136,7 @@ void dooble_search_engines_popup::add_search_engine
 		       QDir::separator() +
 		       "dooble_search_engines.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -238,7 +238,7 @@ void dooble_search_engines_popup::add_search_engine
 
 void dooble_search_engines_popup::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
@@ -278,27 +278,11 @@ void dooble_search_engines_popup::purge(void)
 {
   m_model->removeRows(0, m_model->rowCount());
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_search_engines.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("DELETE FROM dooble_search_engines");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_search_engines.db",
+     QStringList() << "DELETE FROM dooble_search_engines");
 }
 
 void dooble_search_engines_popup::resizeEvent(QResizeEvent *event)
@@ -457,7 +441,7 @@ void dooble_search_engines_popup::slot_delete_selected(void)
 			   QDir::separator() +
 			   "dooble_search_engines.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    std::sort(list.begin(), list.end());
 
@@ -555,7 +539,7 @@ void dooble_search_engines_popup::slot_item_changed(QStandardItem *item)
 		       QDir::separator() +
 		       "dooble_search_engines.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -646,7 +630,7 @@ void dooble_search_engines_popup::slot_populate(void)
 		       QDir::separator() +
 		       "dooble_search_engines.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 	disconnect(m_model,
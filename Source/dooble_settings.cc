@@ -25,11 +25,13 @@
 ** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <QDateTime>
 #include <QDir>
 #include <QKeyEvent>
 #include <QMessageBox>
 #include <QNetworkProxy>
 #include <QSqlQuery>
+#include <QThread>
 #include <QToolTip>
 #include <QWebEngineProfile>
 #include <QWebEngineSettings>
@@ -43,6 +45,7 @@
 #include "dooble_cookies.h"
 #include "dooble_cryptography.h"
 #include "dooble_database_utilities.h"
+#include "dooble_database_writer.h"
 #include "dooble_downloads.h"
 #include "dooble_favicons.h"
 #include "dooble_history.h"
@@ -55,13 +58,79 @@
 #include "dooble_ui_utilities.h"
 #include "dooble_version.h"
 
+static_assert(dooble_settings_registry::ordered(),
+	      "dooble_settings_registry::s_entries is not ordered.");
+
+class dooble_settings_snapshot
+{
+  /*
+  ** An immutable, typed copy of the registered settings, indexed by
+  ** dooble_settings_registry::Settings. Booleans are stored as integers.
+  ** Please see publish_snapshot().
+  */
+
+ public:
+  QString m_strings[dooble_settings_registry::SETTINGS_COUNT];
+  int m_integers[dooble_settings_registry::SETTINGS_COUNT];
+};
+
+static QHash<QString, int> prepare_registry_indexes(void)
+{
+  QHash<QString, int> indexes;
+
+  for(int i = 0; i < dooble_settings_registry::SETTINGS_COUNT; i++)
+    indexes[dooble_settings_registry::s_entries[i].m_key] = i;
+
+  return indexes;
+}
+
+static int registry_index(const QString &key)
+{
+  static const auto indexes(prepare_registry_indexes());
+
+  return indexes.value(key, -1);
+}
+
+static void prepare_snapshot_value(dooble_settings_snapshot *snapshot,
+				   int index,
+				   const QVariant &value)
+{
+  switch(dooble_settings_registry::s_entries[index].m_type)
+    {
+    case dooble_settings_registry::BOOLEAN:
+      {
+	snapshot->m_integers[index] = value.toBool() ? 1 : 0;
+	break;
+      }
+    case dooble_settings_registry::INTEGER:
+      {
+	snapshot->m_integers[index] = value.toInt();
+	break;
+      }
+    default:
+      {
+	snapshot->m_strings[index] = value.toString().trimmed();
+	break;
+      }
+    }
+}
+
+static dooble_settings_snapshot s_initial_snapshot;
+
+QAtomicPointer<dooble_settings_snapshot> dooble_settings::s_snapshot
+(&s_initial_snapshot);
 QHash<QString, QString> dooble_settings::s_web_engine_settings_environment;
 QHash<QUrl, char> dooble_settings::s_javascript_block_popup_exceptions;
+QList<QPair<QSharedPointer<dooble_settings_snapshot>, qint64> >
+dooble_settings::s_snapshots;
 QMap<QString, QVariant> dooble_settings::s_getenv;
 QMap<QString, QVariant> dooble_settings::s_settings;
 QMultiMap<QUrl, QPair<int, bool> > dooble_settings::s_site_features_permissions;
 QReadWriteLock dooble_settings::s_getenv_mutex;
 QReadWriteLock dooble_settings::s_settings_mutex;
+QSet<QString> dooble_settings::s_settings_absent;
+QSharedPointer<dooble_settings_snapshot>
+dooble_settings::s_snapshot_current;
 QString dooble_settings::s_http_user_agent;
 QStringList dooble_settings::s_spell_checker_dictionaries;
 
@@ -273,50 +342,36 @@ dooble_settings::dooble_settings(void):dooble_main_window()
   s_http_user_agent = QWebEngineProfile::defaultProfile()->httpUserAgent() +
 #endif
     " Dooble/" DOOBLE_VERSION_STRING;
-  s_settings["accepted_or_blocked_domains_mode"] = "block";
-  s_settings["access_new_tabs"] = true;
-  s_settings["allow_closing_of_single_tab"] = true;
-  s_settings["auto_hide_tab_bar"] = false;
-  s_settings["auto_load_images"] = true;
-  s_settings["block_cipher_type"] = "AES-256";
-  s_settings["block_cipher_type_index"] = 0;
-  s_settings["block_third_party_cookies"] = true;
-  s_settings["browsing_history_days"] = 15;
-  s_settings["cache_size"] = 0;
-  s_settings["cache_type_index"] = 0;
-  s_settings["center_child_windows"] = true;
-  s_settings["cookie_policy_index"] = 2;
-  s_settings["credentials_enabled"] = false;
-  s_settings["denote_private_widgets"] = true;
-  s_settings["do_not_track"] = true;
-  s_settings["favicons"] = true;
-  s_settings["favorites_sort_index"] = 1; // Most Popular
-  s_settings["features_permissions"] = true;
-  s_settings["hash_type"] = "SHA3-512";
-  s_settings["hash_type_index"] = 1;
+
+  for(int i = 0; i < dooble_settings_registry::SETTINGS_COUNT; i++)
+    {
+      const auto &entry(dooble_settings_registry::s_entries[i]);
+
+      if(!entry.m_default)
+	continue;
+
+      switch(entry.m_type)
+	{
+	case dooble_settings_registry::BOOLEAN:
+	  {
+	    s_settings[entry.m_key] = entry.m_integer != 0;
+	    break;
+	  }
+	case dooble_settings_registry::INTEGER:
+	  {
+	    s_settings[entry.m_key] = entry.m_integer;
+	    break;
+	  }
+	default:
+	  {
+	    s_settings[entry.m_key] = entry.m_string;
+	    break;
+	  }
+	}
+    }
+
   s_settings["home_url"] = QUrl::fromUserInput(dooble::ABOUT_BLANK).toEncoded();
-  s_settings["icon_set"] = "Material Design";
-  s_settings["icon_set_index"] = 0;
-  s_settings["javascript"] = true;
-  s_settings["javascript_block_popups"] = true;
-  s_settings["language_index"] = 0;
-  s_settings["local_storage"] = true;
-  s_settings["main_menu_bar_visible"] = true;
-  s_settings["pin_accepted_or_blocked_window"] = true;
-  s_settings["pin_downloads_window"] = true;
-  s_settings["pin_history_window"] = true;
-  s_settings["pin_settings_window"] = true;
-  s_settings["save_geometry"] = true;
-  s_settings["show_new_downloads"] = true;
-  s_settings["status_bar_visible"] = true;
-  s_settings["tab_position"] = "north";
-  s_settings["temporarily_disable_javascript"] = false;
-  s_settings["theme_color"] = "default";
-  s_settings["theme_color_index"] = 2; // Default
   s_settings["user_agent"] = s_http_user_agent;
-  s_settings["webgl"] = true;
-  s_settings["webrtc_public_interfaces_only"] = true;
-  s_settings["zoom_frame_location_index"] = 0;
 #ifdef Q_OS_MACOS
   s_spell_checker_dictionaries << "af_ZA"
 			       << "an_ES"
@@ -471,6 +526,37 @@ QString dooble_settings::zoom_frame_location_string(int index)
   return "popup_menu";
 }
 
+const QString &dooble_settings::string
+(dooble_settings_registry::Settings key)
+{
+  /*
+  ** Lock-free. The values are bounded and trimmed.
+  */
+
+  return s_snapshot.loadAcquire()->m_strings[key];
+}
+
+QVariant dooble_settings::bounded(const QString &key, const QVariant &value)
+{
+  auto index = registry_index(key);
+
+  if(index >= 0)
+    {
+      const auto &entry(dooble_settings_registry::s_entries[index]);
+
+      if(entry.m_bounded)
+	return qBound(entry.m_minimum, value.toInt(), entry.m_maximum);
+      else
+	return value;
+    }
+
+  for(const auto &prefix : dooble_settings_registry::s_prefixes)
+    if(key.startsWith(QLatin1String(prefix.m_prefix)))
+      return qBound(prefix.m_minimum, value.toInt(), prefix.m_maximum);
+
+  return value;
+}
+
 QVariant dooble_settings::getenv(const QString &n)
 {
   auto name(n.trimmed());
@@ -495,82 +581,63 @@ QVariant dooble_settings::setting(const QString &k,
 
   if(!s_settings.contains(key))
     {
+      /*
+      ** Keys which are absent from the database are remembered.
+      */
+
+      if(s_settings_absent.contains(key))
+	return default_value;
+
       auto  home_path(s_settings.value("home_path").toString());
 
       locker.unlock();
 
-      auto database_name(dooble_database_utilities::database_name());
       auto value(default_value);
+      auto db
+	(dooble_database_utilities::
+	 database(home_path + QDir::separator() + "dooble_settings.db",
+		  &create_tables));
 
-      {
-	auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-	db.setDatabaseName
-	  (home_path + QDir::separator() + "dooble_settings.db");
-
-	if(db.open())
-	  {
-	    create_tables(db);
+      if(db.isOpen())
+	{
+	  auto query = dooble_database_utilities::prepared_query
+	    (db, "SELECT value FROM dooble_settings WHERE key = ?");
 
-	    QSqlQuery query(db);
+	  if(query)
+	    {
+	      query->bindValue(0, key);
 
-	    query.setForwardOnly(true);
-	    query.prepare("SELECT value FROM dooble_settings WHERE key = ?");
-	    query.addBindValue(key);
+	      if(dooble_database_utilities::exec(db, query))
+		{
+		  auto exists = query->next();
 
-	    if(query.exec() && query.next())
-	      {
-		value = query.value(0).toString().trimmed();
+		  if(exists)
+		    value = query->value(0).toString().trimmed();
 
-		QWriteLocker locker(&s_settings_mutex);
+		  QWriteLocker locker(&s_settings_mutex);
 
-		s_settings[key] = value;
-	      }
-	  }
+		  if(exists)
+		    {
+		      s_settings[key] = value;
+		      prepare_snapshot(key);
+		    }
+		  else
+		    s_settings_absent << key;
+		}
 
-	db.close();
-      }
+	      query->finish();
+	    }
+	}
 
-      QSqlDatabase::removeDatabase(database_name);
       return value;
     }
 
-  if(key == "authentication_iteration_count")
-    return qBound
-      (15000, s_settings.value(key, default_value).toInt(), 999999999);
-  else if(key == "block_cipher_type_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1);
-  else if(key == "browsing_history_days")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 365);
-  else if(key == "cache_size")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 2048);
-  else if(key == "cache_type_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1);
-  else if(key == "cookie_policy_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 2);
-  else if(key == "dooble_accepted_or_blocked_domains_"
-	          "maximum_session_rejections")
-    return qBound(1, s_settings.value(key, default_value).toInt(), 1000000);
-  else if(key == "favorites_sort_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 2);
-  else if(key == "hash_type_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1);
-  else if(key == "icon_set_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1);
-  else if(key == "language_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1);
-  else if(key == "proxy_port")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 65535);
-  else if(key == "theme_color_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 4);
-  else if(key == "zoom")
-    return qBound(25, s_settings.value(key, default_value).toInt(), 500);
-  else if(key == "zoom_frame_location_index")
-    return qBound(0, s_settings.value(key, default_value).toInt(), 0);
-  else if(key.startsWith("history_horizontal_header_section_size_"))
-    return qBound(0, s_settings.value(key, default_value).toInt(), 1000000);
-  else
-    return s_settings.value(key, default_value);
+  return bounded(key, s_settings.value(key, default_value));
+}
+
+bool dooble_settings::boolean(dooble_settings_registry::Settings key)
+{
+  return s_snapshot.loadAcquire()->m_integers[key] != 0;
 }
 
 bool dooble_settings::has_dooble_credentials(void)
@@ -589,51 +656,84 @@ bool dooble_settings::has_dooble_credentials_temporary(void)
     setting("credentials_enabled").toBool();
 }
 
+bool dooble_settings::queue_writes(void)
+{
+  /*
+  ** The writer may only be used by its thread.
+  */
+
+  return dooble::s_database_writer &&
+    dooble::s_database_writer->thread() == QThread::currentThread();
+}
+
 bool dooble_settings::set_setting(const QString &key, const QVariant &value)
 {
   if(key.trimmed().isEmpty())
     return false;
   else if(value.isNull())
     {
+      /*
+      ** The stored value will be read again. Pending writes are
+      ** completed first.
+      */
+
+      if(queue_writes())
+	dooble::s_database_writer->flush();
+
       QWriteLocker locker(&s_settings_mutex);
 
       s_settings.remove(key.toLower().trimmed());
+      s_settings_absent.remove(key.toLower().trimmed());
+      prepare_snapshot(key.toLower().trimmed());
       return false;
     }
 
   QWriteLocker locker(&s_settings_mutex);
 
   s_settings[key.toLower().trimmed()] = value;
+  s_settings_absent.remove(key.toLower().trimmed());
+  prepare_snapshot(key.toLower().trimmed());
   locker.unlock();
 
-  auto database_name(dooble_database_utilities::database_name());
-  auto ok = false;
+  auto file_name
+    (setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_settings.db");
 
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_settings.db");
+  if(queue_writes())
+    {
+      /*
+      ** Writes of the same key are coalesced and performed by a
+      ** single transaction. Please see flush().
+      */
 
-    if(db.open())
-      {
-	create_tables(db);
+      dooble::s_database_writer->enqueue
+	(file_name,
+	 &create_tables,
+	 key.toLower().trimmed(),
+	 "INSERT OR REPLACE INTO dooble_settings (key, value) VALUES (?, ?)",
+	 QVariantList() << key.toLower().trimmed()
+			<< value.toString().trimmed());
+      return true;
+    }
 
-	QSqlQuery query(db);
+  auto ok = false;
+  auto db(dooble_database_utilities::database(file_name, &create_tables));
 
-	query.exec("PRAGMA synchronous = NORMAL");
-	query.prepare
-	  ("INSERT OR REPLACE INTO dooble_settings (key, value) VALUES (?, ?)");
-	query.addBindValue(key.toLower().trimmed());
-	query.addBindValue(value.toString().trimmed());
-	ok = query.exec();
-      }
+  if(db.isOpen())
+    {
+      auto query = dooble_database_utilities::prepared_query
+	(db,
+	 "INSERT OR REPLACE INTO dooble_settings (key, value) VALUES (?, ?)");
 
-    db.close();
-  }
+      if(query)
+	{
+	  query->bindValue(0, key.toLower().trimmed());
+	  query->bindValue(1, value.toString().trimmed());
+	  ok = dooble_database_utilities::exec(db, query);
+	}
+    }
 
-  QSqlDatabase::removeDatabase(database_name);
   return ok;
 }
 
@@ -642,6 +742,11 @@ bool dooble_settings::site_has_javascript_block_popup_exception(const QUrl &url)
   return s_javascript_block_popup_exceptions.value(url, 0) == 1;
 }
 
+int dooble_settings::integer(dooble_settings_registry::Settings key)
+{
+  return s_snapshot.loadAcquire()->m_integers[key];
+}
+
 int dooble_settings::site_feature_permission
 (const QUrl &url, QWebEnginePage::Feature feature)
 {
@@ -671,7 +776,7 @@ void dooble_settings::closeEvent(QCloseEvent *event)
 
 void dooble_settings::create_tables(QSqlDatabase &db)
 {
-  db.open();
+  dooble_database_utilities::open(db);
 
   QSqlQuery query(db);
 
@@ -700,6 +805,17 @@ void dooble_settings::create_tables(QSqlDatabase &db)
 	     "value TEXT NOT NULL)");
 }
 
+void dooble_settings::flush(void)
+{
+  /*
+  ** Completes the pending writes of settings. Must be called from
+  ** the main thread.
+  */
+
+  if(queue_writes())
+    dooble::s_database_writer->flush();
+}
+
 void dooble_settings::keyPressEvent(QKeyEvent *event)
 {
   if(!parent())
@@ -1012,6 +1128,57 @@ void dooble_settings::prepare_proxy(bool save)
     }
 }
 
+void dooble_settings::prepare_snapshot(void)
+{
+  /*
+  ** The caller must hold s_settings_mutex for writing. Every registered
+  ** setting is prepared. A snapshot is only replaced if one of its
+  ** values has changed.
+  */
+
+  QSharedPointer<dooble_settings_snapshot> snapshot
+    (new dooble_settings_snapshot());
+  auto current = s_snapshot.loadAcquire();
+  auto changed = false;
+
+  for(int i = 0; i < dooble_settings_registry::SETTINGS_COUNT; i++)
+    {
+      QString key(dooble_settings_registry::s_entries[i].m_key);
+
+      prepare_snapshot_value
+	(snapshot.data(), i, bounded(key, s_settings.value(key, QVariant(""))));
+      changed |= current->m_integers[i] != snapshot->m_integers[i] ||
+	current->m_strings[i] != snapshot->m_strings[i];
+    }
+
+  if(changed)
+    publish_snapshot(snapshot);
+}
+
+void dooble_settings::prepare_snapshot(const QString &key)
+{
+  /*
+  ** The caller must hold s_settings_mutex for writing. Only the value
+  ** of the key is prepared. Unregistered keys are ignored.
+  */
+
+  auto index = registry_index(key);
+
+  if(index < 0)
+    return;
+
+  auto current = s_snapshot.loadAcquire();
+  QSharedPointer<dooble_settings_snapshot> snapshot
+    (new dooble_settings_snapshot(*current));
+
+  prepare_snapshot_value
+    (snapshot.data(), index, bounded(key, s_settings.value(key, QVariant(""))));
+
+  if(current->m_integers[index] != snapshot->m_integers[index] ||
+     current->m_strings[index] != snapshot->m_strings[index])
+    publish_snapshot(snapshot);
+}
+
 void dooble_settings::prepare_table_statistics(void)
 {
   m_ui.features_permissions_entries->setText
@@ -1047,7 +1214,7 @@ void dooble_settings::prepare_web_engine_environment_variables(void)
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 	QString string("");
@@ -1127,7 +1294,7 @@ void dooble_settings::prepare_web_engine_settings(void)
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -1192,8 +1359,35 @@ void dooble_settings::prepare_web_engine_settings(void)
   m_ui.web_engine_settings->sortItems(0);
 }
 
+void dooble_settings::publish_snapshot
+(const QSharedPointer<dooble_settings_snapshot> &snapshot)
+{
+  /*
+  ** The caller must hold s_settings_mutex for writing. Readers do not
+  ** announce themselves. A replaced snapshot is therefore retired and
+  ** released by a later publication once it has been retired for a
+  ** minute. Readers only hold values for the duration of a call.
+  */
+
+  auto now = QDateTime::currentMSecsSinceEpoch();
+
+  while(!s_snapshots.isEmpty() && now - s_snapshots.first().second >= 60000)
+    s_snapshots.removeFirst();
+
+  if(s_snapshot_current)
+    s_snapshots << qMakePair(s_snapshot_current, now);
+
+  s_snapshot.storeRelease(snapshot.data());
+  s_snapshot_current = snapshot;
+}
+
 void dooble_settings::purge_database_data(void)
 {
+  /*
+  ** Consolidated databases are purged by a single transaction.
+  */
+
+  dooble_database_utilities::begin_purge();
   dooble::s_accepted_or_blocked_domains->purge();
   dooble::s_certificate_exceptions->purge();
   dooble::s_downloads->purge();
@@ -1205,6 +1399,8 @@ void dooble_settings::purge_database_data(void)
   m_ui.new_javascript_block_popup_exception->clear();
   purge_features_permissions();
   purge_javascript_block_popup_exceptions();
+  dooble_database_utilities::end_purge();
+  prepare_table_statistics();
   s_javascript_block_popup_exceptions.clear();
   s_site_features_permissions.clear();
   slot_remove_all_javascript_block_popup_exceptions();
@@ -1215,28 +1411,11 @@ void dooble_settings::purge_features_permissions(void)
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
   m_ui.features_permissions->setRowCount(0);
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_settings.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_features_permissions");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_settings.db",
+     QStringList() << "DELETE FROM dooble_features_permissions");
   prepare_table_statistics();
   QApplication::restoreOverrideCursor();
 }
@@ -1246,32 +1425,46 @@ void dooble_settings::purge_javascript_block_popup_exceptions(void)
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
   m_ui.javascript_block_popups_exceptions->setRowCount(0);
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_settings.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_javascript_block_popup_exceptions");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_settings.db",
+     QStringList() << "DELETE FROM dooble_javascript_block_popup_exceptions");
   prepare_table_statistics();
   QApplication::restoreOverrideCursor();
 }
 
+void dooble_settings::rekey_database_data
+(const QSharedPointer<dooble_cryptography> &previous)
+{
+  if(!dooble::s_application || !previous)
+    return;
+
+  if(m_rekey_dialog)
+    m_rekey_dialog->deleteLater();
+
+  m_rekey_dialog = new QProgressDialog(this);
+  m_rekey_dialog->setAutoClose(true);
+  m_rekey_dialog->setCancelButton(nullptr);
+  m_rekey_dialog->setLabelText(tr("Re-encrypting database data..."));
+  m_rekey_dialog->setMaximum(0);
+  m_rekey_dialog->setMinimum(0);
+  m_rekey_dialog->setWindowIcon(windowIcon());
+  m_rekey_dialog->setWindowTitle(tr("Dooble: Re-encrypting Database Data"));
+  connect(dooble::s_application,
+	  SIGNAL(database_rekeyed(const QString &, int, int)),
+	  this,
+	  SLOT(slot_database_rekeyed(const QString &, int, int)),
+	  Qt::UniqueConnection);
+  connect(dooble::s_application,
+	  SIGNAL(databases_rekeyed(bool)),
+	  this,
+	  SLOT(slot_databases_rekeyed(bool)),
+	  Qt::UniqueConnection);
+  m_rekey_dialog->show();
+  dooble::s_application->rekey_databases(previous);
+}
+
 void dooble_settings::remove_setting(const QString &key)
 {
   if(key.trimmed().isEmpty())
@@ -1280,8 +1473,27 @@ void dooble_settings::remove_setting(const QString &key)
   QWriteLocker lock(&s_settings_mutex);
 
   s_settings.remove(key.toLower().trimmed());
+  s_settings_absent << key.toLower().trimmed();
+  prepare_snapshot(key.toLower().trimmed());
   lock.unlock();
 
+  if(queue_writes())
+    {
+      /*
+      ** Replaces a pending write of the key.
+      */
+
+      dooble::s_database_writer->enqueue
+	(setting("home_path").toString() +
+	 QDir::separator() +
+	 "dooble_settings.db",
+	 &create_tables,
+	 key.toLower().trimmed(),
+	 "DELETE FROM dooble_settings WHERE key = ?",
+	 QVariantList() << key.toLower().trimmed());
+      return;
+    }
+
   auto database_name(dooble_database_utilities::database_name());
 
   {
@@ -1291,7 +1503,7 @@ void dooble_settings::remove_setting(const QString &key)
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -1327,10 +1539,11 @@ void dooble_settings::restore(bool read_database)
 			   QDir::separator() +
 			   "dooble_settings.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    create_tables(db);
 
+	    QMap<QString, QVariant> settings;
 	    QSqlQuery query(db);
 
 	    query.setForwardOnly(true);
@@ -1350,10 +1563,24 @@ void dooble_settings::restore(bool read_database)
 		      continue;
 		    }
 
-		  QWriteLocker lock(&s_settings_mutex);
-
-		  s_settings[key] = value;
+		  settings[key] = value;
 		}
+
+	    /*
+	    ** The table was read by a single query. Keys which were
+	    ** found absent must be examined again.
+	    */
+
+	    QWriteLocker lock(&s_settings_mutex);
+	    QMapIterator<QString, QVariant> it(settings);
+
+	    while(it.hasNext())
+	      {
+		it.next();
+		s_settings[it.key()] = it.value();
+	      }
+
+	    s_settings_absent.clear();
 	  }
 
 	db.close();
@@ -1389,6 +1616,10 @@ void dooble_settings::restore(bool read_database)
     (qBound(0,
 	    s_settings.value("block_cipher_type_index", 0).toInt(),
 	    m_ui.cipher->count() - 1));
+  m_ui.consolidated_purges->setChecked
+    (s_settings.value("consolidated_purges", false).toBool());
+  dooble_database_utilities::set_consolidated
+    (m_ui.consolidated_purges->isChecked());
   m_ui.cookie_policy->setCurrentIndex
     (qBound(0,
 	    s_settings.value("cookie_policy_index", 2).toInt(),
@@ -1510,8 +1741,10 @@ void dooble_settings::restore(bool read_database)
 
   if(m_ui.cipher->currentIndex() == 0)
     s_settings["block_cipher_type"] = "AES-256";
-  else
+  else if(m_ui.cipher->currentIndex() == 1)
     s_settings["block_cipher_type"] = "Threefish-256";
+  else
+    s_settings["block_cipher_type"] = "AES-256-GCM";
 
   if(m_ui.hash->currentIndex() == 0)
     s_settings["hash_type"] = "Keccak-512";
@@ -1586,6 +1819,7 @@ void dooble_settings::restore(bool read_database)
     (s_settings.value("webrtc_public_interfaces_only", true).toBool());
   m_ui.xss_auditing->setChecked
     (s_settings.value("xss_auditing", false).toBool());
+  prepare_snapshot();
   lock.unlock();
   m_ui.reset_credentials->setEnabled(has_dooble_credentials());
   QWebEngineProfile::defaultProfile()->setHttpCacheMaximumSize
@@ -1796,7 +2030,7 @@ void dooble_settings::save_javascript_block_popup_exception
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -1939,7 +2173,7 @@ void dooble_settings::set_site_feature_permission
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -2125,6 +2359,7 @@ void dooble_settings::slot_apply(void)
       remove_setting("block_cipher_type_index");
       remove_setting("hash_type");
       remove_setting("hash_type_index");
+      flush();
 
       {
 	QWriteLocker locker(&s_settings_mutex);
@@ -2351,6 +2586,9 @@ void dooble_settings::slot_apply(void)
   set_setting("cache_size", m_ui.cache_size->value());
   set_setting("cache_type_index", m_ui.cache_type->currentIndex());
   set_setting("center_child_windows", m_ui.center_child_windows->isChecked());
+  set_setting("consolidated_purges", m_ui.consolidated_purges->isChecked());
+  dooble_database_utilities::set_consolidated
+    (m_ui.consolidated_purges->isChecked());
   set_setting("cookie_policy_index", m_ui.cookie_policy->currentIndex());
   set_setting("credentials_enabled", m_ui.credentials->isChecked());
   set_setting("dns_prefetch", m_ui.dns_prefetch->isChecked());
@@ -2441,6 +2679,33 @@ void dooble_settings::slot_clear_cache(void)
   QWebEngineProfile::defaultProfile()->clearHttpCache();
 }
 
+void dooble_settings::slot_database_rekeyed(const QString &table,
+					    int completed,
+					    int total)
+{
+  if(!m_rekey_dialog)
+    return;
+
+  m_rekey_dialog->setLabelText
+    (tr("Re-encrypting database data (%1)...").
+     arg(table.mid(table.lastIndexOf('/') + 1)));
+  m_rekey_dialog->setMaximum(total);
+  m_rekey_dialog->setValue(completed);
+}
+
+void dooble_settings::slot_databases_rekeyed(bool state)
+{
+  if(m_rekey_dialog)
+    m_rekey_dialog->deleteLater();
+
+  if(!state)
+    QMessageBox::warning
+      (this,
+       tr("Dooble: Warning"),
+       tr("Some database data could not be re-encrypted. Dooble will "
+	  "attempt again after the next authentication."));
+}
+
 void dooble_settings::slot_features_permissions_item_changed
 (QTableWidgetItem *item)
 {
@@ -2561,6 +2826,10 @@ void dooble_settings::slot_pbkdf2_future_finished(void)
       m_pbkdf2_dialog->deleteLater();
     }
 
+  auto previous(m_rekey_previous);
+
+  m_rekey_previous.clear();
+
   if(!was_canceled)
     {
       QString error("");
@@ -2623,14 +2892,18 @@ void dooble_settings::slot_pbkdf2_future_finished(void)
 	      ok = false;
 	    }
 
+	  flush();
+
 	  if(ok)
 	    {
 	      QWriteLocker locker(&s_settings_mutex);
 
 	      if(list.at(1).toInt() == 0)
 		s_settings["block_cipher_type"] = "AES-256";
-	      else
+	      else if(list.at(1).toInt() == 1)
 		s_settings["block_cipher_type"] = "Threefish-256";
+	      else
+		s_settings["block_cipher_type"] = "AES-256-GCM";
 
 	      if(list.at(2).toInt() == 0)
 		s_settings["hash_type"] = "Keccak-512";
@@ -2647,6 +2920,7 @@ void dooble_settings::slot_pbkdf2_future_finished(void)
 	      remove_setting("credentials_enabled");
 	      remove_setting("hash_type");
 	      remove_setting("hash_type_index");
+	      flush();
 
 	      {
 		QWriteLocker locker(&s_settings_mutex);
@@ -2664,8 +2938,10 @@ void dooble_settings::slot_pbkdf2_future_finished(void)
 
 	      if(list.at(1).toInt() == 0)
 		dooble::s_cryptography->set_block_cipher_type("AES-256");
-	      else
+	      else if(list.at(1).toInt() == 1)
 		dooble::s_cryptography->set_block_cipher_type("Threefish-256");
+	      else
+		dooble::s_cryptography->set_block_cipher_type("AES-256-GCM");
 
 	      if(list.at(2).toInt() == 0)
 		dooble::s_cryptography->set_hash_type("Keccak-512");
@@ -2680,10 +2956,19 @@ void dooble_settings::slot_pbkdf2_future_finished(void)
 		 mid(dooble_cryptography::s_authentication_key_length,
 		     dooble_cryptography::s_encryption_key_length));
 
+	      /*
+	      ** Values which are waiting to be written were prepared
+	      ** by the previous keys.
+	      */
+
+	      if(dooble::s_database_writer)
+		dooble::s_database_writer->flush();
+
 	      dooble::s_cryptography->set_keys
 		(authentication_key, encryption_key);
 	      dooble_cryptography::memzero(authentication_key);
 	      dooble_cryptography::memzero(encryption_key);
+	      rekey_database_data(previous);
 	      m_ui.reset_credentials->setEnabled(true);
 	      emit dooble_credentials_created();
 	    }
@@ -2735,7 +3020,7 @@ void dooble_settings::slot_populate(void)
 		       QDir::separator() +
 		       "dooble_settings.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	create_tables(db);
 
@@ -3082,12 +3367,10 @@ void dooble_settings::slot_remove_selected_features_permissions(void)
 			   QDir::separator() +
 			   "dooble_settings.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
-
 	    for(int i = list.size() - 1; i >= 0; i--)
 	      {
 		query.prepare
@@ -3197,12 +3480,10 @@ slot_remove_selected_javascript_block_popup_exceptions(void)
 			   QDir::separator() +
 			   "dooble_settings.db");
 
-	if(db.open())
+	if(dooble_database_utilities::open(db))
 	  {
 	    QSqlQuery query(db);
 
-	    query.exec("PRAGMA synchronous = OFF");
-
 	    for(int i = list.size() - 1; i >= 0; i--)
 	      {
 		query.prepare
@@ -3265,23 +3546,15 @@ void dooble_settings::slot_reset(void)
   QApplication::processEvents();
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-  QStringList list;
+  foreach(const auto &i, dooble_database_utilities::file_names())
+    {
+      auto file_name(setting("home_path").toString() + QDir::separator() + i);
 
-  list << "dooble_accepted_or_blocked_domains.db"
-       << "dooble_certificate_exceptions.db"
-       << "dooble_charts.db"
-       << "dooble_cookies.db"
-       << "dooble_downloads.db"
-       << "dooble_favicons.db"
-       << "dooble_history.db"
-       << "dooble_search_engines.db"
-       << "dooble_settings.db"
-       << "dooble_style_sheets.db";
+      if(dooble::s_database_writer)
+	dooble::s_database_writer->discard(file_name);
 
-  foreach(const auto &i, list)
-    QFile::remove(setting("home_path").toString() +
-		  QDir::separator() +
-		  i);
+      dooble_database_utilities::remove_database(file_name);
+    }
 
   QApplication::restoreOverrideCursor();
   QApplication::processEvents();
@@ -3344,6 +3617,7 @@ void dooble_settings::slot_reset_credentials(void)
   remove_setting("block_cipher_type_index");
   remove_setting("hash_type");
   remove_setting("hash_type_index");
+  flush();
 
   {
     QWriteLocker locker(&s_settings_mutex);
@@ -3416,7 +3690,7 @@ void dooble_settings::slot_save_credentials(void)
       mb.setIcon(QMessageBox::Question);
       mb.setStandardButtons(QMessageBox::No | QMessageBox::Yes);
       mb.setText(tr("Are you sure that you wish to prepare new credentials? "
-		    "Existing database data will be removed."));
+		    "Existing database data will be re-encrypted."));
       mb.setWindowIcon(windowIcon());
       mb.setWindowModality(Qt::ApplicationModal);
       mb.setWindowTitle(tr("Dooble: Confirmation"));
@@ -3444,9 +3718,24 @@ void dooble_settings::slot_save_credentials(void)
       return;
     }
 
-  QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-  purge_database_data();
-  QApplication::restoreOverrideCursor();
+  /*
+  ** The existing database data is re-encrypted after the new keys
+  ** are prepared.
+  */
+
+  if(dooble::s_cryptography)
+    {
+      auto keys(dooble::s_cryptography->keys());
+
+      m_rekey_previous = QSharedPointer<dooble_cryptography>
+	(new dooble_cryptography(keys.first,
+				 keys.second,
+				 dooble::s_cryptography->block_cipher_type(),
+				 dooble::s_cryptography->hash_type()));
+      dooble_cryptography::memzero(keys.first);
+      dooble_cryptography::memzero(keys.second);
+    }
+
   m_pbkdf2_dialog = new QProgressDialog(this);
   m_pbkdf2_dialog->setCancelButtonText(tr("Interrupt"));
   m_pbkdf2_dialog->setLabelText(tr("Preparing credentials..."));
@@ -3512,13 +3801,12 @@ void dooble_settings::slot_web_engine_settings_item_changed
 			       QDir::separator() +
 			       "dooble_settings.db");
 
-	    if(db.open())
+	    if(dooble_database_utilities::open(db))
 	      {
 		create_tables(db);
 
 		QSqlQuery query(db);
 
-		query.exec("PRAGMA synchronous = NORMAL");
 		query.prepare
 		  ("INSERT OR REPLACE INTO dooble_web_engine_settings "
 		   "(environment_variable, key, value) VALUES (?, ?, ?)");
@@ -28,18 +28,25 @@
 #ifndef dooble_settings_h
 #define dooble_settings_h
 
+#include <QAtomicPointer>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QPointer>
 #include <QProgressDialog>
 #include <QReadWriteLock>
+#include <QSet>
+#include <QSharedPointer>
 #include <QSqlDatabase>
 #include <QUrl>
 #include <QWebEnginePage>
 
 #include "dooble_main_window.h"
+#include "dooble_settings_registry.h"
 #include "ui_dooble_settings.h"
 
+class dooble_cryptography;
+class dooble_settings_snapshot;
+
 class dooble_settings: public dooble_main_window
 {
   Q_OBJECT
@@ -69,6 +76,7 @@ class dooble_settings: public dooble_main_window
   static bool site_has_javascript_block_popup_exception(const QUrl &url);
   static int site_feature_permission(const QUrl &url,
 				     QWebEnginePage::Feature feature);
+  static void flush(void);
   static void prepare_web_engine_environment_variables(void);
   static void remove_setting(const QString &key);
   void restore(bool read_database);
@@ -79,6 +87,23 @@ class dooble_settings: public dooble_main_window
   void show_normal(QWidget *parent);
   void show_panel(dooble_settings::Panels panel);
 
+  template<dooble_settings_registry::Settings key>
+  static decltype(auto) value(void)
+  {
+    /*
+    ** Lock-free. The type of the value is declared by the registry.
+    */
+
+    constexpr auto type = dooble_settings_registry::s_entries[key].m_type;
+
+    if constexpr(type == dooble_settings_registry::BOOLEAN)
+      return boolean(key);
+    else if constexpr(type == dooble_settings_registry::INTEGER)
+      return integer(key);
+    else
+      return string(key);
+  }
+
  public slots:
   void show(void);
 
@@ -91,16 +116,32 @@ class dooble_settings: public dooble_main_window
   QFuture<QList<QByteArray> > m_pbkdf2_future;
   QFutureWatcher<QList<QByteArray> > m_pbkdf2_future_watcher;
   QPointer<QProgressDialog> m_pbkdf2_dialog;
+  QPointer<QProgressDialog> m_rekey_dialog;
+  QSharedPointer<dooble_cryptography> m_rekey_previous;
   Ui_dooble_settings m_ui;
+  static QAtomicPointer<dooble_settings_snapshot> s_snapshot;
   static QHash<QString, QString> s_web_engine_settings_environment;
   static QHash<QUrl, char> s_javascript_block_popup_exceptions;
+  static QList<QPair<QSharedPointer<dooble_settings_snapshot>, qint64> >
+    s_snapshots;
   static QMap<QString, QVariant> s_getenv;
   static QMap<QString, QVariant> s_settings;
   static QMultiMap<QUrl, QPair<int, bool> > s_site_features_permissions;
   static QReadWriteLock s_getenv_mutex;
   static QReadWriteLock s_settings_mutex;
+  static QSet<QString> s_settings_absent;
+  static QSharedPointer<dooble_settings_snapshot> s_snapshot_current;
   static QString s_http_user_agent;
+  static QVariant bounded(const QString &key, const QVariant &value);
+  static bool boolean(dooble_settings_registry::Settings key);
+  static bool queue_writes(void);
+  static const QString &string(dooble_settings_registry::Settings key);
+  static int integer(dooble_settings_registry::Settings key);
   static void create_tables(QSqlDatabase &db);
+  static void prepare_snapshot(const QString &key);
+  static void prepare_snapshot(void);
+  static void publish_snapshot
+    (const QSharedPointer<dooble_settings_snapshot> &snapshot);
   void new_javascript_block_popup_exception(const QUrl &url);
   void prepare_fonts(void);
   void prepare_icons(void);
@@ -109,6 +150,8 @@ class dooble_settings: public dooble_main_window
   void prepare_web_engine_settings(void);
   void purge_database_data(void);
   void purge_features_permissions(void);
+  void rekey_database_data
+    (const QSharedPointer<dooble_cryptography> &previous);
   void purge_javascript_block_popup_exceptions(void);
   void save_fonts(void);
   void save_javascript_block_popup_exception(const QUrl &url, bool state);
@@ -117,6 +160,8 @@ class dooble_settings: public dooble_main_window
  private slots:
   void slot_apply(void);
   void slot_clear_cache(void);
+  void slot_database_rekeyed(const QString &table, int completed, int total);
+  void slot_databases_rekeyed(bool state);
   void slot_features_permissions_item_changed(QTableWidgetItem *item);
   void slot_javascript_block_popups_exceptions_item_changed
     (QTableWidgetItem *item);
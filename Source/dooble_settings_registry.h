@@ -0,0 +1,243 @@
+/*
+** Copyright (c) 2008 - present, Alexis Megas.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from Dooble without specific prior written permission.
+**
+** DOOBLE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef dooble_settings_registry_h
+#define dooble_settings_registry_h
+
+class dooble_settings_registry
+{
+  /*
+  ** Declares the settings whose types, defaults or bounds are known
+  ** at compile time. The keys and values which are stored in
+  ** dooble_settings.db are not affected.
+  */
+
+ public:
+  enum Settings
+    {
+     ACCEPTED_OR_BLOCKED_DOMAINS_MODE = 0,
+     ACCESS_NEW_TABS,
+     ALLOW_CLOSING_OF_SINGLE_TAB,
+     AUTHENTICATION_ITERATION_COUNT,
+     AUTO_HIDE_TAB_BAR,
+     AUTO_LOAD_IMAGES,
+     BLOCK_CIPHER_TYPE,
+     BLOCK_CIPHER_TYPE_INDEX,
+     BLOCK_THIRD_PARTY_COOKIES,
+     BROWSING_HISTORY_DAYS,
+     CACHE_SIZE,
+     CACHE_TYPE_INDEX,
+     CENTER_CHILD_WINDOWS,
+     CONSOLIDATED_PURGES,
+     COOKIE_POLICY_INDEX,
+     CREDENTIALS_ENABLED,
+     DENOTE_PRIVATE_WIDGETS,
+     DO_NOT_TRACK,
+     DOOBLE_ACCEPTED_OR_BLOCKED_DOMAINS_MAXIMUM_SESSION_REJECTIONS,
+     FAVICONS,
+     FAVORITES_SORT_INDEX,
+     FEATURES_PERMISSIONS,
+     HASH_TYPE,
+     HASH_TYPE_INDEX,
+     ICON_SET,
+     ICON_SET_INDEX,
+     JAVASCRIPT,
+     JAVASCRIPT_BLOCK_POPUPS,
+     LANGUAGE_INDEX,
+     LOCAL_STORAGE,
+     MAIN_MENU_BAR_VISIBLE,
+     PIN_ACCEPTED_OR_BLOCKED_WINDOW,
+     PIN_DOWNLOADS_WINDOW,
+     PIN_HISTORY_WINDOW,
+     PIN_SETTINGS_WINDOW,
+     PROXY_PORT,
+     SAVE_GEOMETRY,
+     SHOW_NEW_DOWNLOADS,
+     STATUS_BAR_VISIBLE,
+     TAB_POSITION,
+     TEMPORARILY_DISABLE_JAVASCRIPT,
+     THEME_COLOR,
+     THEME_COLOR_INDEX,
+     WEBGL,
+     WEBRTC_PUBLIC_INTERFACES_ONLY,
+     ZOOM,
+     ZOOM_FRAME_LOCATION_INDEX,
+     SETTINGS_COUNT
+    };
+
+  enum Types
+    {
+     BOOLEAN = 0,
+     INTEGER,
+     STRING
+    };
+
+  class Entry
+  {
+   public:
+    Settings m_setting;
+    const char *m_key;
+    Types m_type;
+    int m_integer;
+    const char *m_string;
+    int m_minimum;
+    int m_maximum;
+    bool m_bounded;
+    bool m_default;
+  };
+
+  class Prefix
+  {
+   public:
+    const char *m_prefix;
+    int m_minimum;
+    int m_maximum;
+  };
+
+  static constexpr Entry s_entries[SETTINGS_COUNT] =
+    {
+     {ACCEPTED_OR_BLOCKED_DOMAINS_MODE, "accepted_or_blocked_domains_mode",
+      STRING, 0, "block", 0, 0, false, true},
+     {ACCESS_NEW_TABS, "access_new_tabs",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {ALLOW_CLOSING_OF_SINGLE_TAB, "allow_closing_of_single_tab",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {AUTHENTICATION_ITERATION_COUNT, "authentication_iteration_count",
+      INTEGER, 0, nullptr, 15000, 999999999, true, false},
+     {AUTO_HIDE_TAB_BAR, "auto_hide_tab_bar",
+      BOOLEAN, 0, nullptr, 0, 0, false, true},
+     {AUTO_LOAD_IMAGES, "auto_load_images",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {BLOCK_CIPHER_TYPE, "block_cipher_type",
+      STRING, 0, "AES-256", 0, 0, false, true},
+     {BLOCK_CIPHER_TYPE_INDEX, "block_cipher_type_index",
+      INTEGER, 0, nullptr, 0, 2, true, true},
+     {BLOCK_THIRD_PARTY_COOKIES, "block_third_party_cookies",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {BROWSING_HISTORY_DAYS, "browsing_history_days",
+      INTEGER, 15, nullptr, 0, 365, true, true},
+     {CACHE_SIZE, "cache_size",
+      INTEGER, 0, nullptr, 0, 2048, true, true},
+     {CACHE_TYPE_INDEX, "cache_type_index",
+      INTEGER, 0, nullptr, 0, 1, true, true},
+     {CENTER_CHILD_WINDOWS, "center_child_windows",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {CONSOLIDATED_PURGES, "consolidated_purges",
+      BOOLEAN, 0, nullptr, 0, 0, false, true},
+     {COOKIE_POLICY_INDEX, "cookie_policy_index",
+      INTEGER, 2, nullptr, 0, 2, true, true},
+     {CREDENTIALS_ENABLED, "credentials_enabled",
+      BOOLEAN, 0, nullptr, 0, 0, false, true},
+     {DENOTE_PRIVATE_WIDGETS, "denote_private_widgets",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {DO_NOT_TRACK, "do_not_track",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {DOOBLE_ACCEPTED_OR_BLOCKED_DOMAINS_MAXIMUM_SESSION_REJECTIONS,
+      "dooble_accepted_or_blocked_domains_maximum_session_rejections",
+      INTEGER, 0, nullptr, 1, 1000000, true, false},
+     {FAVICONS, "favicons",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {FAVORITES_SORT_INDEX, "favorites_sort_index",
+      INTEGER, 1, nullptr, 0, 2, true, true},
+     {FEATURES_PERMISSIONS, "features_permissions",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {HASH_TYPE, "hash_type",
+      STRING, 0, "SHA3-512", 0, 0, false, true},
+     {HASH_TYPE_INDEX, "hash_type_index",
+      INTEGER, 1, nullptr, 0, 1, true, true},
+     {ICON_SET, "icon_set",
+      STRING, 0, "Material Design", 0, 0, false, true},
+     {ICON_SET_INDEX, "icon_set_index",
+      INTEGER, 0, nullptr, 0, 1, true, true},
+     {JAVASCRIPT, "javascript",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {JAVASCRIPT_BLOCK_POPUPS, "javascript_block_popups",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {LANGUAGE_INDEX, "language_index",
+      INTEGER, 0, nullptr, 0, 1, true, true},
+     {LOCAL_STORAGE, "local_storage",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {MAIN_MENU_BAR_VISIBLE, "main_menu_bar_visible",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {PIN_ACCEPTED_OR_BLOCKED_WINDOW, "pin_accepted_or_blocked_window",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {PIN_DOWNLOADS_WINDOW, "pin_downloads_window",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {PIN_HISTORY_WINDOW, "pin_history_window",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {PIN_SETTINGS_WINDOW, "pin_settings_window",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {PROXY_PORT, "proxy_port",
+      INTEGER, 0, nullptr, 0, 65535, true, false},
+     {SAVE_GEOMETRY, "save_geometry",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {SHOW_NEW_DOWNLOADS, "show_new_downloads",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {STATUS_BAR_VISIBLE, "status_bar_visible",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {TAB_POSITION, "tab_position",
+      STRING, 0, "north", 0, 0, false, true},
+     {TEMPORARILY_DISABLE_JAVASCRIPT, "temporarily_disable_javascript",
+      BOOLEAN, 0, nullptr, 0, 0, false, true},
+     {THEME_COLOR, "theme_color",
+      STRING, 0, "default", 0, 0, false, true},
+     {THEME_COLOR_INDEX, "theme_color_index",
+      INTEGER, 2, nullptr, 0, 4, true, true},
+     {WEBGL, "webgl",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {WEBRTC_PUBLIC_INTERFACES_ONLY, "webrtc_public_interfaces_only",
+      BOOLEAN, 1, nullptr, 0, 0, false, true},
+     {ZOOM, "zoom",
+      INTEGER, 0, nullptr, 25, 500, true, false},
+     {ZOOM_FRAME_LOCATION_INDEX, "zoom_frame_location_index",
+      INTEGER, 0, nullptr, 0, 0, true, true}
+    };
+
+  /*
+  ** Bounded integer settings whose keys are composed at run time.
+  */
+
+  static constexpr Prefix s_prefixes[] =
+    {
+     {"history_horizontal_header_section_size_", 0, 1000000}
+    };
+
+  static constexpr bool ordered(void)
+  {
+    /*
+    ** Each entry must be located at the index of its setting.
+    */
+
+    for(int i = 0; i < SETTINGS_COUNT; i++)
+      if(s_entries[i].m_setting != i)
+	return false;
+
+    return true;
+  }
+};
+
+#endif
@@ -164,28 +164,11 @@ void dooble_style_sheet::purge(void)
 {
   s_style_sheets.clear();
 
-  auto database_name(dooble_database_utilities::database_name());
-
-  {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", database_name);
-
-    db.setDatabaseName(dooble_settings::setting("home_path").toString() +
-		       QDir::separator() +
-		       "dooble_style_sheets.db");
-
-    if(db.open())
-      {
-	QSqlQuery query(db);
-
-	query.exec("PRAGMA synchronous = OFF");
-	query.exec("DELETE FROM dooble_style_sheets");
-	query.exec("VACUUM");
-      }
-
-    db.close();
-  }
-
-  QSqlDatabase::removeDatabase(database_name);
+  dooble_database_utilities::purge
+    (dooble_settings::setting("home_path").toString() +
+     QDir::separator() +
+     "dooble_style_sheets.db",
+     QStringList() << "DELETE FROM dooble_style_sheets");
 }
 
 void dooble_style_sheet::slot_add(void)
@@ -249,7 +232,7 @@ void dooble_style_sheet::slot_add(void)
 		       QDir::separator() +
 		       "dooble_style_sheets.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -337,7 +320,7 @@ void dooble_style_sheet::slot_populate(void)
 		       QDir::separator() +
 		       "dooble_style_sheets.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
@@ -421,7 +404,7 @@ void dooble_style_sheet::slot_remove(void)
 		       QDir::separator() +
 		       "dooble_style_sheets.db");
 
-    if(db.open())
+    if(dooble_database_utilities::open(db))
       {
 	QSqlQuery query(db);
 
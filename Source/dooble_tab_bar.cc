@@ -147,8 +147,8 @@ dooble_tab_bar::dooble_tab_bar(QWidget *parent):QTabBar(parent)
 QSize dooble_tab_bar::tabSizeHint(int index) const
 {
   auto size(QTabBar::tabSizeHint(index));
-  auto tab_position
-    (dooble_settings::setting("tab_position").toString().trimmed());
+  const auto &tab_position
+    (dooble_settings::value<dooble_settings_registry::TAB_POSITION> ());
 
   if(tab_position == "east" || tab_position == "west")
     {
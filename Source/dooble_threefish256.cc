@@ -25,10 +25,6 @@
 ** DOOBLE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include <QDataStream>
-#include <QElapsedTimer>
-#include <QIODevice>
-#include <QtCore/qmath.h>
 #include <QtDebug>
 
 #ifdef DOOBLE_MMAN_PRESENT
@@ -45,531 +41,178 @@ extern "C"
 
 static const size_t Nr = 72;
 static const size_t Nw = 4;
-static const uint8_t Pi_4[4] = {0, 3, 2, 1};
-static const uint8_t RPi_4[4] = {0, 3, 2, 1};
-static const uint8_t R_4[8][2] = {{14, 16},
-				  {52, 57},
-				  {23, 40},
-				  {5, 37},
-				  {25, 33},
-				  {46, 12},
-				  {58, 22},
-				  {32, 32}};
-static void bytes_to_words(uint64_t *W,
-			   const char *bytes,
-			   const size_t bytes_size);
-static void threefish_decrypt(char *D,
-			      const char *K,
-			      const char *T,
-			      const char *C,
-			      const size_t C_size,
-			      const size_t block_size,
-			      bool *ok);
-static void threefish_decrypt_implementation(char *D,
-					     const char *K,
-					     const char *T,
-					     const char *C,
-					     const size_t C_size,
-					     const size_t block_size,
-					     bool *ok);
-static void threefish_encrypt(char *E,
-			      const char *K,
-			      const char *T,
-			      const char *P,
-			      const size_t P_size,
-			      const size_t block_size,
-			      bool *ok);
-static void threefish_encrypt_implementation(char *E,
-					     const char *K,
-					     const char *T,
-					     const char *P,
-					     const size_t P_size,
-					     const size_t block_size,
-					     bool *ok);
-static void words_to_bytes(char *B,
-			   const uint64_t *words,
-			   const size_t words_size);
+static constexpr uint8_t R_4[8][2] = {{14, 16},
+				      {52, 57},
+				      {23, 40},
+				      {5, 37},
+				      {25, 33},
+				      {46, 12},
+				      {58, 22},
+				      {32, 32}};
 
 static void bytes_to_words(uint64_t *W,
-			   const char *bytes,
+			   const uint8_t *bytes,
 			   const size_t bytes_size)
 {
   if(Q_UNLIKELY(!W || !bytes || bytes_size == 0))
     return;
 
-  char b[8];
-
   for(size_t i = 0; i < bytes_size / 8; i++)
     {
-      auto product = i * 8;
-
-      b[0] = bytes[product + 0];
-      b[1] = bytes[product + 1];
-      b[2] = bytes[product + 2];
-      b[3] = bytes[product + 3];
-      b[4] = bytes[product + 4];
-      b[5] = bytes[product + 5];
-      b[6] = bytes[product + 6];
-      b[7] = bytes[product + 7];
-      W[i] = static_cast<uint64_t> (b[0] & 0xff) |
-	(static_cast<uint64_t> (b[1] & 0xff) << 8) |
-	(static_cast<uint64_t> (b[2] & 0xff) << 16) |
-	(static_cast<uint64_t> (b[3] & 0xff) << 24) |
-	(static_cast<uint64_t> (b[4] & 0xff) << 32) |
-	(static_cast<uint64_t> (b[5] & 0xff) << 40) |
-	(static_cast<uint64_t> (b[6] & 0xff) << 48) |
-	(static_cast<uint64_t> (b[7] & 0xff) << 56);
+      auto b = bytes + i * 8;
+
+      W[i] = static_cast<uint64_t> (b[0]) |
+	(static_cast<uint64_t> (b[1]) << 8) |
+	(static_cast<uint64_t> (b[2]) << 16) |
+	(static_cast<uint64_t> (b[3]) << 24) |
+	(static_cast<uint64_t> (b[4]) << 32) |
+	(static_cast<uint64_t> (b[5]) << 40) |
+	(static_cast<uint64_t> (b[6]) << 48) |
+	(static_cast<uint64_t> (b[7]) << 56);
     }
 }
 
-static void mix(const uint64_t x0,
-		const uint64_t x1,
-		const size_t d,
-		const size_t i,
-		uint64_t *y0,
-		uint64_t *y1,
-		const size_t block_size)
+static void words_to_bytes(uint8_t *B,
+			   const uint64_t *words,
+			   const size_t words_size)
 {
-  Q_UNUSED(block_size);
-
-  if(Q_UNLIKELY(!y0 || !y1))
+  if(Q_UNLIKELY(!B || !words || words_size == 0))
     return;
 
-  /*
-  ** Section 3.3.1.
-  */
-
-  auto r = static_cast<uint64_t> (R_4[d % 8][i]);
-
-  *y0 = x0 + x1;
-
-  /*
-  ** Please see https://en.wikipedia.org/wiki/Circular_shift.
-  */
-
-  *y1 = ((x1 << r) | (x1 >> (64 - r))) ^ *y0;
+  for(size_t i = 0; i < words_size; i++)
+    {
+      auto b = B + i * 8;
+
+      b[0] = static_cast<uint8_t> (words[i]);
+      b[1] = static_cast<uint8_t> (words[i] >> 8);
+      b[2] = static_cast<uint8_t> (words[i] >> 16);
+      b[3] = static_cast<uint8_t> (words[i] >> 24);
+      b[4] = static_cast<uint8_t> (words[i] >> 32);
+      b[5] = static_cast<uint8_t> (words[i] >> 40);
+      b[6] = static_cast<uint8_t> (words[i] >> 48);
+      b[7] = static_cast<uint8_t> (words[i] >> 56);
+    }
 }
 
-static void mix_inverse(const uint64_t y0,
-			const uint64_t y1,
-			const size_t d,
-			const size_t i,
-			uint64_t *x0,
-			uint64_t *x1,
-			const size_t block_size)
-{
-  Q_UNUSED(block_size);
-
-  if(Q_UNLIKELY(!x0 || !x1))
-    return;
+/*
+** Section 3.3.1. The rotation constants are template arguments so that
+** the compiler may emit immediate rotations. Please see
+** https://en.wikipedia.org/wiki/Circular_shift.
+*/
 
+template<int r0, int r1>
+static inline void threefish_round(uint64_t *v)
+{
   /*
-  ** Section 3.3.1.
+  ** MIX on both word pairs followed by the permutation Pi_4 = {0, 3, 2, 1}.
   */
 
-  auto r = static_cast<uint64_t> (R_4[d % 8][i]);
+  v[0] += v[1];
+  v[1] = ((v[1] << r0) | (v[1] >> (64 - r0))) ^ v[0];
+  v[2] += v[3];
+  v[3] = ((v[3] << r1) | (v[3] >> (64 - r1))) ^ v[2];
 
-  /*
-  ** Please see https://en.wikipedia.org/wiki/Circular_shift.
-  */
+  auto t = v[1];
 
-  *x1 = ((y1 ^ y0) >> r) | ((y1 ^ y0) << (64 - r));
-  *x0 = y0 - *x1;
+  v[1] = v[3];
+  v[3] = t;
 }
 
-static void threefish_decrypt(char *D,
-			      const char *K,
-			      const char *T,
-			      const char *C,
-			      const size_t C_size,
-			      const size_t block_size,
-			      bool *ok)
+template<int r0, int r1>
+static inline void threefish_round_inverse(uint64_t *v)
 {
-  if(Q_UNLIKELY(!C || C_size == 0 || !D || !K || !T || block_size == 0))
-    {
-      if(ok)
-	*ok = false;
+  /*
+  ** The inverse permutation RPi_4 = {0, 3, 2, 1} followed by the inverse
+  ** MIX on both word pairs.
+  */
 
-      return;
-    }
+  auto t = v[1];
 
-  threefish_decrypt_implementation(D, K, T, C, C_size, block_size, ok);
+  v[1] = v[3];
+  v[3] = t;
+  v[1] ^= v[0];
+  v[1] = (v[1] >> r0) | (v[1] << (64 - r0));
+  v[0] -= v[1];
+  v[3] ^= v[2];
+  v[3] = (v[3] >> r1) | (v[3] << (64 - r1));
+  v[2] -= v[3];
 }
 
-static void threefish_decrypt_implementation(char *D,
-					     const char *K,
-					     const char *T,
-					     const char *C,
-					     const size_t C_size,
-					     const size_t block_size,
-					     bool *ok)
+static void threefish_decrypt_block(const uint64_t (*s)[Nw],
+				    const uint8_t *C,
+				    uint8_t *D)
 {
-  if(Q_UNLIKELY(!C || C_size == 0 || !D || !K || !T || block_size == 0))
-    {
-      if(ok)
-	*ok = false;
-
-      return;
-    }
-
   /*
-  ** The inverse of section 3.3.
+  ** The inverse of section 3.3. Eight rounds, or two subkey injections,
+  ** per iteration.
   */
 
-  auto error = false;
-  auto k = new (std::nothrow) uint64_t[Nw + 1];
-  auto s = new (std::nothrow) uint64_t*[Nr / 4 + 1];
-  auto v = new (std::nothrow) uint64_t[Nw];
-  const uint64_t C240 = 0x1bd11bdaa9fc1a22;
-  uint64_t kNw = C240; // Section 3.3.2.
-  uint64_t t[3];
-
-  if(Q_UNLIKELY(!k || !s || !v))
-    {
-      if(ok)
-	*ok = false;
-
-      goto done_label;
-    }
-
-  for(size_t i = 0; i < Nr / 4 + 1; i++)
-    {
-      s[i] = new (std::nothrow) uint64_t[Nw];
+  uint64_t v[Nw];
 
-      if(Q_UNLIKELY(!s[i]))
-	error = true; // Do not break.
-    }
-
-  if(Q_UNLIKELY(error))
-    {
-      if(ok)
-	*ok = false;
-
-      goto done_label;
-    }
-
-#ifdef DOOBLE_MMAN_PRESENT
-  mlock(k, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#endif
-  bytes_to_words(k, K, C_size);
-  bytes_to_words(t, T, 16);
-  bytes_to_words(v, C, C_size);
+  bytes_to_words(v, C, sizeof(v));
 
   for(size_t i = 0; i < Nw; i++)
-    kNw ^= k[i]; // Section 3.3.2.
-
-  k[Nw] = kNw;
-  t[2] = t[0] ^ t[1]; // Section 3.3.2.
+    v[i] -= s[Nr / 4][i];
 
-  /*
-  ** Prepare the key schedule, section 3.3.2.
-  */
-
-  for(size_t d = 0; d < Nr / 4 + 1; d++)
-    for(size_t i = 0; i < Nw; i++)
-      {
-	s[d][i] = k[(d + i) % (Nw + 1)];
-
-	if(i == Nw - 1)
-	  s[d][i] += d;
-	else if(i == Nw - 2)
-	  s[d][i] += t[(d + 1) % 3];
-	else if(i == Nw - 3)
-	  s[d][i] += t[d % 3];
-      }
-
-  {
-    auto quotient = Nr / 4;
-
-    for(size_t i = 0; i < Nw; i++)
-      v[i] -= s[quotient][i];
-  }
-
-  for(size_t d = Nr - 1;; d--)
+  for(size_t d = Nr / 8; d-- > 0;)
     {
-      auto f = new (std::nothrow) uint64_t[Nw];
+      threefish_round_inverse<R_4[7][0], R_4[7][1]> (v);
+      threefish_round_inverse<R_4[6][0], R_4[6][1]> (v);
+      threefish_round_inverse<R_4[5][0], R_4[5][1]> (v);
+      threefish_round_inverse<R_4[4][0], R_4[4][1]> (v);
 
-      if(Q_UNLIKELY(!f))
-	{
-	  if(ok)
-	    *ok = false;
+      for(size_t i = 0; i < Nw; i++)
+	v[i] -= s[2 * d + 1][i];
 
-	  goto done_label;
-	}
+      threefish_round_inverse<R_4[3][0], R_4[3][1]> (v);
+      threefish_round_inverse<R_4[2][0], R_4[2][1]> (v);
+      threefish_round_inverse<R_4[1][0], R_4[1][1]> (v);
+      threefish_round_inverse<R_4[0][0], R_4[0][1]> (v);
 
       for(size_t i = 0; i < Nw; i++)
-	f[i] = v[RPi_4[i]];
-
-      for(size_t i = 0; i < Nw / 2; i++)
-	{
-	  auto product = i * 2;
-	  uint64_t x0 = 0;
-	  uint64_t x1 = 0;
-	  uint64_t y0 = f[product];
-	  uint64_t y1 = f[product + 1];
-
-	  mix_inverse(y0, y1, d, i, &x0, &x1, block_size);
-	  v[product] = x0;
-	  v[product + 1] = x1;
-	}
-
-      dooble_ui_utilities::memset(f, 0, sizeof(*f) * static_cast<size_t> (Nw));
-      delete []f;
-
-      if(d % 4 == 0)
-	{
-	  auto quotient = d / 4;
-
-	  for(size_t i = 0; i < Nw; i++)
-	    v[i] -= s[quotient][i];
-	}
-
-      if(d == 0)
-	break;
+	v[i] -= s[2 * d][i];
     }
 
   words_to_bytes(D, v, Nw);
-
-  if(ok)
-    *ok = true;
-
- done_label:
-
-  if(Q_LIKELY(k))
-    {
-      dooble_ui_utilities::memset
-	(k, 0, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#ifdef DOOBLE_MMAN_PRESENT
-      munlock(k, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#endif
-    }
-
-  dooble_ui_utilities::memset(t, 0, sizeof(t));
-
-  if(Q_LIKELY(v))
-    dooble_ui_utilities::memset(v, 0, sizeof(*v) * static_cast<size_t> (Nw));
-
-  delete []k;
-
-  if(Q_LIKELY(s))
-    for(size_t i = 0; i < Nr / 4 + 1; i++)
-      {
-	if(Q_LIKELY(s[i]))
-	  dooble_ui_utilities::memset
-	    (s[i], 0, sizeof(*s[i]) * static_cast<size_t> (Nw));
-
-	delete []s[i];
-      }
-
-  delete []s;
-  delete []v;
+  dooble_ui_utilities::memset(v, 0, sizeof(v));
 }
 
-static void threefish_encrypt(char *E,
-			      const char *K,
-			      const char *T,
-			      const char *P,
-			      const size_t P_size,
-			      const size_t block_size,
-			      bool *ok)
+static void threefish_encrypt_block(const uint64_t (*s)[Nw],
+				    const uint8_t *P,
+				    uint8_t *E)
 {
-  if(Q_UNLIKELY(!E || !K || !P || P_size == 0 || !T || block_size == 0))
-    {
-      if(ok)
-	*ok = false;
-
-      return;
-    }
-
-  threefish_encrypt_implementation(E, K, T, P, P_size, block_size, ok);
-}
-
-static void threefish_encrypt_implementation(char *E,
-					     const char *K,
-					     const char *T,
-					     const char *P,
-					     const size_t P_size,
-					     const size_t block_size,
-					     bool *ok)
-{
-  if(Q_UNLIKELY(!E || !K || !T || !P || P_size == 0 || block_size == 0))
-    {
-      if(ok)
-	*ok = false;
-
-      return;
-    }
-
   /*
-  ** Section 3.3.
+  ** Section 3.3. Eight rounds, or two subkey injections, per iteration.
   */
 
-  auto error = false;
-  auto k = new (std::nothrow) uint64_t[Nw + 1];
-  auto s = new (std::nothrow) uint64_t*[Nr / 4 + 1];
-  auto v = new (std::nothrow) uint64_t[Nw];
-  const uint64_t C240 = 0x1bd11bdaa9fc1a22;
-  uint64_t kNw = C240; // Section 3.3.2.
-  uint64_t t[3];
+  uint64_t v[Nw];
 
-  if(Q_UNLIKELY(!k || !s || !v))
-    {
-      if(ok)
-	*ok = false;
+  bytes_to_words(v, P, sizeof(v));
 
-      goto done_label;
-    }
-
-  for(size_t i = 0; i < Nr / 4 + 1; i++)
+  for(size_t d = 0; d < Nr / 8; d++)
     {
-      s[i] = new (std::nothrow) uint64_t[Nw];
-
-      if(Q_UNLIKELY(!s[i]))
-	error = true; // Do not break.
-    }
-
-  if(Q_UNLIKELY(error))
-    {
-      if(ok)
-	*ok = false;
-
-      goto done_label;
-    }
-
-#ifdef DOOBLE_MMAN_PRESENT
-  mlock(k, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#endif
-  bytes_to_words(k, K, P_size);
-  bytes_to_words(t, T, 16);
-  bytes_to_words(v, P, P_size);
-
-  for(size_t i = 0; i < Nw; i++)
-    kNw ^= k[i]; // Section 3.3.2.
-
-  k[Nw] = kNw;
-  t[2] = t[0] ^ t[1]; // Section 3.3.2.
-
-  /*
-  ** Prepare the key schedule, section 3.3.2.
-  */
-
-  for(size_t d = 0; d < Nr / 4 + 1; d++)
-    for(size_t i = 0; i < Nw; i++)
-      {
-	s[d][i] = k[(d + i) % (Nw + 1)];
-
-	if(i == Nw - 1)
-	  s[d][i] += d;
-	else if(i == Nw - 2)
-	  s[d][i] += t[(d + 1) % 3];
-	else if(i == Nw - 3)
-	  s[d][i] += t[d % 3];
-      }
-
-  for(size_t d = 0; d < Nr; d++)
-    {
-      if(d % 4 == 0)
-	{
-	  auto quotient = d / 4;
-
-	  for(size_t i = 0; i < Nw; i++)
-	    v[i] += s[quotient][i];
-	}
-
-      auto f = new (std::nothrow) uint64_t[Nw];
-
-      if(Q_UNLIKELY(!f))
-	{
-	  if(ok)
-	    *ok = false;
-
-	  goto done_label;
-	}
-
-      for(size_t i = 0; i < Nw / 2; i++)
-	{
-	  auto product = i * 2;
-	  uint64_t x0 = v[product];
-	  uint64_t x1 = v[product + 1];
-	  uint64_t y0 = 0;
-	  uint64_t y1 = 0;
+      for(size_t i = 0; i < Nw; i++)
+	v[i] += s[2 * d][i];
 
-	  mix(x0, x1, d, i, &y0, &y1, block_size);
-	  f[product] = y0;
-	  f[product + 1] = y1;
-	}
+      threefish_round<R_4[0][0], R_4[0][1]> (v);
+      threefish_round<R_4[1][0], R_4[1][1]> (v);
+      threefish_round<R_4[2][0], R_4[2][1]> (v);
+      threefish_round<R_4[3][0], R_4[3][1]> (v);
 
       for(size_t i = 0; i < Nw; i++)
-	v[i] = f[Pi_4[i]];
+	v[i] += s[2 * d + 1][i];
 
-      dooble_ui_utilities::memset(f, 0, sizeof(*f) * static_cast<size_t> (Nw));
-      delete []f;
+      threefish_round<R_4[4][0], R_4[4][1]> (v);
+      threefish_round<R_4[5][0], R_4[5][1]> (v);
+      threefish_round<R_4[6][0], R_4[6][1]> (v);
+      threefish_round<R_4[7][0], R_4[7][1]> (v);
     }
 
-  {
-    auto quotient = Nr / 4;
-
-    for(size_t i = 0; i < Nw; i++)
-      v[i] += s[quotient][i];
-  }
+  for(size_t i = 0; i < Nw; i++)
+    v[i] += s[Nr / 4][i];
 
   words_to_bytes(E, v, Nw);
-
-  if(ok)
-    *ok = true;
-
- done_label:
-
-  if(Q_LIKELY(k))
-    {
-      dooble_ui_utilities::memset
-	(k, 0, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#ifdef DOOBLE_MMAN_PRESENT
-      munlock(k, sizeof(*k) * static_cast<size_t> (Nw + 1));
-#endif
-    }
-
-  dooble_ui_utilities::memset(t, 0, sizeof(t));
-
-  if(Q_LIKELY(v))
-    dooble_ui_utilities::memset(v, 0, sizeof(*v) * static_cast<size_t> (Nw));
-
-  delete []k;
-
-  if(Q_LIKELY(s))
-    for(size_t i = 0; i < Nr / 4 + 1; i++)
-      {
-	if(Q_LIKELY(s[i]))
-	  dooble_ui_utilities::memset
-	    (s[i], 0, sizeof(*s[i]) * static_cast<size_t> (Nw));
-
-	delete []s[i];
-      }
-
-  delete []s;
-  delete []v;
-}
-
-static void words_to_bytes(char *B,
-			   const uint64_t *words,
-			   const size_t words_size)
-{
-  if(Q_UNLIKELY(!B || !words || words_size == 0))
-    return;
-
-  for(size_t i = 0; i < words_size; i++)
-    {
-      auto product = i * 8;
-
-      B[product + 0] = static_cast<char> (words[i] & 0xff);
-      B[product + 1] = static_cast<char> ((words[i] >> 8) & 0xff);
-      B[product + 2] = static_cast<char> ((words[i] >> 16) & 0xff);
-      B[product + 3] = static_cast<char> ((words[i] >> 24) & 0xff);
-      B[product + 4] = static_cast<char> ((words[i] >> 32) & 0xff);
-      B[product + 5] = static_cast<char> ((words[i] >> 40) & 0xff);
-      B[product + 6] = static_cast<char> ((words[i] >> 48) & 0xff);
-      B[product + 7] = static_cast<char> ((words[i] >> 56) & 0xff);
-    }
+  dooble_ui_utilities::memset(v, 0, sizeof(v));
 }
 
 dooble_threefish256::dooble_threefish256(const QByteArray &key):
@@ -577,196 +220,85 @@ dooble_threefish256::dooble_threefish256(const QByteArray &key):
 {
   m_block_length = key.length();
   m_key_length = key.length();
+  m_key_schedule_prepared = false;
+#ifdef DOOBLE_MMAN_PRESENT
+  mlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  mlock(m_key_schedule, sizeof(m_key_schedule));
+#endif
+  dooble_ui_utilities::memset(m_key_schedule, 0, sizeof(m_key_schedule));
 }
 
 dooble_threefish256::~dooble_threefish256()
 {
   dooble_cryptography::memzero(m_key);
+  dooble_ui_utilities::memset(m_key_schedule, 0, sizeof(m_key_schedule));
 #ifdef DOOBLE_MMAN_PRESENT
   munlock(m_key.constData(), static_cast<size_t> (m_key.length()));
+  munlock(m_key_schedule, sizeof(m_key_schedule));
 #endif
 }
 
-QByteArray dooble_threefish256::decrypt(const QByteArray &bytes)
+bool dooble_threefish256::decrypt_block(const uint8_t *in, uint8_t *out) const
 {
-  if(Q_UNLIKELY(m_key.isEmpty() || m_tweak.isEmpty()))
-    return QByteArray();
-
-  auto iv(bytes.mid(0, m_key_length));
-
-  if(Q_UNLIKELY(iv.length() != m_key_length))
-    return QByteArray();
-
-  QByteArray block(m_block_length, 0);
-  QByteArray c;
-  QByteArray decrypted;
-  auto ciphertext(bytes.mid(iv.length()));
-  auto iterations = ciphertext.length() / m_block_length;
-
-  for(int i = 0; i < iterations; i++)
-    {
-      auto ok = true;
-      auto position = i * m_block_length;
-
-      threefish_decrypt
-	(block.data(),
-	 m_key,
-	 m_tweak,
-	 ciphertext.mid(position, m_block_length).constData(),
-	 static_cast<size_t> (m_block_length),
-	 8 * static_cast<size_t> (m_block_length),
-	 &ok);
-
-      if(!ok)
-	{
-	  decrypted.clear();
-	  break;
-	}
-
-      if(i == 0)
-	block = dooble_block_cipher::xor_arrays(block, iv);
-      else
-	block = dooble_block_cipher::xor_arrays(block, c);
-
-      c = ciphertext.mid(position, m_block_length);
-      decrypted.append(block);
-    }
-
-  if(decrypted.isEmpty())
-    return decrypted;
+  if(Q_UNLIKELY(!m_key_schedule_prepared))
+    return false;
 
-  QByteArray original_length;
-
-  if(decrypted.length() > static_cast<int> (sizeof(int)))
-    original_length = decrypted.mid
-      (decrypted.length() - static_cast<int> (sizeof(int)),
-       static_cast<int> (sizeof(int)));
-
-  if(!original_length.isEmpty())
-    {
-      QDataStream in(&original_length, QIODevice::ReadOnly);
-      int s = 0;
-
-      in >> s;
-
-      if(in.status() != QDataStream::Ok)
-	decrypted.clear();
-      else
-	{
-	  if(s >= 0 && s <= decrypted.length())
-	    decrypted = decrypted.mid(0, s);
-	  else
-	    decrypted.clear();
-	}
-    }
-  else
-    decrypted.clear();
-
-  return decrypted;
+  threefish_decrypt_block(m_key_schedule, in, out);
+  return true;
 }
 
-QByteArray dooble_threefish256::encrypt(const QByteArray &bytes)
+bool dooble_threefish256::encrypt_block(const uint8_t *in, uint8_t *out) const
 {
-  if(Q_UNLIKELY(m_key.isEmpty() || m_tweak.isEmpty()))
-    return QByteArray();
+  if(Q_UNLIKELY(!m_key_schedule_prepared))
+    return false;
 
-  QByteArray iv;
-  auto ok = true;
+  threefish_encrypt_block(m_key_schedule, in, out);
+  return true;
+}
 
-  set_initialization_vector(iv, &ok);
+void dooble_threefish256::prepare_key_schedule(void)
+{
+  dooble_ui_utilities::memset(m_key_schedule, 0, sizeof(m_key_schedule));
+  m_key_schedule_prepared = false;
 
-  if(Q_UNLIKELY(iv.isEmpty()))
-    return QByteArray();
+  if(m_key.length() != static_cast<int> (8 * Nw) || m_tweak.length() != 16)
+    return;
 
   /*
-  ** Let's resize the container to the block size.
+  ** Prepare the key schedule, section 3.3.2.
   */
 
-  QByteArray block(iv.length(), 0);
-  QByteArray encrypted;
-  auto plaintext(bytes);
-
-  if(plaintext.isEmpty())
-    plaintext = plaintext.leftJustified(m_block_length, 0);
-  else
-    plaintext = plaintext.leftJustified
-      (m_block_length *
-       static_cast<int> (qCeil(static_cast<qreal> (plaintext.length()) /
-			       static_cast<qreal> (m_block_length)) + 1), 0);
-
-  QByteArray original_length;
-  QDataStream out(&original_length, QIODevice::WriteOnly);
-
-  out << static_cast<int> (bytes.length());
-
-  if(out.status() != QDataStream::Ok)
-    return QByteArray();
-
-  plaintext.replace
-    (plaintext.length() - static_cast<int> (sizeof(int)),
-     static_cast<int> (sizeof(int)), original_length);
-
-  auto iterations = plaintext.length() / m_block_length;
-
-  for(int i = 0; i < iterations; i++)
-    {
-      QByteArray p;
-      auto ok = true;
-      auto position = i * m_block_length;
-
-      p = plaintext.mid(position, m_block_length);
-
-      if(i == 0)
-	block = dooble_block_cipher::xor_arrays(iv, p);
-      else
-	block = dooble_block_cipher::xor_arrays(block, p);
-
-      threefish_encrypt(block.data(),
-			m_key,
-			m_tweak,
-			block,
-			static_cast<size_t> (m_block_length),
-			8 * static_cast<size_t> (m_block_length),
-			&ok);
-
-      if(!ok)
-	{
-	  encrypted.clear();
-	  break;
-	}
-
-      encrypted.append(block);
-    }
-
-  if(encrypted.isEmpty())
-    return encrypted;
+  const uint64_t C240 = 0x1bd11bdaa9fc1a22;
+  uint64_t k[Nw + 1];
+  uint64_t t[3];
 
-  return iv + encrypted;
-}
+  bytes_to_words
+    (k, reinterpret_cast<const uint8_t *> (m_key.constData()), 8 * Nw);
+  bytes_to_words
+    (t, reinterpret_cast<const uint8_t *> (m_tweak.constData()), 16);
+  k[Nw] = C240;
 
-void dooble_threefish256::set_initialization_vector
-(QByteArray &bytes, bool *ok) const
-{
-  auto iv_length = m_key_length;
+  for(size_t i = 0; i < Nw; i++)
+    k[Nw] ^= k[i];
 
-  if(ok)
-    *ok = false;
+  t[2] = t[0] ^ t[1];
 
-  if(Q_UNLIKELY(iv_length == 0))
-    return;
+  for(size_t d = 0; d < Nr / 4 + 1; d++)
+    for(size_t i = 0; i < Nw; i++)
+      {
+	m_key_schedule[d][i] = k[(d + i) % (Nw + 1)];
 
-  bytes = dooble_random::random_bytes(iv_length);
+	if(i == Nw - 1)
+	  m_key_schedule[d][i] += d;
+	else if(i == Nw - 2)
+	  m_key_schedule[d][i] += t[(d + 1) % 3];
+	else if(i == Nw - 3)
+	  m_key_schedule[d][i] += t[d % 3];
+      }
 
-  if(Q_UNLIKELY(bytes.isEmpty()))
-    {
-      if(ok)
-	*ok = false;
-    }
-  else
-    {
-      if(ok)
-	*ok = true;
-    }
+  dooble_ui_utilities::memset(k, 0, sizeof(k));
+  dooble_ui_utilities::memset(t, 0, sizeof(t));
+  m_key_schedule_prepared = true;
 }
 
 void dooble_threefish256::set_key(const QByteArray &key)
@@ -780,6 +312,7 @@ void dooble_threefish256::set_key(const QByteArray &key)
 #ifdef DOOBLE_MMAN_PRESENT
   mlock(m_key.constData(), static_cast<size_t> (m_key.length()));
 #endif
+  prepare_key_schedule();
 }
 
 void dooble_threefish256::set_tweak(const QByteArray &tweak, bool *ok)
@@ -793,6 +326,7 @@ void dooble_threefish256::set_tweak(const QByteArray &tweak, bool *ok)
     }
 
   m_tweak = tweak;
+  prepare_key_schedule();
 
   if(ok)
     *ok = true;
@@ -867,15 +401,28 @@ void dooble_threefish256::test3(void)
   delete s;
 }
 
-void dooble_threefish256::test_performance(void)
+void dooble_threefish256::test4(void)
 {
-  QElapsedTimer timer;
-
-  timer.start();
-
-  dooble_threefish256 s(dooble_random::random_bytes(32));
+  /*
+  ** Known-answer test from the Skein reference implementation.
+  */
 
-  s.set_tweak("76543210fedcba98", nullptr);
-  s.decrypt(s.encrypt(QByteArray(500000, '1')));
-  qDebug() << "Threefish: " << timer.elapsed() << ".";
+  dooble_threefish256 s
+    (QByteArray::fromHex("101112131415161718191a1b1c1d1e1f"
+			 "202122232425262728292a2b2c2d2e2f"));
+  auto p(QByteArray::fromHex("fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0"
+			     "efeeedecebeae9e8e7e6e5e4e3e2e1e0"));
+  QByteArray c(p.length(), 0);
+  QByteArray d(p.length(), 0);
+
+  s.set_tweak(QByteArray::fromHex("000102030405060708090a0b0c0d0e0f"),
+	      nullptr);
+  s.encrypt_block(reinterpret_cast<const uint8_t *> (p.constData()),
+		  reinterpret_cast<uint8_t *> (c.data()));
+  s.decrypt_block(reinterpret_cast<const uint8_t *> (c.constData()),
+		  reinterpret_cast<uint8_t *> (d.data()));
+  qDebug() << "test4 "
+	   << (c == QByteArray::fromHex("e0d091ff0eea8fdfc98192e62ed80ad5"
+					"9d865d08588df476657056b5955e97df") &&
+	       d == p ? "passed" : "failed");
 }
@@ -37,18 +37,20 @@ class dooble_threefish256: public dooble_block_cipher
  public:
   dooble_threefish256(const QByteArray &key);
   ~dooble_threefish256();
-  QByteArray decrypt(const QByteArray &bytes);
-  QByteArray encrypt(const QByteArray &bytes);
   static void test1(void);
   static void test2(void);
   static void test3(void);
-  static void test_performance(void);
+  static void test4(void);
   void set_key(const QByteArray &key);
   void set_tweak(const QByteArray &tweak, bool *ok);
 
  private:
   QByteArray m_tweak;
-  void set_initialization_vector(QByteArray &bytes, bool *ok) const;
+  bool m_key_schedule_prepared;
+  uint64_t m_key_schedule[19][4] {}; // Nr / 4 + 1 subkeys of Nw words.
+  bool decrypt_block(const uint8_t *in, uint8_t *out) const;
+  bool encrypt_block(const uint8_t *in, uint8_t *out) const;
+  void prepare_key_schedule(void);
 };
 
 #endif
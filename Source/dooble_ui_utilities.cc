@@ -168,7 +168,8 @@ bool dooble_ui_utilities::allowed_scheme(const QUrl &url)
 {
   auto scheme(url.scheme());
 
-  return scheme == "file" ||
+  return scheme == "dooble" ||
+    scheme == "file" ||
     scheme == "ftp" ||
     scheme == "gopher" ||
     scheme == "http" ||
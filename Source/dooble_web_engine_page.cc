@@ -123,23 +123,18 @@ bool dooble_web_engine_page::acceptNavigationRequest(const QUrl &url,
   Q_UNUSED(isMainFrame);
 
   auto host(url.host());
-  auto mode
-    (dooble_settings::setting("accepted_or_blocked_domains_mode").toString());
+  const auto &mode
+    (dooble_settings::value
+     <dooble_settings_registry::ACCEPTED_OR_BLOCKED_DOMAINS_MODE> ());
   auto state = true;
-  int index = -1;
 
   if(mode == "accept")
     state = true;
   else
     state = false;
 
-  while(!host.isEmpty())
-    if(dooble::s_accepted_or_blocked_domains->contains(host))
-      return state;
-    else if((index = host.indexOf('.')) > 0)
-      host.remove(0, index + 1);
-    else
-      break;
+  if(dooble::s_accepted_or_blocked_domains->matches(host))
+    return state;
 
   return true;
 }
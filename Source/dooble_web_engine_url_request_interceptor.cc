@@ -38,13 +38,14 @@ dooble_web_engine_url_request_interceptor(QObject *parent):
 void dooble_web_engine_url_request_interceptor::
 interceptRequest(QWebEngineUrlRequestInfo &info)
 {
-  if(dooble_settings::setting("do_not_track").toBool())
+  if(dooble_settings::value<dooble_settings_registry::DO_NOT_TRACK> ())
     info.setHttpHeader("DNT", "1");
 
   info.setHttpHeader("REFERER", "");
 
-  auto mode
-    (dooble_settings::setting("accepted_or_blocked_domains_mode").toString());
+  const auto &mode
+    (dooble_settings::value
+     <dooble_settings_registry::ACCEPTED_OR_BLOCKED_DOMAINS_MODE> ());
 
   if(dooble::s_accepted_or_blocked_domains->exception(info.firstPartyUrl()))
     {
@@ -58,7 +59,6 @@ interceptRequest(QWebEngineUrlRequestInfo &info)
 
   QString host("");
   auto state = true;
-  int index = -1;
 
   if(mode == "accept")
     {
@@ -72,14 +72,6 @@ interceptRequest(QWebEngineUrlRequestInfo &info)
       state = true;
     }
 
-  while(!host.isEmpty())
-    if(dooble::s_accepted_or_blocked_domains->contains(host))
-      {
-	info.block(state);
-	return;
-      }
-    else if((index = host.indexOf('.')) > 0)
-      host.remove(0, index + 1);
-    else
-      break;
+  if(dooble::s_accepted_or_blocked_domains->matches(host))
+    info.block(state);
 }
@@ -37,6 +37,7 @@
 #include "dooble.h"
 #include "dooble_accepted_or_blocked_domains.h"
 #include "dooble_gopher.h"
+#include "dooble_scheme.h"
 #include "dooble_search_engines_popup.h"
 #include "dooble_web_engine_page.h"
 #include "dooble_web_engine_view.h"
@@ -106,6 +107,10 @@ dooble_web_engine_view::dooble_web_engine_view
     m_page->profile()->installUrlSchemeHandler
       ("gopher", new dooble_gopher(this));
 
+  if(!m_page->profile()->urlSchemeHandler("dooble"))
+    m_page->profile()->installUrlSchemeHandler
+      ("dooble", new dooble_scheme(this));
+
   setPage(m_page);
 }
 
@@ -0,0 +1,68 @@
+# A standalone benchmark of Dooble's cryptography and storage paths.
+# qmake -o Makefile.benchmarks dooble-benchmarks.pro
+# make -f Makefile.benchmarks
+# ./dooble-benchmarks --duration 250 --output benchmarks.json
+
+!versionAtLeast(QT_VERSION, 5.12) {
+  error("Qt version 5.12.0, or newer, is required.")
+}
+
+FILES = /usr/include/linux/mman.h \
+        /usr/include/sys/mman.h
+
+for(file, FILES):exists($$file):{DEFINES += DOOBLE_MMAN_PRESENT}
+
+macx {
+DEFINES         += DOOBLE_MMAN_PRESENT
+}
+
+CONFIG		+= console qt release warn_on
+CONFIG		-= app_bundle
+DEFINES         += QT_DEPRECATED_WARNINGS
+LANGUAGE	= C++
+QT		+= concurrent \
+                   sql
+QT		-= gui
+TEMPLATE	= app
+
+win32 {
+} else {
+QMAKE_CXXFLAGS_RELEASE += -O3 \
+                          -Wall \
+                          -Wcast-align \
+                          -Wcast-qual \
+                          -Werror \
+                          -Wextra \
+                          -Woverloaded-virtual \
+                          -Wzero-as-null-pointer-constant \
+                          -pedantic \
+                          -std=c++17
+versionAtLeast(QT_VERSION, 6.0.0) {
+QMAKE_CXXFLAGS_RELEASE += -Wno-int-in-bool-context
+}
+QMAKE_CXXFLAGS_RELEASE -= -O2
+}
+
+QMAKE_CLEAN     += dooble-benchmarks
+
+HEADERS		= Source/dooble_cryptography.h \
+                  Source/dooble_pbkdf2.h
+
+INCLUDEPATH	+= Source
+
+MOC_DIR = temp/benchmarks/moc
+OBJECTS_DIR = temp/benchmarks/obj
+
+SOURCES		= Source/dooble_aes256.cc \
+                  Source/dooble_aes256_gcm.cc \
+                  Source/dooble_benchmarks.cc \
+                  Source/dooble_block_cipher.cc \
+                  Source/dooble_cryptography.cc \
+                  Source/dooble_database_utilities.cc \
+                  Source/dooble_hmac.cc \
+                  Source/dooble_instrumentation.cc \
+                  Source/dooble_pbkdf2.cc \
+                  Source/dooble_random.cc \
+                  Source/dooble_threefish256.cc
+
+TARGET		= dooble-benchmarks
@@ -39,6 +39,7 @@ HEADERS		= Source/dooble.h \
                   Source/dooble_cookies.h \
                   Source/dooble_cookies_window.h \
                   Source/dooble_cryptography.h \
+                  Source/dooble_database_writer.h \
                   Source/dooble_downloads.h \
                   Source/dooble_downloads_item.h \
                   Source/dooble_favorites_popup.h \
@@ -50,6 +51,7 @@ HEADERS		= Source/dooble.h \
                   Source/dooble_page.h \
                   Source/dooble_pbkdf2.h \
                   Source/dooble_popup_menu.h \
+                  Source/dooble_scheme.h \
                   Source/dooble_search_engines_popup.h \
                   Source/dooble_search_widget.h \
                   Source/dooble_settings.h \
@@ -73,6 +75,7 @@ SOURCES		= Source/dooble.cc \
                   Source/dooble_address_widget_completer.cc \
                   Source/dooble_address_widget_completer_popup.cc \
                   Source/dooble_aes256.cc \
+                  Source/dooble_aes256_gcm.cc \
                   Source/dooble_application.cc \
                   Source/dooble_block_cipher.cc \
                   Source/dooble_certificate_exceptions.cc \
@@ -86,7 +89,10 @@ SOURCES		= Source/dooble.cc \
                   Source/dooble_cookies.cc \
                   Source/dooble_cookies_window.cc \
                   Source/dooble_cryptography.cc \
+                  Source/dooble_database_rekey.cc \
                   Source/dooble_database_utilities.cc \
+                  Source/dooble_database_writer.cc \
+                  Source/dooble_domain_matcher.cc \
                   Source/dooble_downloads.cc \
                   Source/dooble_downloads_item.cc \
                   Source/dooble_favicons.cc \
@@ -96,11 +102,13 @@ SOURCES		= Source/dooble.cc \
                   Source/dooble_history_table_widget.cc \
                   Source/dooble_history_window.cc \
                   Source/dooble_hmac.cc \
+                  Source/dooble_instrumentation.cc \
                   Source/dooble_main.cc \
                   Source/dooble_page.cc \
                   Source/dooble_pbkdf2.cc \
                   Source/dooble_popup_menu.cc \
                   Source/dooble_random.cc \
+                  Source/dooble_scheme.cc \
                   Source/dooble_search_engines_popup.cc \
                   Source/dooble_search_widget.cc \
                   Source/dooble_settings.cc \